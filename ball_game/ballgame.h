@@ -1,66 +1,86 @@
-﻿#ifndef BALLGAME_H
-#define BALLGAME_H
-
-#include <QWidget>
-#include <QTimer>
-#include <QList>
-#include <QPushButton>
-#include <QLabel>
-#include "ball.h"
-
-class BallGame : public QWidget
-{
-    Q_OBJECT
-public:
-    explicit BallGame(QWidget *parent = nullptr);
-    ~BallGame();
-
-protected:
-    // 重写绘制事件
-    void paintEvent(QPaintEvent *event) override;
-    // 鼠标点击事件
-    void mousePressEvent(QMouseEvent *event) override;
-    // 窗口大小变化事件
-    void resizeEvent(QResizeEvent *event) override;
-
-private slots:
-    // 游戏循环
-    void gameLoop();
-    // 开始游戏
-    void startGame();
-    // 重置游戏
-    void resetGame();
-
-private:
-    // 初始化游戏
-    void initGame();
-    // 初始化UI
-    void initUI();
-    // 检查球与圆圈的碰撞
-    void checkCircleCollision(Ball *ball);
-    // 检查球与球的碰撞
-    void checkBallCollision(Ball *ball1, Ball *ball2);
-    // 检查球是否碰到线
-    void checkLineCollision();
-    // 检查游戏结束条件
-    bool checkGameOver();
-    // 更新游戏状态
-    void updateGameState();
-    // 绘制游戏状态
-    void drawGameStatus(QPainter *painter);
-
-private:
-    QList<Ball*> m_balls;      // 所有球
-    QTimer *m_timer;           // 游戏计时器
-    bool m_isRunning;          // 游戏是否运行
-    qreal m_circleRadius;      // 圆圈半径
-    QPointF m_circleCenter;    // 圆圈中心
-    qreal m_gameSpeed;         // 游戏速度
-    QPushButton *m_startButton; // 开始按钮
-    QLabel *m_statusLabel;     // 状态标签
-    QList<QLabel*> m_scoreLabels; // 分数标签
-
-
-};
-
-#endif // BALLGAME_H
+#ifndef BALLGAME_H
+#define BALLGAME_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QComboBox>
+#include <QElapsedTimer>
+#include <QList>
+#include <QPushButton>
+#include <QLabel>
+#include <QLocalSocket>
+#include "ballstream.h"
+#include "ballworld.h"
+
+class BallGame : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit BallGame(QWidget *parent = nullptr);
+    ~BallGame();
+
+    // 设置每局的球数并重新开始，球数较多时按圆圈大小缩小球的半径
+    void setBallCount(int count);
+
+    // 进入观看模式：连接ball_server并显示指定比赛的状态流，本地不运行物理模拟
+    void startViewer(const QString &serverName, int matchId);
+
+protected:
+    // 重写绘制事件
+    void paintEvent(QPaintEvent *event) override;
+    // 鼠标点击事件
+    void mousePressEvent(QMouseEvent *event) override;
+    // 窗口大小变化事件
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    // 游戏循环
+    void gameLoop();
+    // 开始游戏
+    void startGame();
+    // 重置游戏
+    void resetGame();
+    // 切换游戏速度
+    void onSpeedChanged(int index);
+    // 收到状态流数据
+    void onStreamData();
+    // 状态流断开
+    void onStreamDisconnected();
+
+private:
+    // 初始化游戏
+    void initGame();
+    // 初始化UI
+    void initUI();
+    // 计算游戏区域（圆圈所在的矩形）
+    QRect gameArea() const;
+    // 检查游戏结束条件
+    bool checkGameOver();
+    // 更新游戏状态
+    void updateGameState();
+    // 绘制游戏状态
+    void drawGameStatus(QPainter *painter);
+
+private:
+    WorkStealingPool m_pool;   // 碰撞检测线程池
+    BallWorld m_world;         // 模拟世界（圆圈与所有球）
+    int m_ballCount;           // 每局的球数
+    QTimer *m_timer;           // 游戏计时器
+    bool m_isRunning;          // 游戏是否运行
+    qreal m_gameSpeed;         // 游戏速度（模拟时间倍率，0表示尽可能快）
+    qreal m_pendingTicks;      // 按倍率应推进但尚未推进的步数
+    QElapsedTimer m_frameClock; // 上一帧以来的墙钟时间
+    QElapsedTimer m_rateClock; // 步数统计窗口计时
+    quint64 m_rateTicks;       // 当前统计窗口内推进的步数
+    QPushButton *m_startButton; // 开始按钮
+    QComboBox *m_speedBox;     // 速度选择
+    QLabel *m_statusLabel;     // 状态标签
+    QList<QLabel*> m_scoreLabels; // 分数标签
+    QLocalSocket *m_viewerSocket; // 观看模式的状态流连接（非观看模式为nullptr）
+    BallStreamDecoder m_decoder;  // 状态流解码器
+    int m_viewerMatchId;          // 观看的比赛ID
+
+
+};
+
+#endif // BALLGAME_H
@@ -0,0 +1,483 @@
+#include "ballstream.h"
+#include <QtMath>
+
+namespace {
+// 帧类型
+const quint8 kKeyframe = 1;
+const quint8 kDelta = 2;
+
+// 量化精度：镜像位置为1/4096像素，线上位置为1/16像素，速度为1/16像素/秒
+const qint64 kMirrorScale = 4096;
+const qint64 kWireScale = 16;
+const qint64 kMirrorPerWire = kMirrorScale / kWireScale;
+// 航位推算允许的最大偏差（1/8像素）
+const qint64 kMaxDrift = kMirrorScale / 8;
+// 单帧大小上限，防止错误数据导致分配过多内存
+const int kMaxFrameBytes = 64 * 1024 * 1024;
+
+// 四舍五入的整数除法（b > 0）
+qint64 divRound(qint64 a, qint64 b)
+{
+    return a >= 0 ? (a + b / 2) / b : -((-a + b / 2) / b);
+}
+
+// 按量化速度推进一步镜像位置，编码器和解码器必须使用完全相同的整数运算
+qint64 advance(qint64 position, qint32 velocity, qint64 tickUs)
+{
+    return position + divRound(qint64(velocity) * (kMirrorScale / kWireScale) * tickUs, 1000000);
+}
+
+void writeVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+void writeSigned(QByteArray &out, qint64 value)
+{
+    writeVarint(out, (quint64(value) << 1) ^ quint64(value >> 63));
+}
+
+void writeByte(QByteArray &out, quint8 value)
+{
+    out.append(char(value));
+}
+
+void writeAngle(QByteArray &out, const QPointF &point, const QPointF &center)
+{
+    const qreal angle = qAtan2(point.y() - center.y(), point.x() - center.x());
+    const quint16 quantized = quint16(qRound64(angle / (2 * M_PI) * 65536.0) & 0xffff);
+    out.append(char(quantized & 0xff));
+    out.append(char(quantized >> 8));
+}
+
+// 给负载加上4字节小端长度前缀
+QByteArray frame(const QByteArray &payload)
+{
+    QByteArray out;
+    out.reserve(payload.size() + 4);
+    const quint32 size = quint32(payload.size());
+    for (int i = 0; i < 4; i++) {
+        out.append(char((size >> (8 * i)) & 0xff));
+    }
+    out.append(payload);
+    return out;
+}
+
+// 负载读取器，越界后ok()返回false，之后的读取都返回0
+class Reader
+{
+public:
+    explicit Reader(const QByteArray &data) : m_data(data), m_pos(0), m_ok(true) {}
+
+    bool ok() const { return m_ok; }
+    bool atEnd() const { return m_pos >= m_data.size(); }
+
+    quint8 byte()
+    {
+        if (m_pos >= m_data.size()) {
+            m_ok = false;
+            return 0;
+        }
+        return quint8(m_data[m_pos++]);
+    }
+
+    quint64 varint()
+    {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const quint8 b = byte();
+            value |= quint64(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        m_ok = false;
+        return 0;
+    }
+
+    qint64 signedVarint()
+    {
+        const quint64 value = varint();
+        return qint64(value >> 1) ^ -qint64(value & 1);
+    }
+
+    QPointF angle(const QPointF &center, qreal radius)
+    {
+        const quint16 low = byte();
+        const quint16 quantized = quint16(low | (quint16(byte()) << 8));
+        const qreal angle = quantized / 65536.0 * 2 * M_PI;
+        return center + QPointF(qCos(angle), qSin(angle)) * radius;
+    }
+
+private:
+    const QByteArray &m_data;
+    int m_pos;
+    bool m_ok;
+};
+}
+
+BallStreamEncoder::BallStreamEncoder(qreal tickSeconds)
+    : m_tickUs(qRound64(tickSeconds * 1e6))
+    , m_lastTick(0)
+    , m_radius(0)
+    , m_needKeyframe(true)
+    , m_lastFrameBytes(0)
+{}
+
+QByteArray BallStreamEncoder::encode(const BallWorld &world)
+{
+    const quint64 tick = world.tickCount();
+
+    // 世界被重置、跳过了步数、球数或圆圈改变时，增量无法衔接，改发关键帧
+    if (!m_needKeyframe) {
+        if (tick == m_lastTick) {
+            return QByteArray();
+        }
+        m_needKeyframe = tick != m_lastTick + 1
+                || world.balls().size() != m_mirror.size()
+                || world.circleCenter() != m_center
+                || world.circleRadius() != m_radius;
+    }
+
+    const QByteArray payload = m_needKeyframe ? encodeKeyframe(world) : encodeDelta(world);
+    m_needKeyframe = false;
+    m_lastTick = tick;
+
+    const QByteArray out = frame(payload);
+    m_lastFrameBytes = out.size();
+    return out;
+}
+
+void BallStreamEncoder::requestKeyframe()
+{
+    m_needKeyframe = true;
+}
+
+int BallStreamEncoder::lastFrameBytes() const
+{
+    return m_lastFrameBytes;
+}
+
+QByteArray BallStreamEncoder::encodeKeyframe(const BallWorld &world)
+{
+    const QList<Ball*> &balls = world.balls();
+    m_center = world.circleCenter();
+    m_radius = world.circleRadius();
+    m_mirror.resize(balls.size());
+
+    QByteArray out;
+    writeByte(out, kKeyframe);
+    writeVarint(out, world.tickCount());
+    writeVarint(out, quint64(m_tickUs));
+    writeSigned(out, qRound64(m_center.x() * kWireScale));
+    writeSigned(out, qRound64(m_center.y() * kWireScale));
+    writeVarint(out, quint64(qRound64(m_radius * kWireScale)));
+    writeByte(out, quint8(world.outcome()));
+    writeSigned(out, world.winnerId());
+    writeVarint(out, quint64(balls.size()));
+
+    for (int i = 0; i < balls.size(); i++) {
+        const Ball *ball = balls[i];
+        const QPointF relative = ball->position() - m_center;
+        MirrorBall &mirror = m_mirror[i];
+        mirror.x = qRound64(relative.x() * kWireScale) * kMirrorPerWire;
+        mirror.y = qRound64(relative.y() * kWireScale) * kMirrorPerWire;
+        mirror.vx = qint32(qRound64(ball->velocity().x() * kWireScale));
+        mirror.vy = qint32(qRound64(ball->velocity().y() * kWireScale));
+
+        writeVarint(out, quint64(qRound64(ball->radius() * kWireScale)));
+        const QColor color = ball->color();
+        writeByte(out, quint8(color.red()));
+        writeByte(out, quint8(color.green()));
+        writeByte(out, quint8(color.blue()));
+        writeByte(out, ball->isEliminated() ? 1 : 0);
+        writeSigned(out, mirror.x / kMirrorPerWire);
+        writeSigned(out, mirror.y / kMirrorPerWire);
+        writeSigned(out, mirror.vx);
+        writeSigned(out, mirror.vy);
+
+        const QList<QPointF> connections = ball->connections();
+        writeVarint(out, quint64(connections.size()));
+        for (const QPointF &point : connections) {
+            writeAngle(out, point, m_center);
+        }
+    }
+
+    return out;
+}
+
+QByteArray BallStreamEncoder::encodeDelta(const BallWorld &world)
+{
+    const QList<Ball*> &balls = world.balls();
+
+    QByteArray out;
+    writeByte(out, kDelta);
+    writeVarint(out, world.tickCount());
+    writeByte(out, quint8(world.outcome()));
+    writeSigned(out, world.winnerId());
+
+    // 连接线事件
+    const QVector<BallWorld::ConnectionEvent> &events = world.events();
+    writeVarint(out, quint64(events.size()));
+    for (const BallWorld::ConnectionEvent &event : events) {
+        writeByte(out, quint8(event.type));
+        writeVarint(out, quint64(event.ballId));
+        if (event.type == BallWorld::ConnectionEvent::Added) {
+            writeAngle(out, event.circlePoint, m_center);
+        } else {
+            writeVarint(out, quint64(event.fromBallId));
+            writeVarint(out, quint64(event.connectionIndex));
+        }
+    }
+
+    // 航位推算修正：先按镜像速度推进，再只为偏差过大或速度改变的球发送修正
+    QByteArray updates;
+    int updateCount = 0;
+    int previousIndex = -1;
+    for (int i = 0; i < balls.size(); i++) {
+        const Ball *ball = balls[i];
+        if (ball->isEliminated()) {
+            continue;
+        }
+
+        MirrorBall &mirror = m_mirror[i];
+        mirror.x = advance(mirror.x, mirror.vx, m_tickUs);
+        mirror.y = advance(mirror.y, mirror.vy, m_tickUs);
+
+        const QPointF relative = ball->position() - m_center;
+        const qint64 errorX = qRound64(relative.x() * kMirrorScale) - mirror.x;
+        const qint64 errorY = qRound64(relative.y() * kMirrorScale) - mirror.y;
+        const qint32 vx = qint32(qRound64(ball->velocity().x() * kWireScale));
+        const qint32 vy = qint32(qRound64(ball->velocity().y() * kWireScale));
+
+        if (qAbs(errorX) <= kMaxDrift && qAbs(errorY) <= kMaxDrift && vx == mirror.vx && vy == mirror.vy) {
+            continue;
+        }
+
+        const qint64 dx = divRound(errorX, kMirrorPerWire);
+        const qint64 dy = divRound(errorY, kMirrorPerWire);
+        writeVarint(updates, quint64(i - previousIndex - 1));
+        writeSigned(updates, dx);
+        writeSigned(updates, dy);
+        writeSigned(updates, vx - mirror.vx);
+        writeSigned(updates, vy - mirror.vy);
+
+        mirror.x += dx * kMirrorPerWire;
+        mirror.y += dy * kMirrorPerWire;
+        mirror.vx = vx;
+        mirror.vy = vy;
+        previousIndex = i;
+        updateCount++;
+    }
+
+    writeVarint(out, quint64(updateCount));
+    out.append(updates);
+    return out;
+}
+
+BallStreamDecoder::BallStreamDecoder()
+    : m_tickUs(0)
+    , m_tick(0)
+    , m_hasKeyframe(false)
+    , m_error(false)
+    , m_lastFrameBytes(0)
+{}
+
+bool BallStreamDecoder::feed(const QByteArray &data, BallWorld *world)
+{
+    if (m_error) {
+        return false;
+    }
+
+    m_buffer.append(data);
+
+    bool applied = false;
+    int offset = 0;
+    while (m_buffer.size() - offset >= 4) {
+        quint32 size = 0;
+        for (int i = 0; i < 4; i++) {
+            size |= quint32(quint8(m_buffer[offset + i])) << (8 * i);
+        }
+        if (size > quint32(kMaxFrameBytes)) {
+            m_error = true;
+            break;
+        }
+        if (m_buffer.size() - offset - 4 < int(size)) {
+            break;
+        }
+
+        const QByteArray payload = m_buffer.mid(offset + 4, int(size));
+        offset += 4 + int(size);
+        if (!applyFrame(payload, world)) {
+            m_error = true;
+            break;
+        }
+        m_lastFrameBytes = int(size) + 4;
+        applied = true;
+    }
+
+    m_buffer.remove(0, offset);
+    if (applied) {
+        writeBack(world);
+    }
+    return applied;
+}
+
+bool BallStreamDecoder::hasError() const
+{
+    return m_error;
+}
+
+quint64 BallStreamDecoder::tick() const
+{
+    return m_tick;
+}
+
+int BallStreamDecoder::lastFrameBytes() const
+{
+    return m_lastFrameBytes;
+}
+
+bool BallStreamDecoder::applyFrame(const QByteArray &payload, BallWorld *world)
+{
+    if (payload.isEmpty()) {
+        return false;
+    }
+
+    switch (quint8(payload[0])) {
+    case kKeyframe:
+        return applyKeyframe(payload, world);
+    case kDelta:
+        // 没有关键帧之前的增量无法应用，直接丢弃
+        return m_hasKeyframe ? applyDelta(payload, world) : true;
+    default:
+        return false;
+    }
+}
+
+bool BallStreamDecoder::applyKeyframe(const QByteArray &payload, BallWorld *world)
+{
+    Reader reader(payload);
+    reader.byte();
+    m_tick = reader.varint();
+    m_tickUs = qint64(reader.varint());
+    const qreal cx = reader.signedVarint() / qreal(kWireScale);
+    const qreal cy = reader.signedVarint() / qreal(kWireScale);
+    const QPointF center(cx, cy);
+    const qreal radius = reader.varint() / qreal(kWireScale);
+    const BallWorld::Outcome outcome = BallWorld::Outcome(reader.byte());
+    const int winnerId = int(reader.signedVarint());
+    const quint64 ballCount = reader.varint();
+    if (!reader.ok() || ballCount > quint64(payload.size())) {
+        return false;
+    }
+
+    world->clear(center, radius);
+    m_mirror.resize(int(ballCount));
+
+    for (int i = 0; i < int(ballCount); i++) {
+        Ball *ball = world->addBall();
+        ball->setRadius(reader.varint() / qreal(kWireScale));
+        const int red = reader.byte();
+        const int green = reader.byte();
+        const int blue = reader.byte();
+        ball->setColor(QColor(red, green, blue));
+        const bool eliminated = reader.byte() & 1;
+
+        MirrorBall &mirror = m_mirror[i];
+        mirror.x = reader.signedVarint() * kMirrorPerWire;
+        mirror.y = reader.signedVarint() * kMirrorPerWire;
+        mirror.vx = qint32(reader.signedVarint());
+        mirror.vy = qint32(reader.signedVarint());
+
+        const quint64 connectionCount = reader.varint();
+        if (!reader.ok() || connectionCount > quint64(payload.size())) {
+            return false;
+        }
+        for (quint64 c = 0; c < connectionCount; c++) {
+            ball->addConnection(reader.angle(center, radius));
+        }
+        ball->setEliminated(eliminated);
+    }
+
+    world->setOutcome(outcome, winnerId);
+    m_hasKeyframe = reader.ok();
+    return reader.ok();
+}
+
+bool BallStreamDecoder::applyDelta(const QByteArray &payload, BallWorld *world)
+{
+    const QList<Ball*> &balls = world->balls();
+
+    Reader reader(payload);
+    reader.byte();
+    m_tick = reader.varint();
+    const BallWorld::Outcome outcome = BallWorld::Outcome(reader.byte());
+    const int winnerId = int(reader.signedVarint());
+
+    // 先应用连接线事件，淘汰状态由此得出，与编码器推进时看到的状态一致
+    const quint64 eventCount = reader.varint();
+    for (quint64 e = 0; e < eventCount && reader.ok(); e++) {
+        const quint8 type = reader.byte();
+        const int ballId = int(reader.varint());
+        if (ballId < 0 || ballId >= balls.size()) {
+            return false;
+        }
+        if (type == BallWorld::ConnectionEvent::Added) {
+            balls[ballId]->addConnection(reader.angle(world->circleCenter(), world->circleRadius()));
+        } else if (type == BallWorld::ConnectionEvent::Transferred) {
+            const int fromId = int(reader.varint());
+            const int index = int(reader.varint());
+            if (fromId < 0 || fromId >= balls.size() || index < 0 || index >= balls[fromId]->connectionCount()) {
+                return false;
+            }
+            const QPointF circlePoint = balls[fromId]->connections().at(index);
+            balls[fromId]->removeConnection(index);
+            balls[ballId]->addConnection(circlePoint);
+        } else {
+            return false;
+        }
+    }
+
+    // 按镜像速度推进所有未淘汰的球
+    for (int i = 0; i < balls.size(); i++) {
+        if (!balls[i]->isEliminated()) {
+            MirrorBall &mirror = m_mirror[i];
+            mirror.x = advance(mirror.x, mirror.vx, m_tickUs);
+            mirror.y = advance(mirror.y, mirror.vy, m_tickUs);
+        }
+    }
+
+    // 应用修正
+    const quint64 updateCount = reader.varint();
+    int index = -1;
+    for (quint64 u = 0; u < updateCount && reader.ok(); u++) {
+        index += int(reader.varint()) + 1;
+        if (index < 0 || index >= m_mirror.size()) {
+            return false;
+        }
+        MirrorBall &mirror = m_mirror[index];
+        mirror.x += reader.signedVarint() * kMirrorPerWire;
+        mirror.y += reader.signedVarint() * kMirrorPerWire;
+        mirror.vx += qint32(reader.signedVarint());
+        mirror.vy += qint32(reader.signedVarint());
+    }
+
+    world->setOutcome(outcome, winnerId);
+    return reader.ok();
+}
+
+void BallStreamDecoder::writeBack(BallWorld *world) const
+{
+    const QList<Ball*> &balls = world->balls();
+    const QPointF center = world->circleCenter();
+    for (int i = 0; i < balls.size() && i < m_mirror.size(); i++) {
+        const MirrorBall &mirror = m_mirror[i];
+        balls[i]->setPosition(center + QPointF(mirror.x / qreal(kMirrorScale), mirror.y / qreal(kMirrorScale)));
+        balls[i]->setVelocity(QPointF(mirror.vx / qreal(kWireScale), mirror.vy / qreal(kWireScale)));
+    }
+}
@@ -0,0 +1,123 @@
+#ifndef BALLSTREAM_H
+#define BALLSTREAM_H
+
+#include <QByteArray>
+#include <QVector>
+#include "ballworld.h"
+
+/**
+ * @brief 小球世界的增量状态流编码器
+ *
+ * 每个数据帧为“4字节小端长度 + 负载”。第一帧（以及世界被重置、跳过了步数或圆圈改变时）
+ * 发送关键帧，包含所有球的量化位置、速度、颜色和连接线；之后每步只发送增量帧：
+ *   - 本步的连接线事件（新增、转移），圆上端点量化为16位角度；
+ *   - 航位推算的修正量：编码器维护一份与解码器完全相同的整数镜像状态，
+ *     双方都按上一帧的量化速度推进位置，只有偏差超过1/8像素或速度发生变化
+ *     （碰撞）的球才会发送修正，数值使用zigzag变长整数。
+ * 球在两次碰撞之间做匀速直线运动，因此大多数球在大多数步里不产生任何数据。
+ */
+class BallStreamEncoder
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param tickSeconds 世界每步的时间间隔（秒），用于航位推算
+     */
+    explicit BallStreamEncoder(qreal tickSeconds = 0.016);
+
+    /**
+     * @brief 为世界的当前状态编码一帧
+     * @param world 刚推进过一步的世界（需开启事件记录）
+     * @return 带长度前缀的数据帧；世界自上次编码后没有推进时返回空数组
+     */
+    QByteArray encode(const BallWorld &world);
+
+    /**
+     * @brief 要求下一帧发送关键帧
+     */
+    void requestKeyframe();
+
+    /**
+     * @brief 获取最近一帧的字节数（含长度前缀）
+     */
+    int lastFrameBytes() const;
+
+private:
+    struct MirrorBall {
+        qint64 x;   // 相对圆心的位置（1/4096像素）
+        qint64 y;
+        qint32 vx;  // 速度（1/16像素/秒）
+        qint32 vy;
+    };
+
+    QByteArray encodeKeyframe(const BallWorld &world);
+    QByteArray encodeDelta(const BallWorld &world);
+
+private:
+    QVector<MirrorBall> m_mirror;  // 与解码器一致的镜像状态
+    qint64 m_tickUs;               // 每步时间（微秒）
+    quint64 m_lastTick;            // 上一帧对应的世界步数
+    QPointF m_center;              // 上一帧的圆圈中心
+    qreal m_radius;                // 上一帧的圆圈半径
+    bool m_needKeyframe;           // 下一帧是否必须为关键帧
+    int m_lastFrameBytes;          // 最近一帧的大小
+};
+
+/**
+ * @brief 小球世界的增量状态流解码器
+ *
+ * 把编码器产生的字节流还原到一个BallWorld中，只用于显示，不运行物理模拟。
+ */
+class BallStreamDecoder
+{
+public:
+    BallStreamDecoder();
+
+    /**
+     * @brief 输入收到的字节并应用所有完整的数据帧
+     * @param data 新收到的字节（可以是任意分片）
+     * @param world 要更新的世界
+     * @return 本次是否应用了至少一帧
+     */
+    bool feed(const QByteArray &data, BallWorld *world);
+
+    /**
+     * @brief 数据流是否出现格式错误（出错后不再应用后续数据）
+     */
+    bool hasError() const;
+
+    /**
+     * @brief 获取最近应用的帧对应的世界步数
+     */
+    quint64 tick() const;
+
+    /**
+     * @brief 获取最近一帧的字节数（含长度前缀）
+     */
+    int lastFrameBytes() const;
+
+private:
+    struct MirrorBall {
+        qint64 x;
+        qint64 y;
+        qint32 vx;
+        qint32 vy;
+    };
+
+    bool applyFrame(const QByteArray &payload, BallWorld *world);
+    bool applyKeyframe(const QByteArray &payload, BallWorld *world);
+    bool applyDelta(const QByteArray &payload, BallWorld *world);
+    // 把镜像状态写回球的位置和速度
+    void writeBack(BallWorld *world) const;
+
+private:
+    QByteArray m_buffer;           // 尚未组成完整帧的字节
+    QVector<MirrorBall> m_mirror;  // 镜像状态
+    qint64 m_tickUs;               // 每步时间（微秒）
+    quint64 m_tick;                // 最近一帧的世界步数
+    bool m_hasKeyframe;            // 是否已收到关键帧
+    bool m_error;                  // 是否出现格式错误
+    int m_lastFrameBytes;          // 最近一帧的大小
+};
+
+#endif // BALLSTREAM_H
@@ -0,0 +1,743 @@
+#include "ballworld.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// 球数少于该值时直接两两检测，不建立网格
+const int kGridThreshold = 32;
+
+// 接触求解器的迭代次数
+const int kVelocityIterations = 8;
+const int kPositionIterations = 4;
+// 接近速度低于该值（像素/秒）的接触不反弹，避免挤在一起的球互相抖动
+const qreal kRestitutionThreshold = 1.0;
+// 每次位置迭代修正的重叠比例
+const qreal kPositionRelaxation = 0.8;
+
+// 并查集查找（路径减半）
+int findRoot(QVector<int> &parent, int i)
+{
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+qreal dot(const QPointF &a, const QPointF &b)
+{
+    return a.x() * b.x() + a.y() * b.y();
+}
+
+// 点到线段的最短距离
+qreal segmentDistance(const QPointF &point, const QPointF &lineStart, const QPointF &lineEnd)
+{
+    QPointF lineVector = lineEnd - lineStart;
+    QPointF pointVector = point - lineStart;
+
+    qreal t = qMax(0.0, qMin(1.0,
+        (pointVector.x() * lineVector.x() + pointVector.y() * lineVector.y()) /
+        (lineVector.x() * lineVector.x() + lineVector.y() * lineVector.y())));
+
+    QPointF closestPoint = lineStart + lineVector * t;
+    QPointF distanceVector = point - closestPoint;
+    return sqrt(distanceVector.x() * distanceVector.x() + distanceVector.y() * distanceVector.y());
+}
+}
+
+BallWorld::BallWorld(quint32 seed)
+    : m_random(seed)
+    , m_circleRadius(200)
+    , m_tickCount(0)
+    , m_outcome(Running)
+    , m_winnerId(-1)
+    , m_recordEvents(false)
+    , m_pool(nullptr)
+{}
+
+BallWorld::~BallWorld()
+{
+    qDeleteAll(m_balls);
+}
+
+void BallWorld::reseed(quint32 seed)
+{
+    m_random.seed(seed);
+}
+
+void BallWorld::reset(const QPointF &center, qreal radius, int ballCount, qreal ballRadius)
+{
+    // 清理现有球
+    qDeleteAll(m_balls);
+    m_balls.clear();
+
+    m_circleCenter = center;
+    m_circleRadius = radius;
+    m_tickCount = 0;
+    m_outcome = Running;
+    m_winnerId = -1;
+    m_events.clear();
+
+    // 前三个球沿用红、蓝、绿，其余按色相均匀分布
+    const QList<QColor> colors = {Qt::red, Qt::blue, Qt::green};
+
+    for (int i = 0; i < ballCount; i++) {
+        Ball *ball = new Ball;
+        ball->setRadius(ballRadius);
+        ball->setColor(i < colors.size() ? colors[i] : QColor::fromHsv((i * 137) % 360, 200, 220));
+        ball->setId(i);
+
+        // 随机设置初始位置（在圆圈内但不靠近边缘）
+        qreal angle = m_random.generateDouble() * 2 * 3.1415;
+        qreal distance = m_circleRadius * 0.3 + m_random.generateDouble() * m_circleRadius * 0.5;
+        qreal x = m_circleCenter.x() + distance * cos(angle);
+        qreal y = m_circleCenter.y() + distance * sin(angle);
+        ball->setPosition(QPointF(x, y));
+
+        // 随机设置初始速度
+        qreal speed = 50.0 + m_random.generateDouble() * 100.0;
+        qreal velocityAngle = m_random.generateDouble() * 2 * 3.1415;
+        ball->setVelocity(QPointF(speed * cos(velocityAngle), speed * sin(velocityAngle)));
+
+        m_balls.append(ball);
+    }
+}
+
+void BallWorld::clear(const QPointF &center, qreal radius)
+{
+    qDeleteAll(m_balls);
+    m_balls.clear();
+
+    m_circleCenter = center;
+    m_circleRadius = radius;
+    m_outcome = Running;
+    m_winnerId = -1;
+    m_events.clear();
+}
+
+Ball *BallWorld::addBall()
+{
+    Ball *ball = new Ball;
+    ball->setId(m_balls.size());
+    m_balls.append(ball);
+    return ball;
+}
+
+void BallWorld::setArena(const QPointF &center, qreal radius)
+{
+    // 保存旧的中心和半径用于计算缩放因子
+    QPointF oldCenter = m_circleCenter;
+    qreal oldRadius = m_circleRadius;
+
+    m_circleCenter = center;
+    m_circleRadius = radius;
+
+    // 如果是第一次调整或者半径为0，不进行缩放计算
+    if (oldRadius <= 0) {
+        return;
+    }
+
+    qreal scaleFactor = m_circleRadius / oldRadius;
+
+    // 调整所有球的位置和连接线
+    for (Ball *ball : qAsConst(m_balls)) {
+        if (!ball->isEliminated()) {
+            // 调整球的位置
+            QPointF relativePos = ball->position() - oldCenter;
+            ball->setPosition(m_circleCenter + relativePos * scaleFactor);
+
+            // 备份连接线
+            QList<QPointF> oldConnections = ball->connections();
+
+            // 清除旧连接线
+            while (ball->connectionCount() > 0) {
+                ball->removeConnection(0);
+            }
+
+            // 重新添加调整后的连接线
+            for (const QPointF &oldConn : oldConnections) {
+                QPointF relativeConn = oldConn - oldCenter;
+                ball->addConnection(m_circleCenter + relativeConn * scaleFactor);
+            }
+        }
+    }
+}
+
+void BallWorld::setThreadPool(WorkStealingPool *pool)
+{
+    m_pool = pool;
+}
+
+bool BallWorld::step(qreal deltaTime)
+{
+    if (m_outcome != Running) {
+        return false;
+    }
+
+    m_events.clear();
+    const int count = m_balls.size();
+
+    // 更新所有球的位置并检测与圆圈的碰撞（每个球只读写自己）
+    m_circleHits.fill(0, count);
+    parallelFor(count, chunkGrain(count), [this, deltaTime](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            Ball *ball = m_balls[i];
+            if (ball->isEliminated()) {
+                continue;
+            }
+            ball->updatePosition(deltaTime);
+            QPointF centerToBall = ball->position() - m_circleCenter;
+            qreal distance = sqrt(centerToBall.x() * centerToBall.x() + centerToBall.y() * centerToBall.y());
+            m_circleHits[i] = distance + ball->radius() >= m_circleRadius;
+        }
+    });
+
+    // 按球序号处理与圆圈的碰撞
+    for (int i = 0; i < count; i++) {
+        if (m_circleHits[i]) {
+            checkCircleCollision(m_balls[i]);
+        }
+    }
+
+    // 检查球与球的碰撞：并行检测，按岛屿求解
+    detectBallContacts();
+    solveBallContacts();
+
+    // 检查球是否碰到线
+    checkLineCollision();
+
+    m_tickCount++;
+
+    return !checkGameOver();
+}
+
+const QList<Ball*> &BallWorld::balls() const
+{
+    return m_balls;
+}
+
+QPointF BallWorld::circleCenter() const
+{
+    return m_circleCenter;
+}
+
+qreal BallWorld::circleRadius() const
+{
+    return m_circleRadius;
+}
+
+quint64 BallWorld::tickCount() const
+{
+    return m_tickCount;
+}
+
+void BallWorld::setEventRecording(bool enabled)
+{
+    m_recordEvents = enabled;
+    m_events.clear();
+}
+
+const QVector<BallWorld::ConnectionEvent> &BallWorld::events() const
+{
+    return m_events;
+}
+
+BallWorld::Outcome BallWorld::outcome() const
+{
+    return m_outcome;
+}
+
+void BallWorld::setOutcome(Outcome outcome, int winnerId)
+{
+    m_outcome = outcome;
+    m_winnerId = winnerId;
+}
+
+int BallWorld::winnerId() const
+{
+    return m_winnerId;
+}
+
+// 修改checkCircleCollision函数，添加边界检查
+void BallWorld::checkCircleCollision(Ball *ball)
+{
+    QPointF pos = ball->position();
+    QPointF centerToBall = pos - m_circleCenter;
+    qreal distance = sqrt(centerToBall.x() * centerToBall.x() + centerToBall.y() * centerToBall.y());
+
+    // 检查是否与圆圈碰撞（考虑球的半径）
+    if (distance + ball->radius() >= m_circleRadius) {
+        // 计算碰撞点
+        QPointF collisionPoint = m_circleCenter + centerToBall * (m_circleRadius / distance);
+
+        // 添加连接线
+        ball->addConnection(collisionPoint);
+        if (m_recordEvents) {
+            m_events.append({ConnectionEvent::Added, ball->id(), -1, -1, collisionPoint});
+        }
+
+        // 计算反弹后的速度
+        // 法向量（指向圆心）
+        QPointF normal = centerToBall / distance;
+
+        // 速度在法向量方向的分量
+        QPointF velocity = ball->velocity();
+        qreal dotProduct = velocity.x() * normal.x() + velocity.y() * normal.y();
+
+        // 反弹后的速度（保留切线方向的分量，反转法向量方向的分量）
+        QPointF newVelocity = velocity - 2 * dotProduct * normal;
+
+        // 设置新速度 - 移除速度衰减因子0.95，保持速度不变
+        ball->setVelocity(newVelocity);  // 移除 * 0.95
+
+        // 调整球的位置，防止卡在圆圈外
+        QPointF newPosition = m_circleCenter + normal * (m_circleRadius - ball->radius());
+        ball->setPosition(newPosition);
+    }
+}
+
+void BallWorld::parallelFor(int count, int grain, const WorkStealingPool::RangeFunction &body)
+{
+    if (m_pool) {
+        m_pool->parallelFor(count, grain, body);
+    } else if (count > 0) {
+        body(0, count);
+    }
+}
+
+int BallWorld::chunkGrain(int count) const
+{
+    // 每个线程约4块；分块大小只影响调度，不影响结果
+    const int threads = m_pool ? m_pool->threadCount() : 1;
+    return qMax(16, (count + threads * 4 - 1) / (threads * 4));
+}
+
+void BallWorld::mergeContacts(QVector<Contact> *contacts)
+{
+    contacts->clear();
+    for (QVector<Contact> &chunk : m_chunkContacts) {
+        contacts->append(chunk);
+        chunk.clear();
+    }
+    // 排序后的处理顺序与分块方式、线程数无关
+    std::sort(contacts->begin(), contacts->end());
+}
+
+void BallWorld::detectBallContacts()
+{
+    const int count = m_balls.size();
+    const int grain = chunkGrain(count);
+    m_chunkContacts.resize((count + grain - 1) / grain);
+
+    if (count < kGridThreshold) {
+        // 球数很少时直接两两检测
+        parallelFor(count, grain, [this, grain](int begin, int end) {
+            QVector<Contact> &out = m_chunkContacts[begin / grain];
+            for (int i = begin; i < end; i++) {
+                const Ball *ball1 = m_balls[i];
+                if (ball1->isEliminated()) {
+                    continue;
+                }
+                for (int j = i + 1; j < m_balls.size(); j++) {
+                    const Ball *ball2 = m_balls[j];
+                    if (ball2->isEliminated()) {
+                        continue;
+                    }
+                    QPointF delta = ball2->position() - ball1->position();
+                    qreal distance = sqrt(delta.x() * delta.x() + delta.y() * delta.y());
+                    if (distance <= ball1->radius() + ball2->radius()) {
+                        out.append({i, j});
+                    }
+                }
+            }
+        });
+        mergeContacts(&m_ballContacts);
+        return;
+    }
+
+    // 均匀网格：格子边长为最大直径，只需检查相邻的3x3个格子
+    qreal maxRadius = 1.0;
+    for (const Ball *ball : qAsConst(m_balls)) {
+        maxRadius = qMax(maxRadius, ball->radius());
+    }
+    const qreal cellSize = qMax(2 * maxRadius, 2 * m_circleRadius / 1024);
+    const QPointF origin = m_circleCenter - QPointF(m_circleRadius, m_circleRadius);
+    const int columns = qMax(1, int(2 * m_circleRadius / cellSize) + 1);
+    const int rows = columns;
+
+    // 计数排序把球按格子排列
+    m_ballCell.fill(-1, count);
+    m_gridStart.fill(0, columns * rows + 1);
+    for (int i = 0; i < count; i++) {
+        const Ball *ball = m_balls[i];
+        if (ball->isEliminated()) {
+            continue;
+        }
+        QPointF local = (ball->position() - origin) / cellSize;
+        int cx = qBound(0, int(floor(local.x())), columns - 1);
+        int cy = qBound(0, int(floor(local.y())), rows - 1);
+        m_ballCell[i] = cy * columns + cx;
+        m_gridStart[m_ballCell[i] + 1]++;
+    }
+    for (int c = 0; c < columns * rows; c++) {
+        m_gridStart[c + 1] += m_gridStart[c];
+    }
+    m_gridBalls.resize(m_gridStart.last());
+    QVector<int> fill = m_gridStart;
+    for (int i = 0; i < count; i++) {
+        if (m_ballCell[i] >= 0) {
+            m_gridBalls[fill[m_ballCell[i]]++] = i;
+        }
+    }
+
+    parallelFor(count, grain, [this, grain, columns, rows](int begin, int end) {
+        QVector<Contact> &out = m_chunkContacts[begin / grain];
+        for (int i = begin; i < end; i++) {
+            const int cell = m_ballCell[i];
+            if (cell < 0) {
+                continue;
+            }
+            const Ball *ball1 = m_balls[i];
+            const int cx = cell % columns;
+            const int cy = cell / columns;
+            for (int ny = qMax(0, cy - 1); ny <= qMin(rows - 1, cy + 1); ny++) {
+                for (int nx = qMax(0, cx - 1); nx <= qMin(columns - 1, cx + 1); nx++) {
+                    const int neighbor = ny * columns + nx;
+                    for (int k = m_gridStart[neighbor]; k < m_gridStart[neighbor + 1]; k++) {
+                        const int j = m_gridBalls[k];
+                        if (j <= i) {
+                            continue;
+                        }
+                        const Ball *ball2 = m_balls[j];
+                        QPointF delta = ball2->position() - ball1->position();
+                        qreal distance = sqrt(delta.x() * delta.x() + delta.y() * delta.y());
+                        if (distance <= ball1->radius() + ball2->radius()) {
+                            out.append({i, j});
+                        }
+                    }
+                }
+            }
+        }
+    });
+    mergeContacts(&m_ballContacts);
+}
+
+void BallWorld::solveBallContacts()
+{
+    const int count = m_balls.size();
+    const int contactCount = m_ballContacts.size();
+
+    // 两步的接触都按(i, j)排序，归并即可取出同一对球上一步的累计冲量
+    m_previousContacts.swap(m_solverContacts);
+    m_solverContacts.resize(contactCount);
+    int previous = 0;
+    for (int c = 0; c < contactCount; c++) {
+        const Contact &pair = m_ballContacts[c];
+        while (previous < m_previousContacts.size() && m_previousContacts[previous].pair < pair) {
+            previous++;
+        }
+        SolverContact &contact = m_solverContacts[c];
+        contact.pair = pair;
+        contact.impulse = 0.0;
+        if (previous < m_previousContacts.size()
+                && m_previousContacts[previous].pair.first == pair.first
+                && m_previousContacts[previous].pair.second == pair.second) {
+            // 只预热持续挤压的接触；反弹的冲量只属于那一步，重复施加会凭空增加能量
+            const SolverContact &last = m_previousContacts[previous];
+            contact.impulse = last.bouncing ? 0.0 : last.impulse;
+        }
+    }
+    if (contactCount == 0) {
+        return;
+    }
+
+    // 并查集把互相接触的球合并为岛屿
+    m_islandParent.resize(count);
+    for (int i = 0; i < count; i++) {
+        m_islandParent[i] = i;
+    }
+    for (const Contact &pair : qAsConst(m_ballContacts)) {
+        int root1 = findRoot(m_islandParent, pair.first);
+        int root2 = findRoot(m_islandParent, pair.second);
+        if (root1 != root2) {
+            // 以较小的序号为根，岛屿的划分与合并顺序无关
+            m_islandParent[qMax(root1, root2)] = qMin(root1, root2);
+        }
+    }
+
+    // 按根节点序号给岛屿编号，再用计数排序把接触和球按岛屿排列
+    m_islandOf.fill(-1, count);
+    for (const Contact &pair : qAsConst(m_ballContacts)) {
+        m_islandOf[findRoot(m_islandParent, pair.first)] = 0;
+    }
+    int islandCount = 0;
+    for (int i = 0; i < count; i++) {
+        if (m_islandOf[i] == 0) {
+            m_islandOf[i] = ++islandCount;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        m_islandOf[i] = m_islandOf[i] > 0 ? m_islandOf[i] - 1 : -1;
+    }
+    m_islandStart.fill(0, islandCount + 1);
+    m_islandBallStart.fill(0, islandCount + 1);
+    for (const Contact &pair : qAsConst(m_ballContacts)) {
+        m_islandStart[m_islandOf[findRoot(m_islandParent, pair.first)] + 1]++;
+    }
+    for (int i = 0; i < count; i++) {
+        const int island = m_islandOf[findRoot(m_islandParent, i)];
+        if (island >= 0) {
+            m_islandBallStart[island + 1]++;
+        }
+    }
+    for (int k = 0; k < islandCount; k++) {
+        m_islandStart[k + 1] += m_islandStart[k];
+        m_islandBallStart[k + 1] += m_islandBallStart[k];
+    }
+    m_islandContacts.resize(contactCount);
+    m_islandBalls.resize(m_islandBallStart.last());
+    QVector<int> fill = m_islandStart;
+    for (int c = 0; c < contactCount; c++) {
+        m_islandContacts[fill[m_islandOf[findRoot(m_islandParent, m_ballContacts[c].first)]]++] = c;
+    }
+    fill = m_islandBallStart;
+    for (int i = 0; i < count; i++) {
+        const int island = m_islandOf[findRoot(m_islandParent, i)];
+        if (island >= 0) {
+            m_islandBalls[fill[island]++] = i;
+        }
+    }
+
+    // 岛屿之间没有共享的球，可以并行求解
+    m_solverPositions.resize(count);
+    m_solverVelocities.resize(count);
+    const int threads = m_pool ? m_pool->threadCount() : 1;
+    parallelFor(islandCount, qMax(1, islandCount / (threads * 4)), [this](int begin, int end) {
+        for (int island = begin; island < end; island++) {
+            solveIsland(island);
+        }
+    });
+}
+
+void BallWorld::solveIsland(int island)
+{
+    const int contactBegin = m_islandStart[island];
+    const int contactEnd = m_islandStart[island + 1];
+
+    qreal energyBefore = 0.0;
+    for (int k = m_islandBallStart[island]; k < m_islandBallStart[island + 1]; k++) {
+        const int i = m_islandBalls[k];
+        m_solverPositions[i] = m_balls[i]->position();
+        m_solverVelocities[i] = m_balls[i]->velocity();
+        energyBefore += dot(m_solverVelocities[i], m_solverVelocities[i]);
+    }
+
+    // 准备：计算法向量、判断是否为碰撞，并施加上一步的冲量预热
+    // 所有球质量相同，一对球的有效质量为1/2，冲量直接以速度变化量表示
+    for (int k = contactBegin; k < contactEnd; k++) {
+        SolverContact &contact = m_solverContacts[m_islandContacts[k]];
+        const int i = contact.pair.first;
+        const int j = contact.pair.second;
+        QPointF delta = m_solverPositions[j] - m_solverPositions[i];
+        qreal distance = sqrt(dot(delta, delta));
+        contact.normal = distance > 0 ? delta / distance : QPointF(1, 0);
+
+        qreal normalVelocity = dot(m_solverVelocities[j] - m_solverVelocities[i], contact.normal);
+        contact.bouncing = normalVelocity < -kRestitutionThreshold;
+
+        m_solverVelocities[i] -= contact.normal * contact.impulse;
+        m_solverVelocities[j] += contact.normal * contact.impulse;
+    }
+
+    // 速度迭代：求使所有接触不再接近的冲量，累计冲量不小于0（球之间只能互相推开）
+    for (int iteration = 0; iteration < kVelocityIterations; iteration++) {
+        for (int k = contactBegin; k < contactEnd; k++) {
+            SolverContact &contact = m_solverContacts[m_islandContacts[k]];
+            const int i = contact.pair.first;
+            const int j = contact.pair.second;
+            qreal normalVelocity = dot(m_solverVelocities[j] - m_solverVelocities[i], contact.normal);
+            qreal impulse = qMax(0.0, contact.impulse - normalVelocity * 0.5);
+            qreal change = impulse - contact.impulse;
+            contact.impulse = impulse;
+            m_solverVelocities[i] -= contact.normal * change;
+            m_solverVelocities[j] += contact.normal * change;
+        }
+    }
+
+    // 弹性碰撞：碰撞接触再施加一次相同的冲量（泊松恢复系数为1），
+    // 两个球时等价于交换法向速度，多个球同时接触时总动能保持不变
+    for (int k = contactBegin; k < contactEnd; k++) {
+        const SolverContact &contact = m_solverContacts[m_islandContacts[k]];
+        if (contact.bouncing) {
+            m_solverVelocities[contact.pair.first] -= contact.normal * contact.impulse;
+            m_solverVelocities[contact.pair.second] += contact.normal * contact.impulse;
+        }
+    }
+
+    // 迭代次数有限时大岛屿的解不完全收敛，反弹可能凭空增加能量，这里把总动能限制在求解前的水平
+    qreal energyAfter = 0.0;
+    for (int k = m_islandBallStart[island]; k < m_islandBallStart[island + 1]; k++) {
+        const int i = m_islandBalls[k];
+        energyAfter += dot(m_solverVelocities[i], m_solverVelocities[i]);
+    }
+    if (energyAfter > energyBefore && energyAfter > 0) {
+        const qreal scale = sqrt(energyBefore / energyAfter);
+        for (int k = m_islandBallStart[island]; k < m_islandBallStart[island + 1]; k++) {
+            m_solverVelocities[m_islandBalls[k]] *= scale;
+        }
+    }
+
+    // 位置迭代：按当前位置修正重叠，两个球各移动一半
+    for (int iteration = 0; iteration < kPositionIterations; iteration++) {
+        for (int k = contactBegin; k < contactEnd; k++) {
+            const SolverContact &contact = m_solverContacts[m_islandContacts[k]];
+            const int i = contact.pair.first;
+            const int j = contact.pair.second;
+            QPointF delta = m_solverPositions[j] - m_solverPositions[i];
+            qreal distance = sqrt(dot(delta, delta));
+            qreal overlap = m_balls[i]->radius() + m_balls[j]->radius() - distance;
+            if (overlap <= 0) {
+                continue;
+            }
+            QPointF normal = distance > 0 ? delta / distance : contact.normal;
+            QPointF correction = normal * (overlap * kPositionRelaxation * 0.5);
+            m_solverPositions[i] -= correction;
+            m_solverPositions[j] += correction;
+        }
+    }
+
+    for (int k = m_islandBallStart[island]; k < m_islandBallStart[island + 1]; k++) {
+        const int i = m_islandBalls[k];
+        m_balls[i]->setPosition(m_solverPositions[i]);
+        m_balls[i]->setVelocity(m_solverVelocities[i]);
+    }
+}
+
+void BallWorld::checkLineCollision()
+{
+    // 检测阶段：所有球的位置在本阶段不再改变，只需检测一次
+    detectLineContacts();
+
+    // 处理阶段：按(碰线的球, 线的所有者)顺序转移连接线
+    for (const Contact &contact : qAsConst(m_lineContacts)) {
+        Ball *ball = m_balls[contact.first];
+        Ball *otherBall = m_balls[contact.second];
+        if (!ball->isEliminated() && !otherBall->isEliminated()) {
+            transferLine(ball, otherBall);
+        }
+    }
+}
+
+void BallWorld::detectLineContacts()
+{
+    const int count = m_balls.size();
+
+    // 把所有连接线复制为快照，按所有者排列
+    m_segments.clear();
+    m_segmentStart.fill(0, count + 1);
+    for (int j = 0; j < count; j++) {
+        const Ball *owner = m_balls[j];
+        if (!owner->isEliminated()) {
+            const QList<QPointF> connections = owner->connections();
+            for (const QPointF &circlePoint : connections) {
+                m_segments.append({owner->position(), circlePoint});
+            }
+        }
+        m_segmentStart[j + 1] = m_segments.size();
+    }
+
+    const int grain = chunkGrain(count);
+    m_chunkContacts.resize((count + grain - 1) / grain);
+    parallelFor(count, grain, [this, grain, count](int begin, int end) {
+        QVector<Contact> &out = m_chunkContacts[begin / grain];
+        for (int i = begin; i < end; i++) {
+            const Ball *ball = m_balls[i];
+            if (ball->isEliminated()) {
+                continue;
+            }
+            const QPointF ballPos = ball->position();
+            const qreal ballRadius = ball->radius();
+
+            for (int j = 0; j < count; j++) {
+                if (j == i) {
+                    continue;
+                }
+                // 每个所有者只需找到一条碰到的线
+                for (int k = m_segmentStart[j]; k < m_segmentStart[j + 1]; k++) {
+                    const LineSegment &segment = m_segments[k];
+                    // 先用包围盒快速排除
+                    if (ballPos.x() + ballRadius < qMin(segment.start.x(), segment.end.x())
+                            || ballPos.x() - ballRadius > qMax(segment.start.x(), segment.end.x())
+                            || ballPos.y() + ballRadius < qMin(segment.start.y(), segment.end.y())
+                            || ballPos.y() - ballRadius > qMax(segment.start.y(), segment.end.y())) {
+                        continue;
+                    }
+                    if (segmentDistance(ballPos, segment.start, segment.end) <= ballRadius) {
+                        out.append({i, j});
+                        break;
+                    }
+                }
+            }
+        }
+    });
+    mergeContacts(&m_lineContacts);
+}
+
+void BallWorld::transferLine(Ball *ball, Ball *otherBall)
+{
+    QPointF ballPos = ball->position();
+    qreal ballRadius = ball->radius();
+
+    // 检查每条连接线（使用当前列表，前面的处理可能已经改变了它）
+    QList<QPointF> connections = otherBall->connections();
+    for (int i = 0; i < connections.size(); i++) {
+        QPointF circlePoint = connections[i];
+
+        // 如果球碰到了线
+        if (segmentDistance(ballPos, otherBall->position(), circlePoint) <= ballRadius) {
+            // 移除原球的连接线
+            otherBall->removeConnection(i);
+
+            // 在新球上添加相同的连接线（圆上的点不变，球端变为新球）
+            ball->addConnection(circlePoint);
+            if (m_recordEvents) {
+                m_events.append({ConnectionEvent::Transferred, ball->id(), otherBall->id(), i, circlePoint});
+            }
+
+            // 跳出循环，因为连接线已经被移除
+            break;
+        }
+    }
+}
+
+bool BallWorld::checkGameOver()
+{
+    int activeBalls = 0;
+
+    for (Ball *ball : qAsConst(m_balls)) {
+        if (!ball->isEliminated()) {
+            activeBalls++;
+
+            // 检查是否有球达到100条连接线
+            if (ball->connectionCount() >= 100) {
+                m_outcome = LineLimitReached;
+                m_winnerId = ball->id();
+                return true;
+            }
+        }
+    }
+
+    // 检查是否只剩一个球
+    if (activeBalls <= 1) {
+        m_outcome = LastSurvivor;
+        for (Ball *ball : qAsConst(m_balls)) {
+            if (!ball->isEliminated()) {
+                m_winnerId = ball->id();
+                break;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,237 @@
+#ifndef BALLWORLD_H
+#define BALLWORLD_H
+
+#include <QList>
+#include <QPointF>
+#include <QRandomGenerator>
+#include <QVector>
+#include "ball.h"
+#include "workstealingpool.h"
+
+/**
+ * @brief 小球碰撞游戏的无界面模拟世界
+ *
+ * 持有一局比赛的全部状态（圆圈、小球、随机数生成器），负责移动、碰撞检测与胜负判定。
+ * 不依赖任何窗口部件，可以在工作线程中运行；不同实例之间不共享任何可变状态。
+ *
+ * 每一步的碰撞分为两个阶段：检测阶段只读取球的状态，可以在线程池上并行执行，
+ * 产生按球序号排序的接触记录；处理阶段在调用线程上按该顺序串行修改状态。
+ * 因此结果与线程数无关，逐位一致。
+ *
+ * 球与球的接触交给接触求解器：互相接触的球按连通关系分成若干“岛屿”，
+ * 每个岛屿用迭代冲量法求解速度、再迭代修正重叠，并用上一步同一对球的累计冲量预热。
+ * 不同岛屿没有共享的球，可以在线程池上并行求解。
+ */
+class BallWorld
+{
+public:
+    // 比赛结果
+    enum Outcome {
+        Running,          // 比赛进行中
+        LineLimitReached, // 某球达到连接线上限
+        LastSurvivor      // 只剩一个球存活
+    };
+
+    // 连接线事件，球以ID（即在balls()中的索引）标识
+    struct ConnectionEvent {
+        enum Type {
+            Added,       // 球碰到圆圈，新增一条连接线
+            Transferred  // 球碰到其他球的连接线，该线转移给碰撞球
+        };
+        Type type;
+        int ballId;          // 获得连接线的球
+        int fromBallId;      // Transferred：失去连接线的球
+        int connectionIndex; // Transferred：该线在原球连接线列表中的索引
+        QPointF circlePoint; // 连接线在圆圈上的端点
+    };
+
+    /**
+     * @brief 构造函数
+     * @param seed 随机数种子，相同种子产生相同的初始局面
+     */
+    explicit BallWorld(quint32 seed = 0);
+
+    /**
+     * @brief 析构函数，释放所有球
+     */
+    ~BallWorld();
+
+    BallWorld(const BallWorld &) = delete;
+    BallWorld &operator=(const BallWorld &) = delete;
+
+    /**
+     * @brief 重新设置随机数种子，在下一次reset时生效
+     * @param seed 随机数种子
+     */
+    void reseed(quint32 seed);
+
+    /**
+     * @brief 重新开始一局比赛
+     * @param center 圆圈中心
+     * @param radius 圆圈半径
+     * @param ballCount 球的数量
+     * @param ballRadius 球的半径
+     */
+    void reset(const QPointF &center, qreal radius, int ballCount = 3, qreal ballRadius = 15.0);
+
+    /**
+     * @brief 清空所有球并设置圆圈，用于从外部数据（如状态流）重建世界
+     * @param center 圆圈中心
+     * @param radius 圆圈半径
+     */
+    void clear(const QPointF &center, qreal radius);
+
+    /**
+     * @brief 追加一个球，ID为其在balls()中的索引
+     * @return 新球，所有权归世界所有
+     */
+    Ball *addBall();
+
+    /**
+     * @brief 调整圆圈位置和大小，球的位置与连接点按比例缩放
+     * @param center 新的圆圈中心
+     * @param radius 新的圆圈半径
+     */
+    void setArena(const QPointF &center, qreal radius);
+
+    /**
+     * @brief 设置碰撞检测使用的线程池
+     * @param pool 线程池，为nullptr时在调用线程串行检测；由调用者持有
+     *
+     * 世界本身在线程池的任务中运行时（如多场比赛服务）不要设置，线程池不可重入。
+     */
+    void setThreadPool(WorkStealingPool *pool);
+
+    /**
+     * @brief 推进一个模拟步
+     * @param deltaTime 时间间隔（秒）
+     * @return 比赛在本步之后是否仍在进行
+     */
+    bool step(qreal deltaTime);
+
+    /**
+     * @brief 获取所有球
+     * @return 球列表，所有权归世界所有
+     */
+    const QList<Ball*> &balls() const;
+
+    QPointF circleCenter() const;
+    qreal circleRadius() const;
+
+    /**
+     * @brief 设置是否记录连接线事件
+     */
+    void setEventRecording(bool enabled);
+
+    /**
+     * @brief 获取最近一步产生的连接线事件（按发生顺序）
+     */
+    const QVector<ConnectionEvent> &events() const;
+
+    /**
+     * @brief 获取已推进的模拟步数
+     */
+    quint64 tickCount() const;
+
+    /**
+     * @brief 获取比赛结果
+     */
+    Outcome outcome() const;
+
+    /**
+     * @brief 直接设置比赛结果（用于从状态流恢复）
+     * @param outcome 比赛结果
+     * @param winnerId 获胜球ID
+     */
+    void setOutcome(Outcome outcome, int winnerId);
+
+    /**
+     * @brief 获取获胜球的ID
+     * @return 获胜球ID，比赛未结束时为-1
+     */
+    int winnerId() const;
+
+private:
+    // 一对接触的球（first < second，或first为碰线的球、second为线的所有者）
+    struct Contact {
+        int first;
+        int second;
+        bool operator<(const Contact &other) const
+        {
+            return first != other.first ? first < other.first : second < other.second;
+        }
+    };
+
+    // 求解器中的接触，累计冲量保留到下一步用于预热
+    struct SolverContact {
+        Contact pair;
+        QPointF normal;  // 从first指向second的单位法向量
+        bool bouncing;   // 本步是否为碰撞（接近速度超过阈值），需要反弹
+        qreal impulse;   // 累计法向冲量（不小于0，不含反弹部分）
+    };
+
+    // 连接线快照（检测阶段使用）
+    struct LineSegment {
+        QPointF start;  // 球端
+        QPointF end;    // 圆上的点
+    };
+
+    // 在线程池上（或串行）处理区间[0, count)
+    void parallelFor(int count, int grain, const WorkStealingPool::RangeFunction &body);
+    // 检测阶段使用的分块大小
+    int chunkGrain(int count) const;
+    // 把各分块的接触记录合并并排序
+    void mergeContacts(QVector<Contact> *contacts);
+
+    // 检查球与圆圈的碰撞
+    void checkCircleCollision(Ball *ball);
+    // 检测所有互相接触的球（检测阶段）
+    void detectBallContacts();
+    // 把接触的球分成岛屿并求解所有岛屿
+    void solveBallContacts();
+    // 求解一个岛屿（只读写该岛屿的球和接触）
+    void solveIsland(int island);
+    // 检查球是否碰到线：并行检测后串行转移连接线
+    void checkLineCollision();
+    // 检测所有碰到其他球连接线的球（检测阶段）
+    void detectLineContacts();
+    // 把otherBall上第一条碰到ball的连接线转移给ball（处理阶段）
+    void transferLine(Ball *ball, Ball *otherBall);
+    // 检查游戏结束条件
+    bool checkGameOver();
+
+private:
+    QList<Ball*> m_balls;       // 所有球
+    QRandomGenerator m_random;  // 本局专用的随机数生成器
+    QPointF m_circleCenter;     // 圆圈中心
+    qreal m_circleRadius;       // 圆圈半径
+    quint64 m_tickCount;        // 已推进的步数
+    Outcome m_outcome;          // 比赛结果
+    int m_winnerId;             // 获胜球ID
+    bool m_recordEvents;        // 是否记录连接线事件
+    QVector<ConnectionEvent> m_events; // 最近一步的连接线事件
+
+    WorkStealingPool *m_pool;             // 检测阶段使用的线程池（可为nullptr）
+    QVector<char> m_circleHits;           // 每个球本步是否碰到圆圈
+    QVector<Contact> m_ballContacts;      // 本步球与球的接触（已排序）
+    QVector<Contact> m_lineContacts;      // 本步球与连接线的接触（已排序）
+    QVector<QVector<Contact>> m_chunkContacts; // 各分块的检测结果
+    QVector<int> m_gridStart;             // 均匀网格：每个格子在m_gridBalls中的起始位置
+    QVector<int> m_gridBalls;             // 均匀网格：按格子排列的球序号
+    QVector<int> m_ballCell;              // 每个球所在的格子（-1表示不参与）
+    QVector<LineSegment> m_segments;      // 连接线快照，按所有者排列
+    QVector<int> m_segmentStart;          // 每个球的连接线在m_segments中的起始位置
+
+    QVector<SolverContact> m_solverContacts;   // 本步的求解接触（按(i, j)排序）
+    QVector<SolverContact> m_previousContacts; // 上一步的求解接触，用于预热
+    QVector<int> m_islandParent;          // 并查集：每个球的父节点
+    QVector<int> m_islandOf;              // 并查集根节点对应的岛屿序号
+    QVector<int> m_islandStart;           // 每个岛屿的接触在m_islandContacts中的起始位置
+    QVector<int> m_islandContacts;        // 按岛屿排列的接触序号
+    QVector<int> m_islandBallStart;       // 每个岛屿的球在m_islandBalls中的起始位置
+    QVector<int> m_islandBalls;           // 按岛屿排列的球序号
+    QVector<QPointF> m_solverPositions;   // 求解过程中的球位置
+    QVector<QPointF> m_solverVelocities;  // 求解过程中的球速度
+};
+
+#endif // BALLWORLD_H
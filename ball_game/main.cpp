@@ -1,23 +1,40 @@
-﻿#include "ballgame.h"
-#include <QApplication>
-#include <QTextCodec>
-
-int main(int argc, char *argv[])
-{
-    // 先创建QApplication对象
-    QApplication a(argc, argv);
-    
-    // 针对Qt 5的中文显示设置
-    QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
-    
-    // 设置应用程序默认字体 - 使用更安全的方法
-    QFont font;
-    font.setFamily(QStringLiteral("SimHei")); // 使用QStringLiteral避免编码问题
-    font.setPointSize(9);
-    a.setFont(font);
-    
-    BallGame w;
-    w.show();
-    
-    return a.exec();
-}
+#include "ballgame.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QTextCodec>
+
+int main(int argc, char *argv[])
+{
+    // 先创建QApplication对象
+    QApplication a(argc, argv);
+    
+    // 针对Qt 5的中文显示设置
+    QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
+    
+    // 设置应用程序默认字体 - 使用更安全的方法
+    QFont font;
+    font.setFamily(QStringLiteral("SimHei")); // 使用QStringLiteral避免编码问题
+    font.setPointSize(9);
+    a.setFont(font);
+    
+    // 命令行参数：--view <套接字名称> --match <比赛ID> 进入观看模式
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption viewOption(QStringLiteral("view"), QStringLiteral("观看ball_server中的比赛"), QStringLiteral("name"));
+    QCommandLineOption matchOption(QStringLiteral("match"), QStringLiteral("要观看的比赛ID"), QStringLiteral("id"), QStringLiteral("0"));
+    QCommandLineOption ballsOption(QStringLiteral("balls"), QStringLiteral("每局的球数"), QStringLiteral("count"), QStringLiteral("3"));
+    parser.addOptions({viewOption, matchOption, ballsOption});
+    parser.process(a);
+    
+    BallGame w;
+    if (parser.isSet(ballsOption)) {
+        w.setBallCount(parser.value(ballsOption).toInt());
+    }
+    w.show();
+    
+    if (parser.isSet(viewOption)) {
+        w.startViewer(parser.value(viewOption), parser.value(matchOption).toInt());
+    }
+    
+    return a.exec();
+}
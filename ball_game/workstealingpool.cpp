@@ -0,0 +1,151 @@
+#include "workstealingpool.h"
+
+WorkStealingPool::WorkStealingPool(int threadCount)
+    : m_body(nullptr)
+    , m_remaining(0)
+    , m_generation(0)
+    , m_stopping(false)
+{
+    if (threadCount < 1) {
+        threadCount = qMax(1, QThread::idealThreadCount());
+    }
+
+    for (int i = 0; i < threadCount; i++) {
+        m_workers.append(new Worker);
+    }
+
+    // 0号工作线程就是调用parallelFor的线程，只为其余的创建后台线程
+    for (int i = 1; i < threadCount; i++) {
+        m_workers[i]->thread = QThread::create([this, i]() { workerMain(i); });
+        m_workers[i]->thread->start();
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        QMutexLocker locker(&m_stateMutex);
+        m_stopping = true;
+        m_jobReady.wakeAll();
+    }
+
+    for (Worker *worker : qAsConst(m_workers)) {
+        if (worker->thread) {
+            worker->thread->wait();
+            delete worker->thread;
+        }
+    }
+    qDeleteAll(m_workers);
+}
+
+int WorkStealingPool::threadCount() const
+{
+    return m_workers.size();
+}
+
+void WorkStealingPool::parallelFor(int count, int grain, const RangeFunction &body)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    const int threads = m_workers.size();
+    if (grain < 1) {
+        // 每个线程约分到4块，给任务窃取留出余地
+        grain = qMax(1, count / (threads * 4));
+    }
+
+    // 只有一块或只有一个线程时直接在调用线程执行
+    if (threads == 1 || count <= grain) {
+        body(0, count);
+        return;
+    }
+
+    m_body = &body;
+    const int chunks = (count + grain - 1) / grain;
+    m_remaining.storeRelease(chunks);
+
+    // 按轮转方式分发到各线程的队列
+    for (int c = 0; c < chunks; c++) {
+        Worker *worker = m_workers[c % threads];
+        QMutexLocker locker(&worker->mutex);
+        worker->ranges.push_back({c * grain, qMin(count, (c + 1) * grain)});
+    }
+
+    {
+        QMutexLocker locker(&m_stateMutex);
+        m_generation++;
+        m_jobReady.wakeAll();
+    }
+
+    // 调用线程也参与执行
+    while (runOne(0)) {}
+
+    QMutexLocker locker(&m_stateMutex);
+    while (m_remaining.loadAcquire() > 0) {
+        m_jobDone.wait(&m_stateMutex);
+    }
+    m_body = nullptr;
+}
+
+void WorkStealingPool::workerMain(int index)
+{
+    quint64 seenGeneration = 0;
+
+    forever {
+        {
+            QMutexLocker locker(&m_stateMutex);
+            while (!m_stopping && m_generation == seenGeneration) {
+                m_jobReady.wait(&m_stateMutex);
+            }
+            if (m_stopping) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        while (runOne(index)) {}
+    }
+}
+
+bool WorkStealingPool::runOne(int index)
+{
+    Range range = {0, 0};
+    bool found = false;
+
+    // 先从自己队列的头部取
+    {
+        Worker *own = m_workers[index];
+        QMutexLocker locker(&own->mutex);
+        if (!own->ranges.empty()) {
+            range = own->ranges.front();
+            own->ranges.pop_front();
+            found = true;
+        }
+    }
+
+    // 再从其他线程队列的尾部窃取
+    const int threads = m_workers.size();
+    for (int k = 1; !found && k < threads; k++) {
+        Worker *victim = m_workers[(index + k) % threads];
+        QMutexLocker locker(&victim->mutex);
+        if (!victim->ranges.empty()) {
+            range = victim->ranges.back();
+            victim->ranges.pop_back();
+            found = true;
+        }
+    }
+
+    if (!found) {
+        return false;
+    }
+
+    (*m_body)(range.begin, range.end);
+
+    // 最后一块完成时唤醒等待的调用线程
+    if (m_remaining.fetchAndAddAcqRel(-1) == 1) {
+        QMutexLocker locker(&m_stateMutex);
+        m_jobDone.wakeAll();
+    }
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include <deque>
+#include <functional>
+
+/**
+ * @brief 固定大小、带任务窃取的线程池
+ *
+ * parallelFor把区间切分成若干块，按轮转方式放入每个工作线程自己的双端队列。
+ * 工作线程从自己队列的头部取任务，空闲时从其他线程队列的尾部窃取，
+ * 调用线程也作为0号工作线程参与执行，直到所有块完成才返回。
+ *
+ * parallelFor不可重入：任务体内不能再次调用同一个线程池。
+ */
+class WorkStealingPool
+{
+public:
+    // 任务体，处理区间[begin, end)
+    using RangeFunction = std::function<void(int begin, int end)>;
+
+    /**
+     * @brief 构造函数
+     * @param threadCount 工作线程总数（含调用线程），小于1时使用CPU核心数
+     */
+    explicit WorkStealingPool(int threadCount = 0);
+
+    /**
+     * @brief 析构函数，通知并等待所有工作线程退出
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    /**
+     * @brief 获取工作线程总数（含调用线程）
+     */
+    int threadCount() const;
+
+    /**
+     * @brief 并行处理区间[0, count)
+     * @param count 元素数量
+     * @param grain 每块的元素数量，小于1时自动按线程数切分
+     * @param body 任务体，会在多个线程上并发调用
+     */
+    void parallelFor(int count, int grain, const RangeFunction &body);
+
+private:
+    struct Range {
+        int begin;
+        int end;
+    };
+
+    struct Worker {
+        QMutex mutex;             // 保护ranges
+        std::deque<Range> ranges; // 本线程的任务队列
+        QThread *thread = nullptr;
+    };
+
+    // 工作线程主循环
+    void workerMain(int index);
+    // 执行一个任务块（先取自己的，再窃取别人的），没有任务时返回false
+    bool runOne(int index);
+
+private:
+    QVector<Worker*> m_workers;       // 0号为调用线程
+    const RangeFunction *m_body;      // 当前任务体
+    QAtomicInt m_remaining;           // 当前任务剩余块数
+
+    QMutex m_stateMutex;              // 保护以下状态
+    QWaitCondition m_jobReady;        // 有新任务
+    QWaitCondition m_jobDone;         // 当前任务完成
+    quint64 m_generation;             // 任务代数
+    bool m_stopping;                  // 线程池正在销毁
+};
+
+#endif // WORKSTEALINGPOOL_H
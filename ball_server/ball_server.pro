@@ -0,0 +1,32 @@
+# 无界面多场比赛服务配置文件
+QT       += core gui network
+QT       -= widgets
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+# 复用小球碰撞游戏的模拟代码
+INCLUDEPATH += $$PWD/../ball_game
+
+# 主程序入口文件
+SOURCES += $$PWD/main.cpp \
+    $$PWD/matchmanager.cpp \
+    $$PWD/matchserver.cpp \
+    $$PWD/../ball_game/ball.cpp \
+    $$PWD/../ball_game/ballworld.cpp \
+    $$PWD/../ball_game/ballstream.cpp \
+    $$PWD/../ball_game/workstealingpool.cpp
+
+# 头文件
+HEADERS += \
+    $$PWD/matchmanager.h \
+    $$PWD/matchserver.h \
+    $$PWD/../ball_game/ball.h \
+    $$PWD/../ball_game/ballworld.h \
+    $$PWD/../ball_game/ballstream.h \
+    $$PWD/../ball_game/workstealingpool.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
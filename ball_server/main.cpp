@@ -0,0 +1,64 @@
+#include "matchmanager.h"
+#include "matchserver.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QRandomGenerator>
+#include <QTimer>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("ball_server"));
+
+    // 命令行参数
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("无界面多场小球碰撞比赛服务"));
+    parser.addHelpOption();
+    QCommandLineOption matchesOption({QStringLiteral("m"), QStringLiteral("matches")},
+                                     QStringLiteral("初始比赛数量"), QStringLiteral("count"), QStringLiteral("1000"));
+    QCommandLineOption ballsOption({QStringLiteral("b"), QStringLiteral("balls")},
+                                   QStringLiteral("每场比赛的球数"), QStringLiteral("count"), QStringLiteral("3"));
+    QCommandLineOption threadsOption({QStringLiteral("t"), QStringLiteral("threads")},
+                                     QStringLiteral("线程池大小（0为CPU核心数）"), QStringLiteral("count"), QStringLiteral("0"));
+    QCommandLineOption intervalOption({QStringLiteral("i"), QStringLiteral("interval")},
+                                      QStringLiteral("推进周期（毫秒，0为尽可能快）"), QStringLiteral("ms"), QStringLiteral("16"));
+    QCommandLineOption nameOption({QStringLiteral("n"), QStringLiteral("name")},
+                                  QStringLiteral("本地套接字名称"), QStringLiteral("name"), QStringLiteral("ball_server"));
+    QCommandLineOption seedOption({QStringLiteral("s"), QStringLiteral("seed")},
+                                  QStringLiteral("第一场比赛的随机数种子（默认随机）"), QStringLiteral("seed"));
+    QCommandLineOption restartOption({QStringLiteral("r"), QStringLiteral("restart")},
+                                     QStringLiteral("比赛结束后自动重开"));
+    parser.addOptions({matchesOption, ballsOption, threadsOption, intervalOption, nameOption, seedOption, restartOption});
+    parser.process(a);
+
+    MatchManager manager(parser.value(threadsOption).toInt());
+    manager.setAutoRestart(parser.isSet(restartOption));
+
+    // 每场比赛使用不同的种子，指定种子时整个进程可复现
+    const int matchCount = parser.value(matchesOption).toInt();
+    const int ballCount = qMax(2, parser.value(ballsOption).toInt());
+    quint32 seed = parser.isSet(seedOption) ? parser.value(seedOption).toUInt()
+                                            : QRandomGenerator::global()->generate();
+    for (int i = 0; i < matchCount; i++) {
+        manager.createMatch(seed + quint32(i), ballCount);
+    }
+
+    MatchServer server(&manager);
+    if (!server.listen(parser.value(nameOption))) {
+        qCritical("无法监听本地套接字: %s", qPrintable(server.errorString()));
+        return 1;
+    }
+
+    // 每5秒输出一次汇总统计
+    QTimer report;
+    QObject::connect(&report, &QTimer::timeout, [&manager]() {
+        qInfo("比赛: %d  线程: %d  吞吐量: %.0f 步/秒  最近一次推进: %.3f ms  已结束: %llu",
+              manager.matchCount(), manager.threadCount(), manager.ticksPerSecond(),
+              manager.lastStepNs() / 1e6, manager.finishedMatches());
+    });
+    report.start(5000);
+
+    manager.start(parser.value(intervalOption).toInt());
+
+    return a.exec();
+}
@@ -0,0 +1,215 @@
+#include "matchmanager.h"
+
+namespace {
+// 无界面比赛使用固定的圆圈尺寸，与窗口版默认尺寸一致
+const QPointF kArenaCenter(0.0, 0.0);
+const qreal kArenaRadius = 200.0;
+const qreal kTickSeconds = 0.016;
+
+// 由上一局种子推导下一局种子（线性同余）
+quint32 nextSeed(quint32 seed)
+{
+    return seed * 1664525u + 1013904223u;
+}
+}
+
+MatchManager::MatchManager(int threadCount, QObject *parent)
+    : QObject(parent)
+    , m_pool(threadCount)
+    , m_nextId(0)
+    , m_autoRestart(false)
+    , m_totalTicks(0)
+    , m_finishedMatches(0)
+    , m_lastStepNs(0)
+    , m_rateTicks(0)
+    , m_ticksPerSecond(0.0)
+{
+    connect(&m_timer, &QTimer::timeout, this, &MatchManager::stepAll);
+    m_rateTimer.start();
+}
+
+MatchManager::~MatchManager()
+{
+    qDeleteAll(m_matches);
+}
+
+int MatchManager::createMatch(quint32 seed, int ballCount)
+{
+    Match *match = new Match(seed);
+    match->id = m_nextId++;
+    match->ballCount = ballCount;
+    restartMatch(match, seed);
+
+    m_matches.append(match);
+    m_matchById.insert(match->id, match);
+    return match->id;
+}
+
+bool MatchManager::removeMatch(int id)
+{
+    Match *match = m_matchById.take(id);
+    if (!match) {
+        return false;
+    }
+    m_matches.removeOne(match);
+    delete match;
+    return true;
+}
+
+void MatchManager::setEventRecording(int id, bool enabled)
+{
+    if (Match *match = m_matchById.value(id)) {
+        match->world.setEventRecording(enabled);
+    }
+}
+
+void MatchManager::setAutoRestart(bool enabled)
+{
+    m_autoRestart = enabled;
+}
+
+void MatchManager::start(int intervalMs)
+{
+    m_timer.start(qMax(0, intervalMs));
+}
+
+void MatchManager::stop()
+{
+    m_timer.stop();
+}
+
+void MatchManager::stepAll()
+{
+    QElapsedTimer wallClock;
+    wallClock.start();
+
+    // 每个比赛在本周期内只由一个线程访问
+    m_pool.parallelFor(m_matches.size(), 0, [this](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            stepMatch(m_matches[i]);
+        }
+    });
+
+    // 汇总统计与自动重开由主线程串行完成
+    quint64 steppedMatches = 0;
+    for (Match *match : qAsConst(m_matches)) {
+        if (match->world.outcome() == BallWorld::Running || match->justFinished) {
+            steppedMatches++;
+        }
+        if (match->justFinished) {
+            match->justFinished = false;
+            m_finishedMatches++;
+            if (m_autoRestart) {
+                match->generation++;
+                restartMatch(match, nextSeed(match->seed));
+            }
+        }
+    }
+
+    m_totalTicks += steppedMatches;
+    m_rateTicks += steppedMatches;
+    m_lastStepNs = wallClock.nsecsElapsed();
+
+    // 每秒更新一次吞吐量
+    const qint64 windowNs = m_rateTimer.nsecsElapsed();
+    if (windowNs >= 1000000000LL) {
+        m_ticksPerSecond = m_rateTicks * 1e9 / windowNs;
+        m_rateTicks = 0;
+        m_rateTimer.restart();
+    }
+
+    emit stepped();
+}
+
+int MatchManager::matchCount() const
+{
+    return m_matches.size();
+}
+
+QVector<int> MatchManager::matchIds() const
+{
+    QVector<int> ids;
+    ids.reserve(m_matches.size());
+    for (const Match *match : m_matches) {
+        ids.append(match->id);
+    }
+    return ids;
+}
+
+bool MatchManager::matchInfo(int id, MatchInfo *info) const
+{
+    const Match *match = m_matchById.value(id);
+    if (!match || !info) {
+        return false;
+    }
+
+    info->id = match->id;
+    info->seed = match->seed;
+    info->ballCount = match->ballCount;
+    info->generation = match->generation;
+    info->ticks = match->world.tickCount();
+    info->outcome = match->world.outcome();
+    info->winnerId = match->world.winnerId();
+    info->lastTickNs = match->lastTickNs;
+    info->maxTickNs = match->maxTickNs;
+    info->averageTickNs = info->ticks > 0 ? double(match->totalTickNs) / info->ticks : 0.0;
+    return true;
+}
+
+const BallWorld *MatchManager::world(int id) const
+{
+    const Match *match = m_matchById.value(id);
+    return match ? &match->world : nullptr;
+}
+
+int MatchManager::threadCount() const
+{
+    return m_pool.threadCount();
+}
+
+quint64 MatchManager::totalTicks() const
+{
+    return m_totalTicks;
+}
+
+quint64 MatchManager::finishedMatches() const
+{
+    return m_finishedMatches;
+}
+
+double MatchManager::ticksPerSecond() const
+{
+    return m_ticksPerSecond;
+}
+
+qint64 MatchManager::lastStepNs() const
+{
+    return m_lastStepNs;
+}
+
+void MatchManager::stepMatch(Match *match)
+{
+    if (match->world.outcome() != BallWorld::Running) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const bool running = match->world.step(kTickSeconds);
+    const qint64 elapsed = timer.nsecsElapsed();
+
+    match->lastTickNs = elapsed;
+    match->maxTickNs = qMax(match->maxTickNs, elapsed);
+    match->totalTickNs += elapsed;
+    match->justFinished = !running;
+}
+
+void MatchManager::restartMatch(Match *match, quint32 seed)
+{
+    match->seed = seed;
+    match->world.reseed(seed);
+    match->world.reset(kArenaCenter, kArenaRadius, match->ballCount);
+    match->lastTickNs = 0;
+    match->maxTickNs = 0;
+    match->totalTickNs = 0;
+}
@@ -0,0 +1,155 @@
+#ifndef MATCHMANAGER_H
+#define MATCHMANAGER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+#include <QVector>
+#include "ballworld.h"
+#include "workstealingpool.h"
+
+/**
+ * @brief 多场比赛管理器
+ *
+ * 在一个无界面进程中持有大量相互独立的BallWorld，每个计时周期在固定大小的
+ * 任务窃取线程池上把所有未结束的比赛各推进一步。比赛之间不共享任何可变状态：
+ * 一个比赛在一个周期内只会被一个线程访问，统计数据也记录在比赛自身上，
+ * 汇总统计只在周期结束后由主线程计算。
+ */
+class MatchManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 单场比赛的查询结果
+    struct MatchInfo {
+        int id = -1;                 // 比赛ID
+        quint32 seed = 0;            // 当前这一局的随机数种子
+        int ballCount = 0;           // 球的数量
+        int generation = 0;          // 自动重开的次数
+        quint64 ticks = 0;           // 当前这一局已推进的步数
+        BallWorld::Outcome outcome = BallWorld::Running;
+        int winnerId = -1;           // 获胜球ID
+        qint64 lastTickNs = 0;       // 最近一步的耗时（纳秒）
+        qint64 maxTickNs = 0;        // 单步最大耗时（纳秒）
+        double averageTickNs = 0.0;  // 平均单步耗时（纳秒）
+    };
+
+    /**
+     * @brief 构造函数
+     * @param threadCount 线程池大小，小于1时使用CPU核心数
+     * @param parent 父对象
+     */
+    explicit MatchManager(int threadCount = 0, QObject *parent = nullptr);
+    ~MatchManager();
+
+    /**
+     * @brief 创建一场比赛
+     * @param seed 随机数种子
+     * @param ballCount 球的数量
+     * @return 新比赛的ID
+     */
+    int createMatch(quint32 seed, int ballCount = 3);
+
+    /**
+     * @brief 删除一场比赛
+     * @param id 比赛ID
+     * @return 比赛存在并被删除时返回true
+     */
+    bool removeMatch(int id);
+
+    /**
+     * @brief 设置是否记录比赛的连接线事件（状态流需要）
+     * @param id 比赛ID
+     * @param enabled 是否记录
+     */
+    void setEventRecording(int id, bool enabled);
+
+    /**
+     * @brief 设置比赛结束后是否用新种子自动重开
+     */
+    void setAutoRestart(bool enabled);
+
+    /**
+     * @brief 开始按固定周期推进所有比赛
+     * @param intervalMs 周期（毫秒），0表示尽可能快
+     */
+    void start(int intervalMs);
+
+    /**
+     * @brief 停止推进
+     */
+    void stop();
+
+    /**
+     * @brief 把所有未结束的比赛各推进一步
+     */
+    void stepAll();
+
+    int matchCount() const;
+    QVector<int> matchIds() const;
+
+    /**
+     * @brief 查询一场比赛
+     * @param id 比赛ID
+     * @param info 输出的比赛信息
+     * @return 比赛存在时返回true
+     */
+    bool matchInfo(int id, MatchInfo *info) const;
+
+    /**
+     * @brief 获取比赛的模拟世界，只能在两次stepAll之间由主线程读取
+     * @param id 比赛ID
+     * @return 模拟世界，比赛不存在时返回nullptr
+     */
+    const BallWorld *world(int id) const;
+
+    int threadCount() const;
+    quint64 totalTicks() const;         // 所有比赛累计推进的步数
+    quint64 finishedMatches() const;    // 累计结束的比赛局数
+    double ticksPerSecond() const;      // 最近一秒的总吞吐量（比赛步/秒）
+    qint64 lastStepNs() const;          // 最近一次stepAll的墙钟耗时（纳秒）
+
+signals:
+    /**
+     * @brief 每次stepAll完成后发出，可用于推送观察数据
+     */
+    void stepped();
+
+private:
+    struct Match {
+        explicit Match(quint32 matchSeed) : world(matchSeed) {}
+        int id = -1;
+        quint32 seed = 0;
+        int ballCount = 0;
+        int generation = 0;
+        BallWorld world;
+        bool justFinished = false;
+        qint64 lastTickNs = 0;
+        qint64 maxTickNs = 0;
+        qint64 totalTickNs = 0;
+    };
+
+    // 在工作线程中推进一场比赛并记录耗时
+    static void stepMatch(Match *match);
+    // 用给定种子重新开始一场比赛
+    static void restartMatch(Match *match, quint32 seed);
+
+private:
+    WorkStealingPool m_pool;          // 任务窃取线程池
+    QVector<Match*> m_matches;        // 所有比赛（按创建顺序）
+    QHash<int, Match*> m_matchById;   // ID索引
+    int m_nextId;                     // 下一个比赛ID
+    bool m_autoRestart;               // 比赛结束后是否自动重开
+    QTimer m_timer;                   // 推进计时器
+
+    quint64 m_totalTicks;             // 累计步数
+    quint64 m_finishedMatches;        // 累计结束局数
+    qint64 m_lastStepNs;              // 最近一次stepAll耗时
+    QElapsedTimer m_rateTimer;        // 吞吐量统计窗口计时
+    quint64 m_rateTicks;              // 当前窗口内的步数
+    double m_ticksPerSecond;          // 最近一个窗口的吞吐量
+};
+
+#endif // MATCHMANAGER_H
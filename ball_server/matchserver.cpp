@@ -0,0 +1,223 @@
+#include "matchserver.h"
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+
+namespace {
+QString outcomeName(BallWorld::Outcome outcome)
+{
+    switch (outcome) {
+    case BallWorld::LineLimitReached:
+        return QStringLiteral("lineLimit");
+    case BallWorld::LastSurvivor:
+        return QStringLiteral("lastSurvivor");
+    case BallWorld::Running:
+        break;
+    }
+    return QStringLiteral("running");
+}
+
+QJsonObject errorJson(const QString &message)
+{
+    return QJsonObject{{QStringLiteral("error"), message}};
+}
+}
+
+MatchServer::MatchServer(MatchManager *manager, QObject *parent)
+    : QObject(parent)
+    , m_manager(manager)
+{
+    connect(&m_server, &QLocalServer::newConnection, this, &MatchServer::onNewConnection);
+    connect(m_manager, &MatchManager::stepped, this, &MatchServer::onStepped);
+}
+
+MatchServer::~MatchServer()
+{
+    qDeleteAll(m_streams);
+}
+
+bool MatchServer::listen(const QString &name)
+{
+    // 清理上次异常退出残留的套接字文件
+    QLocalServer::removeServer(name);
+    return m_server.listen(name);
+}
+
+QString MatchServer::errorString() const
+{
+    return m_server.errorString();
+}
+
+void MatchServer::onNewConnection()
+{
+    while (QLocalSocket *socket = m_server.nextPendingConnection()) {
+        connect(socket, &QLocalSocket::readyRead, this, &MatchServer::onReadyRead);
+        connect(socket, &QLocalSocket::disconnected, this, &MatchServer::onDisconnected);
+    }
+}
+
+void MatchServer::onReadyRead()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket) {
+        return;
+    }
+
+    // 切换为状态流后不再接受文本命令
+    while (!m_streams.contains(socket) && socket->canReadLine()) {
+        const QString line = QString::fromUtf8(socket->readLine()).trimmed();
+        if (!line.isEmpty()) {
+            handleRequest(socket, line);
+        }
+    }
+}
+
+void MatchServer::onDisconnected()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket) {
+        return;
+    }
+    m_observers.remove(socket);
+    delete m_streams.take(socket);
+    socket->deleteLater();
+}
+
+void MatchServer::onStepped()
+{
+    // 写入失败可能同步触发断开，遍历副本
+    const QHash<QLocalSocket*, int> observers = m_observers;
+    for (auto it = observers.constBegin(); it != observers.constEnd(); ++it) {
+        sendJson(it.key(), matchDetailJson(it.value()));
+    }
+
+    const QHash<QLocalSocket*, Stream*> streams = m_streams;
+    for (auto it = streams.constBegin(); it != streams.constEnd(); ++it) {
+        const BallWorld *world = m_manager->world(it.value()->matchId);
+        if (world) {
+            const QByteArray frame = it.value()->encoder.encode(*world);
+            if (!frame.isEmpty()) {
+                it.key()->write(frame);
+            }
+        }
+    }
+}
+
+void MatchServer::handleRequest(QLocalSocket *socket, const QString &line)
+{
+    const QStringList parts = line.split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    const QString command = parts.first().toLower();
+
+    if (command == QLatin1String("stats")) {
+        sendJson(socket, statsJson());
+    } else if (command == QLatin1String("list")) {
+        QJsonArray matches;
+        for (int id : m_manager->matchIds()) {
+            matches.append(matchSummaryJson(id));
+        }
+        QJsonObject reply = statsJson();
+        reply.insert(QStringLiteral("matches"), matches);
+        sendJson(socket, reply);
+    } else if (command == QLatin1String("match") && parts.size() >= 2) {
+        const int id = parts[1].toInt();
+        sendJson(socket, m_manager->world(id) ? matchDetailJson(id) : errorJson(QStringLiteral("no such match")));
+    } else if (command == QLatin1String("create") && parts.size() >= 2) {
+        const int count = qBound(0, parts[1].toInt(), 100000);
+        const int balls = parts.size() >= 3 ? qBound(2, parts[2].toInt(), 10000) : 3;
+        QJsonArray ids;
+        for (int i = 0; i < count; i++) {
+            ids.append(m_manager->createMatch(QRandomGenerator::global()->generate(), balls));
+        }
+        sendJson(socket, QJsonObject{{QStringLiteral("created"), ids}});
+    } else if (command == QLatin1String("remove") && parts.size() >= 2) {
+        const bool removed = m_manager->removeMatch(parts[1].toInt());
+        sendJson(socket, QJsonObject{{QStringLiteral("removed"), removed}});
+    } else if (command == QLatin1String("observe") && parts.size() >= 2) {
+        const int id = parts[1].toInt();
+        if (m_manager->world(id)) {
+            m_observers.insert(socket, id);
+            sendJson(socket, matchDetailJson(id));
+        } else {
+            sendJson(socket, errorJson(QStringLiteral("no such match")));
+        }
+    } else if (command == QLatin1String("stream") && parts.size() >= 2) {
+        const int id = parts[1].toInt();
+        const BallWorld *world = m_manager->world(id);
+        if (world) {
+            // 首帧为关键帧，之后每步推送增量
+            m_manager->setEventRecording(id, true);
+            m_observers.remove(socket);
+            Stream *stream = new Stream{id, BallStreamEncoder()};
+            m_streams.insert(socket, stream);
+            socket->write(stream->encoder.encode(*world));
+        } else {
+            sendJson(socket, errorJson(QStringLiteral("no such match")));
+        }
+    } else {
+        sendJson(socket, errorJson(QStringLiteral("unknown command: %1").arg(line)));
+    }
+}
+
+void MatchServer::sendJson(QLocalSocket *socket, const QJsonObject &object)
+{
+    socket->write(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    socket->write("\n");
+}
+
+QJsonObject MatchServer::statsJson() const
+{
+    QJsonObject stats;
+    stats.insert(QStringLiteral("matchCount"), m_manager->matchCount());
+    stats.insert(QStringLiteral("threads"), m_manager->threadCount());
+    stats.insert(QStringLiteral("totalTicks"), double(m_manager->totalTicks()));
+    stats.insert(QStringLiteral("finishedMatches"), double(m_manager->finishedMatches()));
+    stats.insert(QStringLiteral("ticksPerSecond"), m_manager->ticksPerSecond());
+    stats.insert(QStringLiteral("lastStepUs"), m_manager->lastStepNs() / 1000.0);
+    return stats;
+}
+
+QJsonObject MatchServer::matchSummaryJson(int id) const
+{
+    MatchManager::MatchInfo info;
+    if (!m_manager->matchInfo(id, &info)) {
+        return errorJson(QStringLiteral("no such match"));
+    }
+
+    QJsonObject match;
+    match.insert(QStringLiteral("id"), info.id);
+    match.insert(QStringLiteral("seed"), double(info.seed));
+    match.insert(QStringLiteral("balls"), info.ballCount);
+    match.insert(QStringLiteral("generation"), info.generation);
+    match.insert(QStringLiteral("ticks"), double(info.ticks));
+    match.insert(QStringLiteral("state"), outcomeName(info.outcome));
+    match.insert(QStringLiteral("winner"), info.winnerId);
+    match.insert(QStringLiteral("lastTickUs"), info.lastTickNs / 1000.0);
+    match.insert(QStringLiteral("avgTickUs"), info.averageTickNs / 1000.0);
+    match.insert(QStringLiteral("maxTickUs"), info.maxTickNs / 1000.0);
+    return match;
+}
+
+QJsonObject MatchServer::matchDetailJson(int id) const
+{
+    QJsonObject match = matchSummaryJson(id);
+    const BallWorld *world = m_manager->world(id);
+    if (!world) {
+        return match;
+    }
+
+    QJsonArray balls;
+    for (const Ball *ball : world->balls()) {
+        QJsonObject state;
+        state.insert(QStringLiteral("id"), ball->id());
+        state.insert(QStringLiteral("x"), ball->position().x());
+        state.insert(QStringLiteral("y"), ball->position().y());
+        state.insert(QStringLiteral("vx"), ball->velocity().x());
+        state.insert(QStringLiteral("vy"), ball->velocity().y());
+        state.insert(QStringLiteral("connections"), ball->connectionCount());
+        state.insert(QStringLiteral("eliminated"), ball->isEliminated());
+        balls.append(state);
+    }
+    match.insert(QStringLiteral("ballStates"), balls);
+    match.insert(QStringLiteral("circleRadius"), world->circleRadius());
+    return match;
+}
@@ -0,0 +1,81 @@
+#ifndef MATCHSERVER_H
+#define MATCHSERVER_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include "ballstream.h"
+#include "matchmanager.h"
+
+/**
+ * @brief 比赛查询服务
+ *
+ * 通过QLocalServer提供按行的文本协议，每条请求返回一行紧凑的JSON：
+ *   stats            汇总统计（比赛数、线程数、累计步数、吞吐量）
+ *   list             所有比赛的摘要与单步耗时
+ *   match <id>       单场比赛的详细状态（含每个球的位置、速度和连接线数）
+ *   create <n> [b]   创建n场比赛，每场b个球（默认3）
+ *   remove <id>      删除一场比赛
+ *   observe <id>     每次推进后推送该比赛的详细状态，直到断开连接
+ *   stream <id>      切换为二进制增量状态流（见BallStreamEncoder），直到断开连接
+ */
+class MatchServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param manager 比赛管理器，由调用者持有
+     * @param parent 父对象
+     */
+    explicit MatchServer(MatchManager *manager, QObject *parent = nullptr);
+    ~MatchServer();
+
+    /**
+     * @brief 开始监听本地套接字
+     * @param name 套接字名称
+     * @return 监听成功时返回true
+     */
+    bool listen(const QString &name);
+
+    /**
+     * @brief 获取最近一次错误描述
+     */
+    QString errorString() const;
+
+private slots:
+    // 新客户端连接
+    void onNewConnection();
+    // 客户端发来数据
+    void onReadyRead();
+    // 客户端断开
+    void onDisconnected();
+    // 比赛推进一步后推送观察数据
+    void onStepped();
+
+private:
+    // 处理一行请求
+    void handleRequest(QLocalSocket *socket, const QString &line);
+    // 发送一行JSON
+    void sendJson(QLocalSocket *socket, const QJsonObject &object);
+
+    QJsonObject statsJson() const;
+    QJsonObject matchSummaryJson(int id) const;
+    QJsonObject matchDetailJson(int id) const;
+
+private:
+    MatchManager *m_manager;              // 比赛管理器
+    QLocalServer m_server;                // 本地套接字服务
+    struct Stream {
+        int matchId;
+        BallStreamEncoder encoder;
+    };
+
+    QHash<QLocalSocket*, int> m_observers; // 观察者及其观察的比赛ID
+    QHash<QLocalSocket*, Stream*> m_streams; // 状态流订阅者
+};
+
+#endif // MATCHSERVER_H
@@ -0,0 +1,224 @@
+#include "snakearena.h"
+#include "snakebatch.h"
+#include "snakeboard.h"
+#include "snakeobserver.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+
+namespace {
+
+// 一次基准测试的结果
+struct BenchResult {
+    double stepsPerSecond = 0.0;  // 随机游走的移动次数/秒
+    double fillsPerSecond = 0.0;  // 连通区域搜索次数/秒
+    quint64 checksum = 0;         // 用于确认两种实现结果一致
+};
+
+/**
+ * @brief 在位棋盘上运行随机游走的蛇
+ * @param board 位棋盘（编译期或运行时版本）
+ * @param steps 只做碰撞检测的移动次数
+ * @param fills 每次移动后都从蛇头做连通区域搜索的移动次数
+ * @param seed 随机数种子，两种实现使用相同的种子
+ *
+ * 蛇最长为区域的四分之一，撞墙或撞到自己时从区域中央重新开始。
+ */
+template <typename Board>
+BenchResult runBench(Board &board, int steps, int fills, quint32 seed)
+{
+    const int cells = board.cellCount();
+    const int maxLength = qMax(1, cells / 4);
+    QVector<int> body(cells);
+    int head = 0;
+    int length = 0;
+    QRandomGenerator random(seed);
+    BenchResult result;
+
+    auto restart = [&]() {
+        board.clear();
+        head = 0;
+        length = 1;
+        body[0] = (board.height() / 2) * board.width() + board.width() / 2;
+        board.set(body[0]);
+    };
+    // 向随机方向移动一步，返回是否重新开始
+    auto move = [&]() {
+        const int dir = int(random.generate() & 3);
+        const int cell = body[head];
+        const int x = cell % board.width() + directionDx(dir);
+        const int y = cell / board.width() + directionDy(dir);
+        if (length == maxLength) {
+            board.reset(body[(head + length - 1) % cells]);
+            --length;
+        }
+        if (board.collides(x, y)) {
+            restart();
+            return;
+        }
+        head = (head + cells - 1) % cells;
+        body[head] = y * board.width() + x;
+        board.set(body[head]);
+        ++length;
+        result.checksum = result.checksum * 31 + quint64(body[head]);
+    };
+
+    restart();
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < steps; ++i) {
+        move();
+    }
+    result.stepsPerSecond = steps / qMax(1e-9, timer.nsecsElapsed() / 1e9);
+
+    timer.restart();
+    for (int i = 0; i < fills; ++i) {
+        move();
+        result.checksum += quint64(board.floodFill(body[head]));
+    }
+    result.fillsPerSecond = fills / qMax(1e-9, timer.nsecsElapsed() / 1e9);
+    return result;
+}
+
+/**
+ * @brief 比较同一尺寸下编译期版本和运行时版本
+ */
+template <int W, int H>
+void compare(int steps, int fills, quint32 seed)
+{
+    SnakeBoard<W, H> fixedBoard;
+    RuntimeSnakeBoard runtimeBoard(W, H);
+    const BenchResult fixedResult = runBench(fixedBoard, steps, fills, seed);
+    const BenchResult runtimeResult = runBench(runtimeBoard, steps, fills, seed);
+
+    qInfo("%3dx%-3d  移动: 编译期 %7.1f M次/秒  运行时 %7.1f M次/秒 (%.2fx)   "
+          "连通搜索: 编译期 %9.0f 次/秒  运行时 %9.0f 次/秒 (%.2fx)   结果%s",
+          W, H,
+          fixedResult.stepsPerSecond / 1e6, runtimeResult.stepsPerSecond / 1e6,
+          fixedResult.stepsPerSecond / runtimeResult.stepsPerSecond,
+          fixedResult.fillsPerSecond, runtimeResult.fillsPerSecond,
+          fixedResult.fillsPerSecond / runtimeResult.fillsPerSecond,
+          fixedResult.checksum == runtimeResult.checksum ? "一致" : "不一致");
+}
+
+/**
+ * @brief 多蛇竞技场的每步耗时随蛇的数量的变化
+ * @param ticks 每种蛇数推进的步数
+ * @param threads 决策阶段的线程数（含调用线程）
+ * @param seed 随机数种子
+ *
+ * 区域大小按蛇的数量选择（每条蛇约256格），蛇的密度保持不变。
+ */
+void arenaScaling(int ticks, int threads, quint32 seed)
+{
+    WorkStealingPool pool(threads);
+    qInfo("多蛇竞技场：%d线程，每种蛇数推进%d步", pool.threadCount(), ticks);
+    for (int snakes = 50; snakes <= 3200; snakes *= 2) {
+        const QSize field = SnakeArena::defaultFieldSize(snakes);
+        SnakeArena arena(snakes, field.width(), field.height(), seed);
+        arena.setThreadPool(&pool);
+        qint64 thinkNs = 0;
+        qint64 resolveNs = 0;
+        qint64 maxStepNs = 0;
+        qint64 alive = 0;
+        for (int i = 0; i < ticks; ++i) {
+            arena.step();
+            thinkNs += arena.lastThinkNs();
+            resolveNs += arena.lastResolveNs();
+            maxStepNs = qMax(maxStepNs, arena.lastThinkNs() + arena.lastResolveNs());
+            alive += arena.aliveCount();
+        }
+        const double perTick = qMax(1, ticks) * 1000.0;
+        qInfo("%5d条蛇 %4dx%-4d  每步 %8.1f µs（决策 %8.1f µs  结算 %7.1f µs  最慢 %8.1f µs）  平均存活 %5.1f%%",
+              snakes, field.width(), field.height(),
+              (thinkNs + resolveNs) / perTick, thinkNs / perTick, resolveNs / perTick, maxStepNs / 1000.0,
+              100.0 * alive / qMax(1, ticks) / snakes);
+    }
+}
+
+/**
+ * @brief 批量观测编码的吞吐量
+ * @param boards 棋盘数量
+ * @param threads 线程数（含调用线程）
+ * @param seed 随机数种子
+ *
+ * 每种区域大小先用随机动作推进200步，让蛇身分布接近对局中的样子，再重复编码所有棋盘。
+ * 128x128的宽度超过64，走SnakeBits::floodFill，可与按行搜索的区域对比。
+ */
+void observeThroughput(int boards, int threads, quint32 seed)
+{
+    WorkStealingPool pool(threads);
+    qInfo("批量观测编码：%d个棋盘，%d线程", boards, pool.threadCount());
+    const QSize sizes[] = {QSize(30, 20), QSize(64, 64), QSize(128, 128)};
+    for (const QSize &size : sizes) {
+        SnakeBatch batch(boards, size.width(), size.height(), seed);
+        SnakeObserver observer(boards, size.width(), size.height());
+        batch.setThreadPool(&pool);
+        observer.setThreadPool(&pool);
+        QRandomGenerator random(seed);
+        QVector<quint8> actions(boards);
+        for (int i = 0; i < 200; ++i) {
+            for (quint8 &action : actions) {
+                action = quint8(random.bounded(4));
+            }
+            batch.step(actions.constData());
+        }
+
+        const int repeats = 20;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < repeats; ++i) {
+            observer.encode(batch);
+        }
+        const qint64 ns = qMax(qint64(1), timer.nsecsElapsed());
+        qInfo("%4dx%-4d  %10.0f 棋盘/秒  每个棋盘 %7.2f µs  （特征%d个，窗口%dx%d）",
+              size.width(), size.height(), double(boards) * repeats * 1e9 / ns,
+              ns / 1000.0 / (double(boards) * repeats),
+              int(SnakeObserver::FeatureCount), observer.cropSize(), observer.cropSize());
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("snake_bench"));
+
+    // 命令行参数
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("贪吃蛇基准测试：位棋盘的编译期尺寸与运行时尺寸，或多蛇竞技场的每步耗时"));
+    parser.addHelpOption();
+    QCommandLineOption stepsOption({QStringLiteral("s"), QStringLiteral("steps")},
+                                   QStringLiteral("只做碰撞检测的移动次数"), QStringLiteral("count"), QStringLiteral("20000000"));
+    QCommandLineOption fillsOption({QStringLiteral("f"), QStringLiteral("fills")},
+                                   QStringLiteral("连通区域搜索次数"), QStringLiteral("count"), QStringLiteral("20000"));
+    QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("随机数种子"), QStringLiteral("seed"), QStringLiteral("1"));
+    QCommandLineOption arenaOption(QStringLiteral("arena"), QStringLiteral("改为测试多蛇竞技场每步耗时随蛇数的变化"));
+    QCommandLineOption ticksOption(QStringLiteral("ticks"), QStringLiteral("竞技场每种蛇数推进的步数"), QStringLiteral("count"), QStringLiteral("500"));
+    QCommandLineOption threadsOption({QStringLiteral("t"), QStringLiteral("threads")},
+                                     QStringLiteral("竞技场决策和观测编码的线程数（0为CPU核心数）"), QStringLiteral("count"), QStringLiteral("0"));
+    QCommandLineOption observeOption(QStringLiteral("observe"), QStringLiteral("改为测试批量观测编码的吞吐量，参数为棋盘数量"),
+                                     QStringLiteral("boards"));
+    parser.addOptions({stepsOption, fillsOption, seedOption, arenaOption, ticksOption, threadsOption, observeOption});
+    parser.process(a);
+
+    const int steps = parser.value(stepsOption).toInt();
+    const int fills = parser.value(fillsOption).toInt();
+    const quint32 seed = parser.value(seedOption).toUInt();
+
+    if (parser.isSet(arenaOption)) {
+        arenaScaling(parser.value(ticksOption).toInt(), parser.value(threadsOption).toInt(), seed);
+        return 0;
+    }
+    if (parser.isSet(observeOption)) {
+        observeThroughput(qMax(1, parser.value(observeOption).toInt()), parser.value(threadsOption).toInt(), seed);
+        return 0;
+    }
+
+    compare<30, 20>(steps, fills, seed);
+    compare<64, 64>(steps, fills, seed);
+    compare<128, 128>(steps, fills, seed);
+    return 0;
+}
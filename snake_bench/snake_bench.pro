@@ -0,0 +1,23 @@
+# 贪吃蛇位棋盘基准测试配置文件
+QT       += core
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+# 编译期尺寸的循环需要展开才能体现差别
+gcc|clang {
+    QMAKE_CXXFLAGS_RELEASE -= -O2
+    QMAKE_CXXFLAGS_RELEASE += -O3
+}
+
+# 位棋盘和多蛇竞技场（贪吃蛇的无界面核心逻辑）
+include($$PWD/../snake_game/snakecore.pri)
+
+# 主程序入口文件
+SOURCES += $$PWD/main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,183 @@
+/**
+ * @file arenaboard.cpp
+ * @brief 多蛇竞技场界面实现文件
+ */
+#include "arenaboard.h"
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QApplication>
+
+namespace {
+// 每步的时间间隔（毫秒）
+const int kArenaInterval = 50;
+// 食物的颜色
+const QRgb kFoodColor = qRgb(220, 30, 30);
+// 空格子的颜色
+const QRgb kEmptyColor = qRgb(255, 255, 255);
+}
+
+/**
+ * @brief ArenaBoard类构造函数
+ * @param snakeCount 蛇的数量
+ * @param fieldSize 区域大小，为空时按蛇的数量选择
+ * @param parent 父窗口部件指针
+ *
+ * 线程池使用全部CPU核心，每条蛇按序号分配一种颜色（色相按黄金角错开，相邻序号颜色差别大）。
+ */
+ArenaBoard::ArenaBoard(int snakeCount, const QSize &fieldSize, QWidget *parent)
+    : QWidget(parent)
+    , m_pool(0)
+    , m_arena(snakeCount,
+              fieldSize.isEmpty() ? SnakeArena::defaultFieldSize(snakeCount).width() : fieldSize.width(),
+              fieldSize.isEmpty() ? SnakeArena::defaultFieldSize(snakeCount).height() : fieldSize.height(),
+              QRandomGenerator::global()->generate())
+    , m_averageStepNs(0)
+{
+    setFocusPolicy(Qt::StrongFocus);
+    setBackgroundRole(QPalette::Base);
+    setAutoFillBackground(true);
+
+    m_arena.setThreadPool(&m_pool);
+    m_image = QImage(m_arena.width(), m_arena.height(), QImage::Format_RGB32);
+    for (int s = 0; s < m_arena.snakeCount(); ++s) {
+        const int hue = (s * 137) % 360;
+        m_bodyColors.append(QColor::fromHsv(hue, 160, 230).rgb());
+        m_headColors.append(QColor::fromHsv(hue, 255, 120).rgb());
+    }
+    renderImage();
+
+    // 字体只建立一次，统计文字用<br>换行，每一步重新排版一次
+    m_statsFont.setFamily(QStringLiteral("SimHei"));
+    m_statsFont.setPointSize(10);
+    m_messageFont.setFamily(QStringLiteral("SimHei"));
+    m_messageFont.setPointSize(16);
+    m_statsText.setTextFormat(Qt::RichText);
+    m_statsText.setPerformanceHint(QStaticText::AggressiveCaching);
+    updateStatsText();
+
+    connect(&m_timer, &QTimer::timeout, this, &ArenaBoard::arenaLoop);
+    m_timer.start(kArenaInterval);
+}
+
+/**
+ * @brief 重写绘制事件处理函数
+ * @param event 绘制事件对象指针
+ *
+ * 把区域图像按比例缩放到窗口中央（不做平滑，保持格子的边界清晰），再绘制排版好的统计信息。
+ * 图像缩放和文字都不需要抗锯齿。
+ */
+void ArenaBoard::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+
+    const qreal scale = qMin(qreal(width()) / m_image.width(), qreal(height()) / m_image.height());
+    const QSizeF size(m_image.width() * scale, m_image.height() * scale);
+    const QRectF target(QPointF((width() - size.width()) / 2, (height() - size.height()) / 2), size);
+    painter.drawImage(target, m_image);
+
+    painter.setFont(m_statsFont);
+    const QPointF textPos(10, 10);
+    painter.fillRect(QRectF(textPos, m_statsText.size()).adjusted(-4, -2, 4, 2), QColor(255, 255, 255, 200));
+    painter.setPen(Qt::black);
+    painter.drawStaticText(textPos, m_statsText);
+
+    if (!m_timer.isActive()) {
+        painter.setFont(m_messageFont);
+        painter.drawText(rect(), Qt::AlignCenter, QStringLiteral("暂停\n按空格键继续"));
+    }
+}
+
+/**
+ * @brief 重写键盘事件处理函数
+ * @param event 键盘事件对象指针
+ */
+void ArenaBoard::keyPressEvent(QKeyEvent *event)
+{
+    switch (event->key()) {
+    case Qt::Key_Space:
+        if (m_timer.isActive()) {
+            m_timer.stop();
+        } else {
+            m_timer.start(kArenaInterval);
+        }
+        update();
+        break;
+    case Qt::Key_R:
+        m_arena.reset(QRandomGenerator::global()->generate());
+        m_averageStepNs = 0;
+        renderImage();
+        updateStatsText();
+        update();
+        break;
+    case Qt::Key_Escape:
+        qApp->quit();
+        break;
+    default:
+        QWidget::keyPressEvent(event);
+    }
+}
+
+/**
+ * @brief 推进一步并重绘
+ *
+ * 每步耗时取决策与结算之和，按1/16的权重做滑动平均，避免数字跳动。
+ */
+void ArenaBoard::arenaLoop()
+{
+    m_arena.step();
+    const qint64 stepNs = m_arena.lastThinkNs() + m_arena.lastResolveNs();
+    m_averageStepNs = m_averageStepNs == 0 ? stepNs : m_averageStepNs + (stepNs - m_averageStepNs) / 16;
+    renderImage();
+    updateStatsText();
+    update();
+}
+
+/**
+ * @brief 按竞技场的当前状态重画区域图像
+ *
+ * 逐行写入像素：被占用的格子取所属蛇的颜色，再把存活的蛇头改为深色。
+ */
+void ArenaBoard::renderImage()
+{
+    for (int y = 0; y < m_arena.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(m_image.scanLine(y));
+        for (int x = 0; x < m_arena.width(); ++x) {
+            const QPoint cell(x, y);
+            const int owner = m_arena.ownerAt(cell);
+            line[x] = owner >= 0 ? m_bodyColors.at(owner)
+                    : m_arena.isFood(cell) ? kFoodColor : kEmptyColor;
+        }
+    }
+    for (int s = 0; s < m_arena.snakeCount(); ++s) {
+        if (m_arena.isAlive(s)) {
+            m_image.setPixel(m_arena.head(s), m_headColors.at(s));
+        }
+    }
+}
+
+/**
+ * @brief 按竞技场的当前状态重新排版统计文字
+ *
+ * 每一步只排版一次，窗口因其他原因重绘（如缩放、遮挡）时直接画缓存的结果。
+ */
+void ArenaBoard::updateStatsText()
+{
+    int longest = 0;
+    for (int s = 0; s < m_arena.snakeCount(); ++s) {
+        longest = qMax(longest, m_arena.length(s));
+    }
+
+    m_statsText.setText(QStringLiteral("区域 %1x%2  存活 %3/%4  最长 %5  步数 %6<br>"
+                                       "每步 %7 µs：决策 %8 µs（%9线程） 结算 %10 µs<br>"
+                                       "死亡：蛇头相撞 %11  撞到蛇身 %12  撞墙 %13")
+            .arg(m_arena.width()).arg(m_arena.height())
+            .arg(m_arena.aliveCount()).arg(m_arena.snakeCount())
+            .arg(longest).arg(m_arena.tickCount())
+            .arg(m_averageStepNs / 1000.0, 0, 'f', 1)
+            .arg(m_arena.lastThinkNs() / 1000.0, 0, 'f', 1)
+            .arg(m_pool.threadCount())
+            .arg(m_arena.lastResolveNs() / 1000.0, 0, 'f', 1)
+            .arg(m_arena.headOnDeaths()).arg(m_arena.bodyDeaths()).arg(m_arena.wallDeaths()));
+    m_statsText.prepare(QTransform(), m_statsFont);  // 先按字体排版，size()才是最终大小
+}
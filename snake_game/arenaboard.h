@@ -0,0 +1,77 @@
+#ifndef ARENABOARD_H
+#define ARENABOARD_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QKeyEvent>
+#include <QImage>
+#include <QStaticText>
+#include "snakearena.h"
+#include "workstealingpool.h"
+
+/**
+ * @brief ArenaBoard类显示多蛇竞技场（SnakeArena）
+ *
+ * 数百条AI蛇在同一块大区域上争夺食物，每一步的决策在任务窃取线程池上并行。
+ * 区域先按每格一个像素画到图像中（每条蛇一种颜色，蛇头颜色较深，食物为红色），
+ * 再整体缩放到窗口；左上角显示存活的蛇数和每一步决策、结算的耗时。
+ * 统计文字每一步排版一次（QStaticText），字体只建立一次，重绘时只画缓存的结果。
+ * 空格键暂停/继续，R键用新的种子重新开始，ESC键退出。
+ */
+class ArenaBoard : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param snakeCount 蛇的数量
+     * @param fieldSize 区域大小（格子数），为空时按蛇的数量选择
+     * @param parent 父窗口部件指针
+     */
+    ArenaBoard(int snakeCount, const QSize &fieldSize = QSize(), QWidget *parent = nullptr);
+
+protected:
+    /**
+     * @brief 绘制区域和耗时信息
+     * @param event 绘制事件对象
+     */
+    void paintEvent(QPaintEvent *event) override;
+
+    /**
+     * @brief 处理键盘事件（空格暂停/继续，R重新开始，ESC退出）
+     * @param event 键盘事件对象
+     */
+    void keyPressEvent(QKeyEvent *event) override;
+
+private slots:
+    /**
+     * @brief 推进一步并重绘
+     */
+    void arenaLoop();
+
+private:
+    /**
+     * @brief 按竞技场的当前状态重画区域图像
+     */
+    void renderImage();
+
+    /**
+     * @brief 按竞技场的当前状态重新排版统计文字（每一步调用一次）
+     */
+    void updateStatsText();
+
+private:
+    WorkStealingPool m_pool;    // 决策阶段使用的线程池
+    SnakeArena m_arena;         // 多蛇竞技场
+    QTimer m_timer;             // 推进计时器
+    QImage m_image;             // 每格一个像素的区域图像
+    QVector<QRgb> m_bodyColors; // 每条蛇的颜色
+    QVector<QRgb> m_headColors; // 每条蛇蛇头的颜色
+    qint64 m_averageStepNs;     // 每步耗时的滑动平均（纳秒）
+    QFont m_statsFont;          // 统计文字的字体
+    QFont m_messageFont;        // 暂停提示的字体
+    QStaticText m_statsText;    // 统计文字（三行）
+};
+
+#endif // ARENABOARD_H
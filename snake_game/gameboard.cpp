@@ -1,345 +1,1078 @@
-﻿/**
- * @file gameboard.cpp
- * @brief 游戏主界面实现文件
- * 
- * 该文件实现了GameBoard类的所有方法，包括游戏循环、绘制、键盘事件处理等功能。
- * GameBoard类负责贪吃蛇游戏的主界面渲染、游戏逻辑控制和用户交互处理。
- */
-#include "gameboard.h"
-#include <QPainter>
-#include <QRandomGenerator>
-#include <QMessageBox>
-#include <QApplication>
-
-/**
- * @brief GameBoard类构造函数
- * @param parent 父窗口部件指针
- * 
- * 初始化游戏界面和相关参数，设置窗口属性，连接计时器信号和游戏循环槽。
- */
-GameBoard::GameBoard(QWidget *parent) : QWidget(parent)
-{
-    // 设置窗口属性
-    setFocusPolicy(Qt::StrongFocus);  // 设置焦点策略为强焦点，确保能接收键盘事件
-    setBackgroundRole(QPalette::Base);  // 设置背景角色
-    setAutoFillBackground(true);  // 启用自动填充背景
-    
-    // 初始化游戏参数
-    m_fieldWidth = 30;  // 游戏区域宽度（方块数量）
-    m_fieldHeight = 20;  // 游戏区域高度（方块数量）
-    m_speed = 200;  // 默认速度200ms
-    m_score = 0;  // 初始分数为0
-    m_isGameRunning = false;  // 游戏初始状态为未运行
-    m_gameOver = false;  // 游戏初始状态为未结束
-    
-    // 连接计时器信号和游戏循环槽
-    connect(&m_gameTimer, &QTimer::timeout, this, &GameBoard::gameLoop);
-    
-    // 重置游戏状态
-    resetGame();
-}
-
-/**
- * @brief 开始游戏
- * 
- * 如果游戏已结束，则先重置游戏；然后设置游戏为运行状态，并启动游戏计时器。
- */
-void GameBoard::startGame()
-{
-    if (m_gameOver) {
-        resetGame();
-    }
-    
-    m_isGameRunning = true;
-    m_gameTimer.start(m_speed);
-}
-
-/**
- * @brief 暂停游戏
- * 
- * 设置游戏为暂停状态，停止游戏计时器，并触发重绘以显示暂停状态。
- */
-void GameBoard::pauseGame()
-{
-    m_isGameRunning = false;
-    m_gameTimer.stop();
-    update();  // 触发重绘以显示暂停状态
-}
-
-/**
- * @brief 重置游戏
- * 
- * 重置蛇的状态，分数归零，重新生成食物，并触发重绘。
- */
-void GameBoard::resetGame()
-{
-    m_snake.reset();  // 重置蛇的状态
-    m_score = 0;  // 重置分数为0
-    m_gameOver = false;  // 重置游戏结束标志
-    m_isGameRunning = false;  // 重置游戏运行标志
-    generateFood();  // 生成新食物
-    update();  // 触发重绘
-}
-
-/**
- * @brief 获取当前分数
- * @return 当前游戏分数
- */
-int GameBoard::getScore() const
-{
-    return m_score;
-}
-
-/**
- * @brief 重写绘制事件处理函数
- * @param event 绘制事件对象指针
- * 
- * 负责绘制游戏界面的所有元素，包括蛇、食物、游戏状态和分数。
- */
-void GameBoard::paintEvent(QPaintEvent *event)
-{
-    Q_UNUSED(event);  // 未使用的参数
-    
-    QPainter painter(this);
-    painter.setRenderHint(QPainter::Antialiasing);  // 设置抗锯齿渲染
-    
-    // 计算方块尺寸
-    int squareSize = getSquareSize();
-    
-    // 绘制蛇
-    QVector<QPoint> body = m_snake.getBody();
-    for (int i = 0; i < body.size(); ++i) {
-        QPoint pos = gameToWindow(body.at(i));  // 将游戏坐标转换为窗口坐标
-        
-        if (i == 0) {  // 蛇头
-            painter.fillRect(pos.x(), pos.y(), squareSize, squareSize, Qt::red);  // 蛇头用红色
-        } else {  // 蛇身
-            painter.fillRect(pos.x(), pos.y(), squareSize, squareSize, Qt::green);  // 蛇身用绿色
-        }
-        
-        // 绘制边框
-        painter.setPen(Qt::black);
-        painter.drawRect(pos.x(), pos.y(), squareSize, squareSize);
-    }
-    
-    // 绘制食物
-    QPoint foodPos = gameToWindow(m_food);  // 将食物的游戏坐标转换为窗口坐标
-    painter.fillRect(foodPos.x(), foodPos.y(), squareSize, squareSize, Qt::blue);  // 食物用蓝色
-    painter.drawRect(foodPos.x(), foodPos.y(), squareSize, squareSize);  // 绘制食物边框
-    
-    // 绘制游戏状态文本
-    // 在paintEvent函数中修改以下几处
-    
-    // 修改1：游戏未开始状态
-    if (!m_isGameRunning && !m_gameOver) {
-        painter.setPen(Qt::black);
-        QFont font;
-        font.setFamily(QStringLiteral("SimHei"));
-        font.setPointSize(16);
-        painter.setFont(font);
-        painter.drawText(rect(), Qt::AlignCenter, QStringLiteral("按空格键开始游戏"));
-    }
-    // 修改2：游戏暂停状态
-    else if (!m_isGameRunning && m_gameOver == false) {
-        painter.setPen(Qt::black);
-        QFont font;
-        font.setFamily(QStringLiteral("SimHei"));
-        font.setPointSize(16);
-        painter.setFont(font);
-        painter.drawText(rect(), Qt::AlignCenter, QStringLiteral("游戏暂停\n按空格键继续"));
-    }
-    // 修改3：游戏结束状态
-    else if (m_gameOver) {
-        painter.setPen(Qt::black);
-        QFont font;
-        font.setFamily(QStringLiteral("SimHei"));
-        font.setPointSize(16);
-        painter.setFont(font);
-        painter.drawText(rect(), Qt::AlignCenter,
-                         QStringLiteral("游戏结束\n分数: %1\n按空格键重新开始").arg(m_score));
-    }
-    
-    // 修改4：分数显示
-    painter.setPen(Qt::black);
-    QFont font;
-    font.setFamily(QStringLiteral("SimHei"));
-    font.setPointSize(12);
-    painter.setFont(font);
-    painter.drawText(10, 20, QStringLiteral("分数: %1").arg(m_score));
-}
-
-/**
- * @brief 重写键盘事件处理函数
- * @param event 键盘事件对象指针
- * 
- * 处理用户的键盘输入，包括方向键控制蛇的移动方向、空格键控制游戏开始/暂停/重启，以及ESC键退出游戏。
- */
-void GameBoard::keyPressEvent(QKeyEvent *event)
-{
-    if (event->isAutoRepeat()) {
-        return;  // 忽略自动重复的按键事件
-    }
-    
-    switch (event->key()) {
-    case Qt::Key_Up:
-        m_snake.setDirection(Up);  // 设置蛇向上移动
-        break;
-    case Qt::Key_Down:
-        m_snake.setDirection(Down);  // 设置蛇向下移动
-        break;
-    case Qt::Key_Left:
-        m_snake.setDirection(Left);  // 设置蛇向左移动
-        break;
-    case Qt::Key_Right:
-        m_snake.setDirection(Right);  // 设置蛇向右移动
-        break;
-    case Qt::Key_Space:
-        if (m_gameOver) {
-            resetGame();  // 游戏结束时，重新开始游戏
-            startGame();
-        } else if (m_isGameRunning) {
-            pauseGame();  // 游戏运行时，暂停游戏
-        } else {
-            startGame();  // 游戏暂停时，继续游戏
-        }
-        break;
-    case Qt::Key_Escape:
-        qApp->quit();  // 退出应用程序
-        break;
-    }
-}
-
-/**
- * @brief 重写窗口大小调整事件处理函数
- * @param event 窗口大小调整事件对象指针
- * 
- * 在窗口大小调整时，调用基类的resizeEvent方法，并触发重绘。
- */
-void GameBoard::resizeEvent(QResizeEvent *event)
-{
-    QWidget::resizeEvent(event);  // 调用基类的resizeEvent
-    update();  // 调整窗口大小时重新绘制
-}
-
-/**
- * @brief 游戏主循环槽函数
- * 
- * 定时执行的游戏逻辑，包括移动蛇、检查碰撞、处理食物吃取、更新分数和游戏速度，以及触发重绘。
- */
-void GameBoard::gameLoop()
-{
-    // 移动蛇
-    m_snake.move();
-    
-    // 检查碰撞
-    if (checkWallCollision() || m_snake.checkSelfCollision()) {
-        m_gameOver = true;  // 设置游戏结束标志
-        pauseGame();  // 暂停游戏
-    }
-    
-    // 检查是否吃到食物
-    if (checkFoodCollision()) {
-        m_snake.grow();  // 蛇增长一节
-        m_score += 10;  // 分数增加10分
-        generateFood();  // 生成新食物
-        
-        // 随着分数增加，游戏速度加快
-        if (m_score % 50 == 0 && m_speed > 50) {
-            m_speed -= 10;  // 速度增加（间隔减少）
-            if (m_isGameRunning) {
-                m_gameTimer.setInterval(m_speed);  // 更新计时器间隔
-            }
-        }
-    }
-    
-    // 触发重绘
-    update();
-}
-
-/**
- * @brief 生成食物
- * 
- * 随机生成食物位置，确保食物不会出现在蛇身上。
- */
-void GameBoard::generateFood()
-{
-    QVector<QPoint> body = m_snake.getBody();
-    
-    // 随机生成食物位置，确保不会出现在蛇身上
-    do {
-        int x = QRandomGenerator::global()->bounded(m_fieldWidth);  // 随机生成X坐标
-        int y = QRandomGenerator::global()->bounded(m_fieldHeight);  // 随机生成Y坐标
-        m_food = QPoint(x, y);
-    } while (body.contains(m_food));  // 确保食物不在蛇身上
-}
-
-/**
- * @brief 检查是否吃到食物
- * @return 如果蛇头碰到食物返回true，否则返回false
- */
-bool GameBoard::checkFoodCollision()
-{
-    return m_snake.getHeadPosition() == m_food;  // 检查蛇头位置是否与食物位置相同
-}
-
-/**
- * @brief 检查是否撞到墙壁
- * @return 如果蛇头超出游戏区域边界返回true，否则返回false
- */
-bool GameBoard::checkWallCollision()
-{
-    QPoint head = m_snake.getHeadPosition();  // 获取蛇头位置
-    
-    // 检查是否超出游戏区域边界
-    return head.x() < 0 || head.x() >= m_fieldWidth ||
-           head.y() < 0 || head.y() >= m_fieldHeight;
-}
-
-/**
- * @brief 计算适合窗口尺寸的最大方块大小
- * @return 方块的像素尺寸
- */
-int GameBoard::getSquareSize() const
-{
-    // 计算适合窗口尺寸的最大方块大小
-    int width = this->width() / m_fieldWidth;  // 基于窗口宽度计算的方块大小
-    int height = this->height() / m_fieldHeight;  // 基于窗口高度计算的方块大小
-    return qMin(width, height);  // 返回两者中的较小值，确保所有方块都能显示在窗口内
-}
-
-/**
- * @brief 将游戏坐标系转换为窗口坐标系
- * @param gamePos 游戏坐标系中的位置
- * @return 窗口坐标系中的位置
- */
-QPoint GameBoard::gameToWindow(const QPoint &gamePos) const
-{
-    // 将游戏坐标系转换为窗口坐标系
-    int squareSize = getSquareSize();
-    // 计算偏移量，使游戏区域居中显示
-    int offsetX = (this->width() - m_fieldWidth * squareSize) / 2;
-    int offsetY = (this->height() - m_fieldHeight * squareSize) / 2;
-    
-    // 转换坐标并加上偏移量
-    return QPoint(gamePos.x() * squareSize + offsetX, gamePos.y() * squareSize + offsetY);
-}
-
-/**
- * @brief 将窗口坐标系转换为游戏坐标系
- * @param windowPos 窗口坐标系中的位置
- * @return 游戏坐标系中的位置
- */
-QPoint GameBoard::windowToGame(const QPoint &windowPos) const
-{
-    // 将窗口坐标系转换为游戏坐标系
-    int squareSize = getSquareSize();
-    // 计算偏移量，使游戏区域居中显示
-    int offsetX = (this->width() - m_fieldWidth * squareSize) / 2;
-    int offsetY = (this->height() - m_fieldHeight * squareSize) / 2;
-    
-    // 减去偏移量并转换为游戏坐标
-    int x = (windowPos.x() - offsetX) / squareSize;
-    int y = (windowPos.y() - offsetY) / squareSize;
-    
-    return QPoint(x, y);
-}
+/**
+ * @file gameboard.cpp
+ * @brief 游戏主界面实现文件
+ * 
+ * 该文件实现了GameBoard类的所有方法，包括游戏循环、绘制、键盘事件处理等功能。
+ * GameBoard类负责贪吃蛇游戏的主界面渲染、游戏逻辑控制和用户交互处理。
+ */
+#include "gameboard.h"
+#include <QPainter>
+#include <QRandomGenerator>
+#include <QMessageBox>
+#include <QApplication>
+#include <QFontMetrics>
+#include <QTextOption>
+#include <algorithm>
+
+namespace {
+// 整体缩放后格子小于该尺寸（像素）时切换为镜头模式
+const int kMinSquareSize = 8;
+// 镜头模式下的格子尺寸（像素）
+const int kCameraSquareSize = 16;
+// 小地图的最大边长（像素）
+const int kMinimapSize = 160;
+// 帧计时器的间隔（毫秒），约为显示器的刷新率
+const int kFrameInterval = 16;
+// 格子图块在图集中的顺序
+enum Sprite { HeadSprite, BodySprite, FoodSprite, SpriteCount };
+// 每帧最多推进的步数，超过时丢弃积压的时间（例如窗口被拖动、计时器停顿之后）
+const int kMaxTicksPerFrame = 4;
+// 转向队列的容量
+const int kTurnQueueSize = 3;
+// 保留的输入延迟样本数
+const int kLatencySamples = 256;
+// 保留的绘制耗时样本数（约4秒的帧）
+const int kPaintSamples = 256;
+// 绘制耗时文字的刷新间隔（纳秒），每帧都变化，刷新太频繁本身就会增加绘制
+const qint64 kPaintTextIntervalNs = 500000000LL;
+// 游戏运行时保存检查点的间隔（纳秒）
+const qint64 kCheckpointIntervalNs = 10000000000LL;
+
+// 把样本写入固定大小的环形数组
+void appendSample(QVector<qint64> *samples, int *next, int capacity, qint64 value)
+{
+    if (samples->size() < capacity) {
+        samples->append(value);
+    } else {
+        (*samples)[*next] = value;
+    }
+    *next = (*next + 1) % capacity;
+}
+
+// 已排序样本的百分位数
+qint64 percentile(const QVector<qint64> &sorted, int p)
+{
+    return sorted.at((sorted.size() - 1) * p / 100);
+}
+
+// 文字变化时才重新设置（setText会丢弃已经排好的版面）
+void setStaticText(QStaticText *text, const QString &string)
+{
+    if (text->text() != string) {
+        text->setText(string);
+    }
+}
+
+// 格子中靠近side方向那一侧、占fraction比例的部分
+QRect partialRect(const QRect &cell, const QPoint &side, qreal fraction)
+{
+    const int length = qRound(cell.width() * fraction);
+    if (side.x() > 0) {
+        return QRect(cell.right() - length + 1, cell.top(), length, cell.height());
+    } else if (side.x() < 0) {
+        return QRect(cell.left(), cell.top(), length, cell.height());
+    } else if (side.y() > 0) {
+        return QRect(cell.left(), cell.bottom() - length + 1, cell.width(), length);
+    }
+    return QRect(cell.left(), cell.top(), cell.width(), length);
+}
+}
+
+/**
+ * @brief GameBoard类构造函数
+ * @param parent 父窗口部件指针
+ * 
+ * 初始化游戏界面和相关参数，设置窗口属性，连接帧计时器信号和帧循环槽。
+ */
+GameBoard::GameBoard(QWidget *parent) : QWidget(parent)
+{
+    // 设置窗口属性
+    setFocusPolicy(Qt::StrongFocus);  // 设置焦点策略为强焦点，确保能接收键盘事件
+    setBackgroundRole(QPalette::Base);  // 设置背景角色
+    setAutoFillBackground(true);  // 启用自动填充背景
+    
+    // 初始化界面状态（游戏区域默认30x20，由引擎持有）
+    m_isGameRunning = false;  // 游戏初始状态为未运行
+    m_autopilotEnabled = false;  // 默认由玩家控制
+    m_backbufferValid = false;  // 第一次绘制时建立后备缓冲
+    m_lastFrameNs = 0;
+    m_lastTurnNs = 0;
+    m_tickOnInput = false;  // 默认按固定步长推进
+    m_nextLatencySample = 0;
+    m_latencyOverlay = false;
+    m_latencyChanged = false;
+    m_nextPaintSample = 0;
+    m_lastPaintTextNs = 0;
+    m_recording = false;
+    m_lastCheckpointNs = 0;
+    
+    // 字体只建立一次，文字在状态变化时才重新排版
+    m_messageFont.setFamily(QStringLiteral("SimHei"));
+    m_messageFont.setPointSize(16);
+    m_overlayFont.setFamily(QStringLiteral("SimHei"));
+    m_overlayFont.setPointSize(12);
+    m_overlayAscent = QFontMetrics(m_overlayFont).ascent();
+    m_messageText.setTextFormat(Qt::RichText);  // 用<br>换行
+    m_messageText.setTextOption(QTextOption(Qt::AlignHCenter));
+    for (QStaticText *text : {&m_scoreText, &m_autopilotText, &m_latencyText, &m_paintText}) {
+        text->setTextFormat(Qt::PlainText);
+        text->setPerformanceHint(QStaticText::AggressiveCaching);
+    }
+    rebuildSprites();
+    
+    // 帧计时器按显示刷新率触发，游戏的步长由累加器控制
+    m_frameTimer.setTimerType(Qt::PreciseTimer);
+    m_frameTimer.setInterval(kFrameInterval);
+    connect(&m_frameTimer, &QTimer::timeout, this, &GameBoard::frameLoop);
+    m_clock.start();
+    
+    // 重置游戏状态
+    resetGame();
+}
+
+/**
+ * @brief 开始游戏
+ * 
+ * 如果游戏已结束，则先重置游戏；然后设置游戏为运行状态，并启动帧计时器。
+ * 暂停期间经过的时间不计入累加器，暂停前未满一步的部分保留。
+ * 运行中只按格子请求更新，不会覆盖居中的提示文字，因此开始时整体重画一次。
+ */
+void GameBoard::startGame()
+{
+    if (m_engine.isGameOver()) {
+        resetGame();
+    }
+    
+    m_isGameRunning = true;
+    m_lastFrameNs = m_clock.nsecsElapsed();
+    m_frameTimer.start();
+    update();  // 擦掉开始/暂停的提示文字（逐格更新不会覆盖它）
+}
+
+/**
+ * @brief 暂停游戏
+ * 
+ * 设置游戏为暂停状态，停止帧计时器，并触发重绘以显示暂停状态。
+ */
+void GameBoard::pauseGame()
+{
+    if (m_isGameRunning) {
+        saveCheckpoint();  // 暂停和结束时的状态都写入检查点
+    }
+    m_isGameRunning = false;
+    m_frameTimer.stop();
+    update();  // 触发重绘以显示暂停状态
+}
+
+/**
+ * @brief 重置游戏
+ * 
+ * 用新的随机种子重新开始一局（重置蛇、分数、速度和食物），并触发重绘。
+ */
+void GameBoard::resetGame()
+{
+    m_engine.reset(QRandomGenerator::global()->generate());  // 每局使用不同的食物序列
+    m_replay.start(m_engine);  // 从新的种子开始录制回放
+    m_recording = true;
+    resetView();
+}
+
+/**
+ * @brief 重置界面的状态
+ * 
+ * 引擎重新开始一局或从检查点恢复之后调用：整个游戏区域重画，镜头对准蛇头，
+ * 插值和转向队列从头开始，游戏处于暂停状态。
+ */
+void GameBoard::resetView()
+{
+    m_autopilot.reset();  // 自动驾驶重建位棋盘
+    m_backbufferValid = false;  // 整个游戏区域都需要重画
+    updateCamera(true);  // 镜头对准新的蛇头
+    m_accumulatorNs = 0;  // 从一步的开头计时
+    m_hasPrevious = false;  // 还没有可以插值的上一步
+    m_tailVacated = false;
+    m_turns.clear();  // 上一局未生效的转向作废
+    m_appliedTurnNs.clear();
+    m_interpolatedRect = QRect();
+    m_isGameRunning = false;  // 重置游戏运行标志
+    updateOverlayText();
+    update();  // 触发重绘
+}
+
+/**
+ * @brief 获取当前分数
+ * @return 当前游戏分数
+ */
+int GameBoard::getScore() const
+{
+    return m_engine.score();
+}
+
+/**
+ * @brief 设置游戏区域大小并重置游戏
+ * @param width 区域宽度（格子数）
+ * @param height 区域高度（格子数）
+ */
+void GameBoard::setFieldSize(int width, int height)
+{
+    pauseGame();
+    m_engine.setFieldSize(width, height);  // 引擎保证区域至少为20x20
+    rebuildSprites();  // 区域大小改变时方块尺寸也会改变
+    resetGame();
+}
+
+/**
+ * @brief 设置是否使用拐角编码的蛇身
+ * @param compact 是否使用拐角编码
+ */
+void GameBoard::setCompactBody(bool compact)
+{
+    m_engine.setCompactBody(compact);
+    m_backbufferValid = false;
+    update();
+}
+
+/**
+ * @brief 开启或关闭自动驾驶
+ * @param enabled 是否开启
+ */
+void GameBoard::setAutopilot(bool enabled)
+{
+    update(scoreRect());  // 关闭时耗时那一行也要擦掉
+    m_autopilotEnabled = enabled;
+    updateOverlayText();
+    update(scoreRect());
+}
+
+/**
+ * @brief 设置回放的保存路径
+ * @param path 文件路径，为空时不保存
+ */
+void GameBoard::setReplayPath(const QString &path)
+{
+    m_replayPath = path;
+}
+
+/**
+ * @brief 设置速度曲线
+ * @param schedule 速度曲线
+ * 
+ * 累加器每一帧都从引擎读取步长，新的步长从下一步开始生效，不需要重启计时器。
+ */
+void GameBoard::setSpeedSchedule(const SpeedSchedule &schedule)
+{
+    m_engine.setSpeedSchedule(schedule);
+    updateOverlayText();
+    update(scoreRect());
+}
+
+/**
+ * @brief 开启或关闭即时转向
+ * @param enabled 是否开启
+ */
+void GameBoard::setTickOnInput(bool enabled)
+{
+    m_tickOnInput = enabled;
+}
+
+/**
+ * @brief 显示或隐藏输入延迟的调试信息
+ * @param visible 是否显示
+ */
+void GameBoard::setLatencyOverlay(bool visible)
+{
+    update(scoreRect());  // 隐藏时延迟那一行也要擦掉
+    m_latencyOverlay = visible;
+    updateOverlayText();
+    update(scoreRect());
+}
+
+/**
+ * @brief 设置检查点的保存路径
+ * @param path 文件路径，为空时不保存
+ */
+void GameBoard::setCheckpointPath(const QString &path)
+{
+    m_checkpointPath = path;
+    m_checkpoint.close();  // 新的文件先完整保存一次
+}
+
+/**
+ * @brief 从检查点文件继续一局
+ * @param path 检查点文件的路径
+ * @param error 失败时写入原因
+ * @return 成功返回true
+ * 
+ * 检查点文件映射后直接恢复到引擎中，不需要重新推进；区域大小可能改变，格子图块随之重建。
+ */
+bool GameBoard::resumeCheckpoint(const QString &path, QString *error)
+{
+    pauseGame();
+    if (!SnakeCheckpoint::load(path, &m_engine, error)) {
+        resetGame();
+        return false;
+    }
+    m_recording = false;  // 回放需要从开头录制，继续的一局不保存
+    rebuildSprites();
+    resetView();
+    return true;
+}
+
+/**
+ * @brief 重写绘制事件处理函数
+ * @param event 绘制事件对象指针
+ * 
+ * 从后备缓冲复制需要更新的区域（蛇和食物已画在其中），在上面画出蛇头和蛇尾的插值，
+ * 再绘制游戏状态和分数。
+ */
+void GameBoard::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer paintTimer;  // 整个paintEvent的耗时，含后备缓冲的重建
+    paintTimer.start();
+    
+    if (!m_backbufferValid) {
+        rebuildBackbuffer();
+    }
+    
+    QPainter painter(this);
+    
+    // 只把后备缓冲中需要更新的部分复制到窗口（逐个矩形，避免合并成大的外接矩形）
+    QPoint origin = gameToWindow(m_bufferCells.topLeft());
+    QRect boardRect(origin, m_backbuffer.size());
+    for (const QRect &rect : event->region()) {
+        QRect target = rect.intersected(boardRect);
+        if (!target.isEmpty()) {
+            painter.drawImage(target, m_backbuffer, target.translated(-origin));
+        }
+    }
+    m_interpolatedRect = drawInterpolation(&painter);
+    
+    // 镜头模式下在右上角绘制小地图和当前视口
+    if (isCameraMode() && event->region().intersects(minimapRect())) {
+        QRect map = minimapRect();
+        painter.fillRect(map, QColor(255, 255, 255, 220));
+        painter.drawImage(map, m_minimap);
+        painter.setPen(Qt::black);
+        painter.drawRect(map.adjusted(0, 0, -1, -1));
+        
+        qreal scaleX = qreal(map.width()) / m_engine.width();
+        qreal scaleY = qreal(map.height()) / m_engine.height();
+        QRect view = visibleCells();
+        painter.setPen(Qt::blue);
+        painter.drawRect(QRectF(map.x() + view.x() * scaleX, map.y() + view.y() * scaleY,
+                                view.width() * scaleX, view.height() * scaleY));
+        QPoint head = m_engine.snake().getHeadPosition();
+        painter.fillRect(QRectF(map.x() + head.x() * scaleX - 1, map.y() + head.y() * scaleY - 1, 3, 3), Qt::red);
+    }
+    
+    // 格子都是与坐标轴对齐的矩形，不开启抗锯齿；文字由QStaticText缓存排版结果
+    painter.setPen(Qt::black);
+    
+    // 游戏未开始、暂停或结束时居中显示提示
+    if (!m_isGameRunning || m_engine.isGameOver()) {
+        const QSizeF size = m_messageText.size();
+        const QPointF topLeft(0, (height() - size.height()) / 2);
+        if (event->region().intersects(QRectF(topLeft, QSizeF(width(), size.height())).toAlignedRect())) {
+            painter.setFont(m_messageFont);
+            painter.drawStaticText(topLeft, m_messageText);
+        }
+    }
+    
+    // 分数、自动驾驶的规划耗时和输入延迟，每行20像素
+    if (event->region().intersects(scoreRect())) {
+        painter.setFont(m_overlayFont);
+        int top = 20 - m_overlayAscent;
+        painter.drawStaticText(10, top, m_scoreText);
+        if (m_autopilotEnabled) {
+            top += 20;
+            painter.drawStaticText(10, top, m_autopilotText);
+        }
+        if (m_latencyOverlay) {
+            top += 20;
+            painter.drawStaticText(10, top, m_latencyText);
+            top += 20;
+            painter.drawStaticText(10, top, m_paintText);
+        }
+    }
+    
+    // 这一帧反映了已经生效的转向，记下从按键到绘制完成的延迟
+    if (!m_appliedTurnNs.isEmpty()) {
+        const qint64 now = m_clock.nsecsElapsed();
+        for (qint64 pressedNs : qAsConst(m_appliedTurnNs)) {
+            recordLatency(now - pressedNs);
+        }
+        m_appliedTurnNs.clear();
+    }
+    
+    appendSample(&m_paintSamples, &m_nextPaintSample, kPaintSamples, paintTimer.nsecsElapsed());
+}
+
+/**
+ * @brief 重写键盘事件处理函数
+ * @param event 键盘事件对象指针
+ * 
+ * 处理用户的键盘输入，包括方向键控制蛇的移动方向（进入转向队列）、空格键控制游戏开始/暂停/重启、
+ * F3键切换输入延迟的显示，以及ESC键退出游戏。
+ */
+void GameBoard::keyPressEvent(QKeyEvent *event)
+{
+    if (event->isAutoRepeat()) {
+        return;  // 忽略自动重复的按键事件
+    }
+    
+    switch (event->key()) {
+    case Qt::Key_Up:
+        queueTurn(Up);  // 设置蛇向上移动
+        break;
+    case Qt::Key_Down:
+        queueTurn(Down);  // 设置蛇向下移动
+        break;
+    case Qt::Key_Left:
+        queueTurn(Left);  // 设置蛇向左移动
+        break;
+    case Qt::Key_Right:
+        queueTurn(Right);  // 设置蛇向右移动
+        break;
+    case Qt::Key_Space:
+        if (m_engine.isGameOver()) {
+            resetGame();  // 游戏结束时，重新开始游戏
+            startGame();
+        } else if (m_isGameRunning) {
+            pauseGame();  // 游戏运行时，暂停游戏
+        } else {
+            startGame();  // 游戏暂停时，继续游戏
+        }
+        break;
+    case Qt::Key_A:
+        setAutopilot(!m_autopilotEnabled);  // 切换自动驾驶
+        break;
+    case Qt::Key_F3:
+        setLatencyOverlay(!m_latencyOverlay);  // 切换输入延迟的显示
+        break;
+    case Qt::Key_Escape:
+        qApp->quit();  // 退出应用程序
+        break;
+    }
+}
+
+/**
+ * @brief 重写窗口大小调整事件处理函数
+ * @param event 窗口大小调整事件对象指针
+ * 
+ * 在窗口大小调整时，调用基类的resizeEvent方法，并触发重绘。
+ */
+void GameBoard::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);  // 调用基类的resizeEvent
+    m_backbufferValid = false;  // 方块尺寸可能改变，后备缓冲需要整张重画
+    rebuildSprites();  // 按新的方块尺寸重新生成格子图块
+    m_messageText.setTextWidth(width());  // 提示文字在新的宽度内居中
+    updateCamera(true);  // 视口大小改变，镜头重新对准蛇头
+    update();  // 调整窗口大小时重新绘制
+}
+
+/**
+ * @brief 帧循环槽函数
+ * 
+ * 把距上一帧经过的时间加进累加器，每满一个步长（随分数变化，每次都从引擎读取）推进一步，
+ * 余下不足一步的时间留到下一帧，计时器的抖动不会累积。最后请求重画插值的格子：
+ * 上一帧画过的区域和这一帧要画的区域。
+ */
+void GameBoard::frameLoop()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    m_accumulatorNs += now - m_lastFrameNs;
+    m_lastFrameNs = now;
+    
+    int ticks = 0;
+    while (m_isGameRunning) {
+        const qint64 intervalNs = m_engine.intervalNs();
+        if (m_accumulatorNs < intervalNs) {
+            break;
+        }
+        if (ticks == kMaxTicksPerFrame) {
+            m_accumulatorNs %= intervalNs;  // 落后太多时不再追赶
+            break;
+        }
+        m_accumulatorNs -= intervalNs;
+        gameLoop();
+        ++ticks;
+    }
+    
+    if (m_isGameRunning && now - m_lastCheckpointNs >= kCheckpointIntervalNs) {
+        saveCheckpoint();
+    }
+    
+    update(m_interpolatedRect);
+    update(interpolationRect());
+    if (m_latencyOverlay && (m_latencyChanged || now - m_lastPaintTextNs >= kPaintTextIntervalNs)) {
+        m_lastPaintTextNs = now;
+        updateOverlayText();
+        update(scoreRect());
+    }
+    m_latencyChanged = false;
+}
+
+/**
+ * @brief 游戏主循环
+ * 
+ * 从转向队列取出一个方向（自动驾驶时由自动驾驶选择），让引擎推进一步，游戏结束时暂停，
+ * 然后只重绘变化的格子。同时记下移动前的蛇头和蛇尾，供两步之间插值使用。
+ */
+void GameBoard::gameLoop()
+{
+    // 记录移动前会变化的格子：旧蛇头变为蛇身，旧蛇尾可能被让出，食物可能被吃掉
+    const Snake &snake = m_engine.snake();
+    m_dirtyCells.append(snake.getHeadPosition());
+    m_dirtyCells.append(snake.getTailPosition());
+    m_dirtyCells.append(m_engine.food());
+    const int oldScore = m_engine.score();
+    m_previousHead = snake.getHeadPosition();
+    m_previousTail = snake.getTailPosition();
+    
+    if (m_autopilotEnabled) {
+        m_turns.clear();  // 自动驾驶时忽略按键
+        m_engine.setDirection(m_autopilot.plan(m_engine));  // 由自动驾驶选择方向
+    } else if (!m_turns.isEmpty()) {
+        const QueuedTurn turn = m_turns.takeFirst();  // 每一步只取一个转向
+        m_engine.setDirection(turn.direction);
+        if (turn.pressedNs >= 0) {
+            m_appliedTurnNs.append(turn.pressedNs);
+        }
+    }
+    SnakeEngine::StepResult result = m_engine.step();
+    if (m_recording) {
+        m_replay.record(snake.direction());  // 记录这一步实际移动的方向
+    }
+    if (result == SnakeEngine::Died || result == SnakeEngine::Won) {
+        pauseGame();  // 暂停游戏
+        if (m_recording) {
+            m_replay.finish(m_engine);
+            if (!m_replayPath.isEmpty() && !m_replay.save(m_replayPath)) {
+                qWarning("无法保存回放：%s", qPrintable(m_replayPath));
+            }
+        }
+    }
+    m_tailVacated = snake.getTailPosition() != m_previousTail;
+    m_hasPrevious = true;
+    
+    // 只重绘变化的格子（新蛇头和新食物）以及分数
+    m_dirtyCells.append(snake.getHeadPosition());
+    m_dirtyCells.append(m_engine.food());
+    updateCamera(false);
+    flushDirtyCells();
+    updateOverlayText();
+    if (m_engine.score() != oldScore || m_autopilotEnabled) {
+        update(scoreRect());  // 自动驾驶每步都要刷新规划耗时
+    }
+    if (isCameraMode()) {
+        rebuildMinimap();
+        update(minimapRect());
+    }
+}
+
+/**
+ * @brief 计算适合窗口尺寸的最大方块大小
+ * @return 方块的像素尺寸
+ */
+int GameBoard::getSquareSize() const
+{
+    // 计算适合窗口尺寸的最大方块大小
+    int width = this->width() / m_engine.width();  // 基于窗口宽度计算的方块大小
+    int height = this->height() / m_engine.height();  // 基于窗口高度计算的方块大小
+    int squareSize = qMin(width, height);  // 取两者中的较小值，确保所有方块都能显示在窗口内
+    
+    // 格子过小时改用镜头模式的固定尺寸，只显示区域的一部分
+    return squareSize >= kMinSquareSize ? squareSize : kCameraSquareSize;
+}
+
+/**
+ * @brief 是否处于镜头模式
+ * @return 区域无法以可读的格子尺寸整体显示时返回true
+ */
+bool GameBoard::isCameraMode() const
+{
+    return qMin(width() / m_engine.width(), height() / m_engine.height()) < kMinSquareSize;
+}
+
+/**
+ * @brief 获取当前可见的格子范围
+ * @return 可见格子的矩形（游戏坐标），非镜头模式下为整个区域
+ */
+QRect GameBoard::visibleCells() const
+{
+    QRect field(0, 0, m_engine.width(), m_engine.height());
+    if (!isCameraMode()) {
+        return field;
+    }
+    int squareSize = getSquareSize();
+    int columns = (width() + squareSize - 1) / squareSize;
+    int rows = (height() + squareSize - 1) / squareSize;
+    return QRect(m_camera, QSize(columns, rows)).intersected(field);
+}
+
+/**
+ * @brief 镜头模式下让镜头跟随蛇头
+ * @param force 为true时无论蛇头位置如何都重新对准
+ * 
+ * 蛇头进入视口边缘四分之一的范围时才把镜头移到以蛇头为中心的位置，
+ * 避免每一步都整张重建后备缓冲。
+ */
+void GameBoard::updateCamera(bool force)
+{
+    if (!isCameraMode()) {
+        m_camera = QPoint(0, 0);
+        return;
+    }
+    
+    int squareSize = getSquareSize();
+    int columns = (width() + squareSize - 1) / squareSize;
+    int rows = (height() + squareSize - 1) / squareSize;
+    QPoint head = m_engine.snake().getHeadPosition();
+    QRect inner = QRect(m_camera, QSize(columns, rows)).adjusted(columns / 4, rows / 4, -columns / 4, -rows / 4);
+    if (!force && inner.contains(head)) {
+        return;
+    }
+    
+    QPoint camera(qBound(0, head.x() - columns / 2, qMax(0, m_engine.width() - columns)),
+                  qBound(0, head.y() - rows / 2, qMax(0, m_engine.height() - rows)));
+    if (force || camera != m_camera) {
+        m_camera = camera;
+        m_backbufferValid = false;
+    }
+}
+
+/**
+ * @brief 由块的占用数重新生成小地图
+ * 
+ * 每个像素对应一块，颜色深浅表示块内被占用格子的比例，开销只与块数有关。
+ */
+void GameBoard::rebuildMinimap()
+{
+    const OccupancyGrid &grid = m_engine.snake().occupancy();
+    if (m_minimap.width() != grid.chunkColumns() || m_minimap.height() != grid.chunkRows()) {
+        m_minimap = QImage(grid.chunkColumns(), grid.chunkRows(), QImage::Format_ARGB32);
+    }
+    
+    const int chunkArea = 1 << (2 * OccupancyGrid::ChunkShift);
+    for (int y = 0; y < grid.chunkRows(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(m_minimap.scanLine(y));
+        for (int x = 0; x < grid.chunkColumns(); ++x) {
+            int occupied = grid.chunkOccupied(x, y);
+            int alpha = occupied == 0 ? 0 : qMin(255, 64 + occupied * 191 * 4 / chunkArea);  // 占满四分之一即为最深
+            line[x] = qRgba(0, 160, 0, alpha);
+        }
+    }
+}
+
+/**
+ * @brief 获取小地图所在的窗口区域
+ * @return 右上角按区域宽高比缩放的矩形
+ */
+QRect GameBoard::minimapRect() const
+{
+    int mapWidth = kMinimapSize;
+    int mapHeight = kMinimapSize;
+    if (m_engine.width() >= m_engine.height()) {
+        mapHeight = qMax(1, kMinimapSize * m_engine.height() / m_engine.width());
+    } else {
+        mapWidth = qMax(1, kMinimapSize * m_engine.width() / m_engine.height());
+    }
+    return QRect(width() - mapWidth - 10, 10, mapWidth, mapHeight);
+}
+
+/**
+ * @brief 将游戏坐标系转换为窗口坐标系
+ * @param gamePos 游戏坐标系中的位置
+ * @return 窗口坐标系中的位置
+ */
+QPoint GameBoard::gameToWindow(const QPoint &gamePos) const
+{
+    // 将游戏坐标系转换为窗口坐标系
+    int squareSize = getSquareSize();
+    // 计算偏移量，使游戏区域居中显示；镜头模式下视口左上角对齐窗口左上角
+    int offsetX = (this->width() - m_engine.width() * squareSize) / 2;
+    int offsetY = (this->height() - m_engine.height() * squareSize) / 2;
+    if (isCameraMode()) {
+        offsetX = -m_camera.x() * squareSize;
+        offsetY = -m_camera.y() * squareSize;
+    }
+    
+    // 转换坐标并加上偏移量
+    return QPoint(gamePos.x() * squareSize + offsetX, gamePos.y() * squareSize + offsetY);
+}
+
+/**
+ * @brief 将窗口坐标系转换为游戏坐标系
+ * @param windowPos 窗口坐标系中的位置
+ * @return 游戏坐标系中的位置
+ */
+QPoint GameBoard::windowToGame(const QPoint &windowPos) const
+{
+    // 将窗口坐标系转换为游戏坐标系
+    int squareSize = getSquareSize();
+    // 计算偏移量，与gameToWindow一致
+    int offsetX = (this->width() - m_engine.width() * squareSize) / 2;
+    int offsetY = (this->height() - m_engine.height() * squareSize) / 2;
+    if (isCameraMode()) {
+        offsetX = -m_camera.x() * squareSize;
+        offsetY = -m_camera.y() * squareSize;
+    }
+    
+    // 减去偏移量并转换为游戏坐标
+    int x = (windowPos.x() - offsetX) / squareSize;
+    int y = (windowPos.y() - offsetY) / squareSize;
+    
+    return QPoint(x, y);
+}
+
+/**
+ * @brief 重建后备缓冲
+ * 
+ * 图像只覆盖可见的格子。先填充背景，再按占用计数表的块索引访问可见范围内的块，
+ * 跳过整块空闲的块，只画出被占用的格子和食物；开销与视口大小有关，与蛇的长度无关。
+ */
+void GameBoard::rebuildBackbuffer()
+{
+    int squareSize = getSquareSize();
+    m_bufferCells = visibleCells();
+    m_backbuffer = QImage(qMax(1, m_bufferCells.width() * squareSize), qMax(1, m_bufferCells.height() * squareSize),
+                          QImage::Format_ARGB32_Premultiplied);
+    m_backbuffer.fill(palette().color(QPalette::Base));
+    
+    QPainter painter(&m_backbuffer);
+    
+    // 拐角编码的蛇身：每条直线段裁剪到视口后画成一个矩形，开销与拐角数成正比
+    if (m_engine.snake().isCompactBody()) {
+        m_engine.snake().forEachRun([&](const QPoint &head, const QPoint &tail) {
+            QRect run = QRect(head, tail).normalized().intersected(m_bufferCells);
+            if (!run.isEmpty()) {
+                run.translate(-m_bufferCells.topLeft());
+                painter.fillRect(run.x() * squareSize, run.y() * squareSize,
+                                 run.width() * squareSize, run.height() * squareSize, Qt::green);
+            }
+        });
+        drawCell(&painter, m_engine.snake().getHeadPosition());
+        drawCell(&painter, m_engine.food());
+        m_dirtyCells.clear();
+        m_backbufferValid = true;
+        return;
+    }
+    
+    const OccupancyGrid &grid = m_engine.snake().occupancy();
+    const int shift = OccupancyGrid::ChunkShift;
+    for (int chunkY = m_bufferCells.top() >> shift; chunkY <= m_bufferCells.bottom() >> shift; ++chunkY) {
+        for (int chunkX = m_bufferCells.left() >> shift; chunkX <= m_bufferCells.right() >> shift; ++chunkX) {
+            if (grid.chunkOccupied(chunkX, chunkY) == 0) {
+                continue;
+            }
+            QRect chunk = QRect(chunkX << shift, chunkY << shift, 1 << shift, 1 << shift).intersected(m_bufferCells);
+            for (int y = chunk.top(); y <= chunk.bottom(); ++y) {
+                for (int x = chunk.left(); x <= chunk.right(); ++x) {
+                    if (grid.isOccupied(QPoint(x, y))) {
+                        drawCell(&painter, QPoint(x, y));
+                    }
+                }
+            }
+        }
+    }
+    drawCell(&painter, m_engine.food());
+    
+    m_dirtyCells.clear();
+    m_backbufferValid = true;
+}
+
+/**
+ * @brief 在后备缓冲上重画一个格子
+ * @param painter 作用于后备缓冲的QPainter对象
+ * @param cell 格子的游戏坐标
+ * 
+ * 格子的内容只由当前状态决定，因此同一格子被标记多次也没有问题。
+ * 边框画在格子内部，重画一个格子不会覆盖相邻格子。
+ */
+void GameBoard::drawCell(QPainter *painter, const QPoint &cell)
+{
+    if (!m_bufferCells.contains(cell)) {
+        return;  // 区域外或视口外的格子不在后备缓冲中
+    }
+    
+    int squareSize = getSquareSize();
+    QPoint offset = cell - m_bufferCells.topLeft();
+    QRect rect(offset.x() * squareSize, offset.y() * squareSize, squareSize, squareSize);
+    
+    int sprite;
+    if (cell == m_engine.snake().getHeadPosition()) {
+        sprite = HeadSprite;
+    } else if (m_engine.snake().isOccupied(cell)) {
+        sprite = BodySprite;
+        if (m_engine.snake().isCompactBody()) {
+            painter->fillRect(rect, Qt::green);  // 拐角编码时蛇身按直线段绘制，不画每节的边框
+            return;
+        }
+    } else if (cell == m_engine.food() && !m_engine.isWon()) {
+        sprite = FoodSprite;
+    } else {
+        painter->fillRect(rect, palette().color(QPalette::Base));  // 空格子只填充背景
+        return;
+    }
+    
+    painter->drawPixmap(rect.topLeft(), m_sprites, QRect(sprite * squareSize, 0, squareSize, squareSize));
+}
+
+/**
+ * @brief 按当前的方块尺寸重新生成格子图块
+ * 
+ * 蛇头（红色）、蛇身（绿色）和食物（蓝色）各一个方块，带黑色边框，横向排成一张图，
+ * 画格子时只复制对应的一块，不再每次填充和描边。
+ */
+void GameBoard::rebuildSprites()
+{
+    const int squareSize = getSquareSize();
+    m_sprites = QPixmap(squareSize * SpriteCount, squareSize);
+    QPainter painter(&m_sprites);
+    painter.setPen(Qt::black);
+    const QColor colors[SpriteCount] = {Qt::red, Qt::green, Qt::blue};
+    for (int sprite = 0; sprite < SpriteCount; ++sprite) {
+        const QRect rect(sprite * squareSize, 0, squareSize, squareSize);
+        painter.fillRect(rect, colors[sprite]);
+        painter.drawRect(rect.adjusted(0, 0, -1, -1));  // 绘制边框
+    }
+}
+
+/**
+ * @brief 按当前状态更新分数、提示和调试信息的文字
+ * 
+ * 文字没有变化时不调用setText，QStaticText保留已经排好的版面。
+ */
+void GameBoard::updateOverlayText()
+{
+    setStaticText(&m_scoreText, QStringLiteral("分数: %1  每步 %2 ms")
+                  .arg(m_engine.score()).arg(m_engine.intervalNs() / 1e6, 0, 'f', 1));
+    
+    // 自动驾驶：最近一步和平均的规划耗时，以及采用的方式
+    if (m_autopilotEnabled) {
+        static const char *const modeNames[] = {"寻路", "回路", "追尾", "求生"};
+        setStaticText(&m_autopilotText, QStringLiteral("自动驾驶 %1%2 规划: %3 µs（平均 %4 µs）")
+                      .arg(QString::fromUtf8(modeNames[m_autopilot.lastMode()]))
+                      .arg(m_autopilot.lastReusedField() ? QStringLiteral("（沿用）") : QString())
+                      .arg(m_autopilot.lastPlanNs() / 1000.0, 0, 'f', 1)
+                      .arg(m_autopilot.averagePlanNs() / 1000.0, 0, 'f', 1));
+    }
+    if (m_latencyOverlay) {
+        setStaticText(&m_latencyText, latencyText());
+        setStaticText(&m_paintText, paintTimeText());
+    }
+    
+    if (!m_engine.isGameOver()) {
+        setStaticText(&m_messageText, QStringLiteral("按空格键开始游戏"));
+    } else {
+        setStaticText(&m_messageText, (m_engine.isWon() ? QStringLiteral("恭喜通关<br>分数: %1<br>按空格键重新开始")
+                                                        : QStringLiteral("游戏结束<br>分数: %1<br>按空格键重新开始"))
+                      .arg(m_engine.score()));
+    }
+}
+
+/**
+ * @brief 重画所有待更新的格子
+ * 
+ * 后备缓冲无效时（等待整张重画）只请求一次完整更新。
+ */
+void GameBoard::flushDirtyCells()
+{
+    if (!m_backbufferValid) {
+        m_dirtyCells.clear();
+        update();
+        return;
+    }
+    
+    int squareSize = getSquareSize();
+    QPainter painter(&m_backbuffer);
+    for (const QPoint &cell : qAsConst(m_dirtyCells)) {
+        drawCell(&painter, cell);
+        update(QRect(gameToWindow(cell), QSize(squareSize, squareSize)));
+    }
+    m_dirtyCells.clear();
+}
+
+/**
+ * @brief 把一次转向加入队列
+ * @param dir 按键对应的方向
+ * 
+ * 队列中的方向都已相对前一个方向检查过，取出时一定会被蛇接受。
+ * 开启即时转向时，如果队列为空且距上一次转向已超过一步，立即推进一步，
+ * 下一步从现在起重新计时（累加器清零），避免刚推进完就按键要等待整整一步。
+ */
+void GameBoard::queueTurn(Direction dir)
+{
+    const Direction last = m_turns.isEmpty() ? m_engine.snake().direction() : m_turns.last().direction;
+    if (dir == last || dir == opposite(last) || m_turns.size() == kTurnQueueSize) {
+        return;
+    }
+    
+    const qint64 now = m_clock.nsecsElapsed();
+    const bool idle = m_turns.isEmpty() && now - m_lastTurnNs >= m_engine.intervalNs();
+    const QueuedTurn turn = {dir, m_isGameRunning ? now : -1};
+    m_turns.append(turn);
+    m_lastTurnNs = now;
+    
+    if (m_tickOnInput && idle && m_isGameRunning && !m_autopilotEnabled) {
+        gameLoop();
+        m_accumulatorNs = 0;
+        m_lastFrameNs = now;
+        update(m_interpolatedRect);
+        update(interpolationRect());
+    }
+}
+
+/**
+ * @brief 记录一次输入到画面的延迟
+ * @param ns 延迟（纳秒）
+ * 
+ * 样本保存在固定大小的环形数组中，只保留最近的kLatencySamples个。
+ */
+void GameBoard::recordLatency(qint64 ns)
+{
+    appendSample(&m_latencySamples, &m_nextLatencySample, kLatencySamples, ns);
+    m_latencyChanged = true;
+}
+
+/**
+ * @brief 获取输入延迟调试信息的文本
+ * @return 最近样本的中位数、p95、p99和最大值（毫秒）
+ * 
+ * 延迟从按键事件到反映该转向的那一帧绘制完成，不包括窗口系统合成和显示器扫描的时间。
+ */
+QString GameBoard::latencyText() const
+{
+    if (m_latencySamples.isEmpty()) {
+        return QStringLiteral("输入延迟：还没有转向");
+    }
+    QVector<qint64> sorted = m_latencySamples;
+    std::sort(sorted.begin(), sorted.end());
+    return QStringLiteral("输入延迟 p50 %1 ms  p95 %2 ms  p99 %3 ms  最大 %4 ms（%5次）%6")
+            .arg(percentile(sorted, 50) / 1e6, 0, 'f', 1)
+            .arg(percentile(sorted, 95) / 1e6, 0, 'f', 1)
+            .arg(percentile(sorted, 99) / 1e6, 0, 'f', 1)
+            .arg(sorted.last() / 1e6, 0, 'f', 1)
+            .arg(sorted.size())
+            .arg(m_tickOnInput ? QStringLiteral("  即时转向") : QString());
+}
+
+/**
+ * @brief 获取绘制耗时调试信息的文本
+ * @return 最近若干次paintEvent耗时的中位数、p95和最大值（微秒）
+ * 
+ * 只计CPU端提交绘制命令的时间（含后备缓冲重建和文字绘制），不包括窗口系统合成；
+ * 用来在真实的显示器上比较绘制缓存前后每帧的开销。
+ */
+QString GameBoard::paintTimeText() const
+{
+    if (m_paintSamples.isEmpty()) {
+        return QStringLiteral("绘制耗时：还没有绘制");
+    }
+    QVector<qint64> sorted = m_paintSamples;
+    std::sort(sorted.begin(), sorted.end());
+    return QStringLiteral("绘制耗时 p50 %1 µs  p95 %2 µs  最大 %3 µs（%4帧）")
+            .arg(percentile(sorted, 50) / 1e3, 0, 'f', 1)
+            .arg(percentile(sorted, 95) / 1e3, 0, 'f', 1)
+            .arg(sorted.last() / 1e3, 0, 'f', 1)
+            .arg(sorted.size());
+}
+
+/**
+ * @brief 获取当前步长内已经过的比例（插值系数）
+ * @return [0, 1]，暂停时保持暂停前的值
+ */
+qreal GameBoard::interpolationAlpha() const
+{
+    const qint64 intervalNs = m_engine.intervalNs();
+    return qBound(qreal(0), qreal(m_accumulatorNs) / intervalNs, qreal(1));
+}
+
+/**
+ * @brief 获取插值时会画到的窗口区域
+ * @return 新蛇头和让出的蛇尾两个格子的窗口矩形，没有可插值的步时为空
+ */
+QRect GameBoard::interpolationRect() const
+{
+    if (!m_hasPrevious || m_engine.isGameOver()) {
+        return QRect();
+    }
+    const QSize size(getSquareSize(), getSquareSize());
+    QRect area(gameToWindow(m_engine.snake().getHeadPosition()), size);
+    if (m_tailVacated) {
+        area |= QRect(gameToWindow(m_previousTail), size);
+    }
+    return area;
+}
+
+/**
+ * @brief 在窗口上画出两步之间的中间状态
+ * @param painter 作用于窗口的QPainter对象
+ * @return 画过的窗口区域
+ * 
+ * 后备缓冲中是当前一步的状态。新蛇头所在的格子先填回背景，再从上一格蛇头的一侧画出
+ * 伸入的部分；让出的蛇尾格子中靠近新蛇尾的一侧画出还没有缩回的部分。
+ * 画面因此比逻辑最多晚一步，但不用预测下一步的方向。
+ */
+QRect GameBoard::drawInterpolation(QPainter *painter)
+{
+    if (!m_hasPrevious || m_engine.isGameOver()) {
+        return QRect();
+    }
+    
+    const Snake &snake = m_engine.snake();
+    const QSize size(getSquareSize(), getSquareSize());
+    const qreal alpha = interpolationAlpha();
+    painter->setPen(Qt::black);
+    
+    QRect drawn;
+    const QPoint head = snake.getHeadPosition();
+    if (m_tailVacated && m_previousTail != head) {
+        const QRect cell(gameToWindow(m_previousTail), size);
+        const QRect rest = partialRect(cell, snake.getTailPosition() - m_previousTail, 1 - alpha);
+        if (!rest.isEmpty()) {
+            painter->fillRect(rest, Qt::green);
+            if (!snake.isCompactBody()) {
+                painter->drawRect(rest.adjusted(0, 0, -1, -1));
+            }
+        }
+        drawn = cell;
+    }
+    
+    const QRect cell(gameToWindow(head), size);
+    painter->fillRect(cell, palette().color(QPalette::Base));
+    const QRect entered = partialRect(cell, m_previousHead - head, alpha);
+    if (!entered.isEmpty()) {
+        painter->fillRect(entered, Qt::red);
+        painter->drawRect(entered.adjusted(0, 0, -1, -1));
+    }
+    return drawn | cell;
+}
+
+/**
+ * @brief 获取分数文本所在的窗口区域
+ * @return 分数文本的窗口矩形
+ */
+QRect GameBoard::scoreRect() const
+{
+    return QRect(0, 0, width(), 30 + (m_autopilotEnabled ? 20 : 0) + (m_latencyOverlay ? 40 : 0));
+}
+
+/**
+ * @brief 保存检查点
+ * 
+ * 同一局的后续保存只写入蛇身新增的部分和占用位图、空闲集合中变化的页，
+ * 即使是很大的区域也只需写入几页，可以在帧循环中直接进行。
+ */
+void GameBoard::saveCheckpoint()
+{
+    m_lastCheckpointNs = m_clock.nsecsElapsed();
+    if (m_checkpointPath.isEmpty()) {
+        return;
+    }
+    QString error;
+    if (!m_checkpoint.save(m_engine, m_checkpointPath, &error)) {
+        qWarning("无法保存检查点：%s（%s）", qPrintable(m_checkpointPath), qPrintable(error));
+    }
+}
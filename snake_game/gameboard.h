@@ -1,140 +1,370 @@
-﻿#ifndef GAMEBOARD_H
-#define GAMEBOARD_H
-
-#include <QWidget>
-#include <QTimer>
-#include <QKeyEvent>
-#include "snake.h"
-
-/**
- * @brief GameBoard类表示游戏的主界面和游戏逻辑控制器
- * 
- * 该类负责游戏区域的绘制、游戏循环控制、用户输入处理以及游戏规则的实现。
- * 它包含蛇对象、食物位置、游戏计时器等核心游戏元素。
- */
-class GameBoard : public QWidget
-{
-    Q_OBJECT
-
-public:
-    /**
-     * @brief 构造函数
-     * @param parent 父窗口部件指针
-     */
-    explicit GameBoard(QWidget *parent = nullptr);
-    
-    /**
-     * @brief 开始游戏
-     * 
-     * 启动游戏计时器，使蛇开始移动
-     */
-    void startGame();
-    
-    /**
-     * @brief 暂停游戏
-     * 
-     * 停止游戏计时器，暂停蛇的移动
-     */
-    void pauseGame();
-    
-    /**
-     * @brief 重置游戏
-     * 
-     * 将游戏恢复到初始状态，包括重置蛇的位置、分数和生成新的食物
-     */
-    void resetGame();
-    
-    /**
-     * @brief 获取当前分数
-     * @return 返回当前游戏分数
-     */
-    int getScore() const;
-
-protected:
-    /**
-     * @brief 绘制游戏元素
-     * @param event 绘制事件对象
-     * 
-     * 重写QWidget的paintEvent方法，用于绘制蛇、食物和游戏状态信息
-     */
-    void paintEvent(QPaintEvent *event) override;
-    
-    /**
-     * @brief 处理键盘事件
-     * @param event 键盘事件对象
-     * 
-     * 重写QWidget的keyPressEvent方法，用于处理用户的键盘输入控制
-     */
-    void keyPressEvent(QKeyEvent *event) override;
-    
-    /**
-     * @brief 调整窗口大小时重新绘制
-     * @param event 窗口大小调整事件对象
-     * 
-     * 重写QWidget的resizeEvent方法，确保窗口大小改变时游戏画面能够正确缩放
-     */
-    void resizeEvent(QResizeEvent *event) override;
-
-private slots:
-    /**
-     * @brief 游戏循环
-     * 
-     * 游戏的核心逻辑循环，每间隔一定时间执行一次，处理蛇的移动、碰撞检测和分数更新
-     */
-    void gameLoop();
-
-private:
-    /**
-     * @brief 生成食物
-     * 
-     * 在游戏区域内随机生成食物位置，确保不会出现在蛇身上
-     */
-    void generateFood();
-    
-    /**
-     * @brief 检查是否吃到食物
-     * @return 如果蛇头碰到食物则返回true，否则返回false
-     */
-    bool checkFoodCollision();
-    
-    /**
-     * @brief 检查是否撞墙
-     * @return 如果蛇头碰到边界墙则返回true，否则返回false
-     */
-    bool checkWallCollision();
-    
-    /**
-     * @brief 获取方块尺寸
-     * @return 返回游戏中方块的大小（像素）
-     * 
-     * 根据窗口尺寸和游戏区域大小计算适合的方块尺寸
-     */
-    int getSquareSize() const;
-    
-    /**
-     * @brief 将游戏坐标转换为窗口坐标
-     * @param gamePos 游戏坐标系中的点
-     * @return 转换后的窗口坐标系中的点
-     */
-    QPoint gameToWindow(const QPoint &gamePos) const;
-    
-    /**
-     * @brief 将窗口坐标转换为游戏坐标
-     * @param windowPos 窗口坐标系中的点
-     * @return 转换后的游戏坐标系中的点
-     */
-    QPoint windowToGame(const QPoint &windowPos) const;
-
-private:
-    Snake m_snake;              // 蛇对象
-    QPoint m_food;              // 食物位置
-    QTimer m_gameTimer;         // 游戏计时器（控制游戏速度）
-    bool m_isGameRunning;       // 游戏是否正在运行
-    int m_score;                // 当前分数
-    int m_speed;                // 游戏速度（毫秒）
-    int m_fieldWidth;           // 游戏区域宽度（格子数）
-    int m_fieldHeight;          // 游戏区域高度（格子数）
-    bool m_gameOver;            // 游戏是否结束
-};
-
-#endif // GAMEBOARD_H
+#ifndef GAMEBOARD_H
+#define GAMEBOARD_H
+
+#include <QWidget>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QKeyEvent>
+#include <QImage>
+#include <QPixmap>
+#include <QStaticText>
+#include "snakeautopilot.h"
+#include "snakecheckpoint.h"
+#include "snakeengine.h"
+#include "snakereplay.h"
+
+/**
+ * @brief GameBoard类表示游戏的主界面
+ * 
+ * 该类负责游戏区域的绘制、游戏计时器和用户输入处理。游戏规则（移动、碰撞、食物、
+ * 分数和加速）全部在SnakeEngine中，GameBoard只在计时器触发时调用引擎推进一步，
+ * 把按键转成方向，并把引擎的状态画出来。
+ * 
+ * 游戏区域先画到一张常驻的后备缓冲图像上。每一步只有新蛇头、旧蛇头、让出的蛇尾和食物
+ * 所在的格子会变化，只重画这几个格子并只请求更新它们的窗口区域，绘制开销与蛇的长度无关；
+ * 窗口大小变化或游戏重置时才整张重画。
+ * 
+ * 绘制与游戏逻辑的节奏分开：帧计时器按显示刷新率（约60Hz）触发，每帧把经过的时间加进
+ * 累加器，累加器每满一个步长（引擎当前的时间间隔）就推进一步，余下的部分留到下一帧，
+ * 所以计时器的抖动不会累积，加速时也不需要重新设置计时器间隔；步长由引擎的速度曲线
+ * （SpeedSchedule）给出，精确到纳秒，可以逐个食物或逐段时间连续变化。两步之间按累加器的余量
+ * 插值：蛇头从上一格逐渐伸入新的格子，让出的蛇尾逐渐缩回，每帧只重画这两个格子。
+ * 
+ * 方向键先进入一个有界的转向队列，每一步取出一个，一步之内连按的两次转向（如掉头绕行）
+ * 不会丢失；与队尾相同或相反的方向直接忽略。开启即时转向后，空闲一段时间后的第一次转向
+ * 立即推进一步，不必等到下一步。每次转向记下按键的时刻，等反映它的那一帧绘制完成时
+ * 得到输入到画面的延迟，F3键显示最近若干次延迟和每次绘制（paintEvent）耗时的分位数。
+ * 
+ * 区域太大、整体缩放后格子过小时（如4096x4096）切换为镜头模式：格子保持固定的可读尺寸，
+ * 镜头在蛇头接近视口边缘时重新对准蛇头，后备缓冲只覆盖视口，重建时借助占用计数表的
+ * 块索引跳过整块空闲的区域；右上角的小地图由块的占用数降采样生成。
+ */
+class GameBoard : public QWidget
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param parent 父窗口部件指针
+     */
+    explicit GameBoard(QWidget *parent = nullptr);
+    
+    /**
+     * @brief 开始游戏
+     * 
+     * 启动游戏计时器，使蛇开始移动
+     */
+    void startGame();
+    
+    /**
+     * @brief 暂停游戏
+     * 
+     * 停止游戏计时器，暂停蛇的移动
+     */
+    void pauseGame();
+    
+    /**
+     * @brief 重置游戏
+     * 
+     * 将游戏恢复到初始状态，包括重置蛇的位置、分数和生成新的食物
+     */
+    void resetGame();
+    
+    /**
+     * @brief 获取当前分数
+     * @return 返回当前游戏分数
+     */
+    int getScore() const;
+    
+    /**
+     * @brief 设置游戏区域大小并重置游戏
+     * @param width 区域宽度（格子数）
+     * @param height 区域高度（格子数）
+     */
+    void setFieldSize(int width, int height);
+    
+    /**
+     * @brief 设置是否使用拐角编码的蛇身（耐力模式，适合数百万节的蛇）
+     * @param compact 是否使用拐角编码
+     * 
+     * 拐角编码时蛇身按直线段整体绘制，每段一个矩形，不再画每一节的边框
+     */
+    void setCompactBody(bool compact);
+    
+    /**
+     * @brief 开启或关闭自动驾驶
+     * @param enabled 是否由SnakeAutopilot控制方向
+     * 
+     * 开启后每一步先由自动驾驶选择方向，分数下方显示每步的规划耗时；运行中也可按A键切换
+     */
+    void setAutopilot(bool enabled);
+    
+    /**
+     * @brief 设置回放的保存路径
+     * @param path 每局结束时把回放（种子和每步的方向）写入该文件，为空时不保存
+     * 
+     * 回放可以用snake_verify在无界面的引擎上重新推进来校验分数
+     */
+    void setReplayPath(const QString &path);
+    
+    /**
+     * @brief 设置速度曲线
+     * @param schedule 每步时间间隔的预计算表，分数或游戏时间变化时按表平滑加速
+     */
+    void setSpeedSchedule(const SpeedSchedule &schedule);
+    
+    /**
+     * @brief 开启或关闭即时转向
+     * @param enabled 空闲一段时间（至少一步）后的第一次转向是否立即推进一步
+     */
+    void setTickOnInput(bool enabled);
+    
+    /**
+     * @brief 显示或隐藏输入延迟和绘制耗时的调试信息
+     * @param visible 是否在分数下方显示输入到画面延迟和绘制耗时的分位数；运行中也可按F3键切换
+     */
+    void setLatencyOverlay(bool visible);
+    
+    /**
+     * @brief 设置检查点的保存路径
+     * @param path 游戏运行时每隔一段时间、暂停和结束时把整局状态写入该文件（只写变化的页），为空时不保存
+     */
+    void setCheckpointPath(const QString &path);
+    
+    /**
+     * @brief 从检查点文件继续一局
+     * @param path 检查点文件的路径
+     * @param error 失败时写入原因，可为nullptr
+     * @return 成功返回true（游戏处于暂停状态，按空格继续）；失败时重新开始一局
+     * 
+     * 区域大小、蛇身的存储方式和速度曲线都按文件设置。继续的一局不是从开头录制的，不保存回放
+     */
+    bool resumeCheckpoint(const QString &path, QString *error = nullptr);
+
+protected:
+    /**
+     * @brief 绘制游戏元素
+     * @param event 绘制事件对象
+     * 
+     * 重写QWidget的paintEvent方法，用于绘制蛇、食物和游戏状态信息
+     */
+    void paintEvent(QPaintEvent *event) override;
+    
+    /**
+     * @brief 处理键盘事件
+     * @param event 键盘事件对象
+     * 
+     * 重写QWidget的keyPressEvent方法，用于处理用户的键盘输入控制
+     */
+    void keyPressEvent(QKeyEvent *event) override;
+    
+    /**
+     * @brief 调整窗口大小时重新绘制
+     * @param event 窗口大小调整事件对象
+     * 
+     * 重写QWidget的resizeEvent方法，确保窗口大小改变时游戏画面能够正确缩放
+     */
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    /**
+     * @brief 帧循环
+     * 
+     * 按显示刷新率执行：把经过的时间加进累加器，按步长推进游戏，再重绘插值的格子
+     */
+    void frameLoop();
+
+private:
+    /**
+     * @brief 游戏循环
+     * 
+     * 让引擎推进一步并重绘变化的格子
+     */
+    void gameLoop();
+    
+    /**
+     * @brief 重置界面的状态（镜头、插值、转向队列和后备缓冲），引擎的状态不变
+     */
+    void resetView();
+    
+    /**
+     * @brief 保存检查点（没有设置路径时只重新计时）
+     */
+    void saveCheckpoint();
+    
+    /**
+     * @brief 把一次转向加入队列
+     * @param dir 按键对应的方向
+     * 
+     * 与队尾（队列为空时为蛇当前的方向）相同或相反的方向以及队列已满时忽略
+     */
+    void queueTurn(Direction dir);
+    
+    /**
+     * @brief 记录一次输入到画面的延迟
+     * @param ns 延迟（纳秒）
+     */
+    void recordLatency(qint64 ns);
+    
+    /**
+     * @brief 获取输入延迟调试信息的文本
+     */
+    QString latencyText() const;
+    
+    /**
+     * @brief 获取绘制耗时调试信息的文本
+     */
+    QString paintTimeText() const;
+    
+    /**
+     * @brief 获取当前步长内已经过的比例（插值系数）
+     * @return [0, 1]，游戏暂停时保持暂停前的值
+     */
+    qreal interpolationAlpha() const;
+    
+    /**
+     * @brief 在窗口上画出蛇头伸入新格子、蛇尾缩回旧格子的中间状态
+     * @param painter 作用于窗口的QPainter对象
+     * @return 画过的窗口区域
+     */
+    QRect drawInterpolation(QPainter *painter);
+    
+    /**
+     * @brief 获取插值时会画到的窗口区域（新蛇头和让出的蛇尾两个格子）
+     */
+    QRect interpolationRect() const;
+
+    /**
+     * @brief 获取方块尺寸
+     * @return 返回游戏中方块的大小（像素）
+     * 
+     * 根据窗口尺寸和游戏区域大小计算适合的方块尺寸
+     */
+    int getSquareSize() const;
+    
+    /**
+     * @brief 是否处于镜头模式（区域无法以可读的格子尺寸整体显示）
+     */
+    bool isCameraMode() const;
+    
+    /**
+     * @brief 获取当前可见的格子范围（游戏坐标）
+     */
+    QRect visibleCells() const;
+    
+    /**
+     * @brief 镜头模式下蛇头接近视口边缘时让镜头重新对准蛇头
+     * @param force 为true时无论蛇头位置如何都重新对准
+     */
+    void updateCamera(bool force);
+    
+    /**
+     * @brief 由块的占用数重新生成小地图
+     */
+    void rebuildMinimap();
+    
+    /**
+     * @brief 获取小地图所在的窗口区域
+     */
+    QRect minimapRect() const;
+    
+    /**
+     * @brief 将游戏坐标转换为窗口坐标
+     * @param gamePos 游戏坐标系中的点
+     * @return 转换后的窗口坐标系中的点
+     */
+    QPoint gameToWindow(const QPoint &gamePos) const;
+    
+    /**
+     * @brief 将窗口坐标转换为游戏坐标
+     * @param windowPos 窗口坐标系中的点
+     * @return 转换后的游戏坐标系中的点
+     */
+    QPoint windowToGame(const QPoint &windowPos) const;
+    
+    /**
+     * @brief 按当前窗口大小重建后备缓冲并画出整个游戏区域
+     */
+    void rebuildBackbuffer();
+    
+    /**
+     * @brief 在后备缓冲上按格子的当前状态（蛇头、蛇身、食物或空）重画一个格子
+     * @param painter 作用于后备缓冲的QPainter对象
+     * @param cell 格子的游戏坐标，区域外时忽略
+     */
+    void drawCell(QPainter *painter, const QPoint &cell);
+    
+    /**
+     * @brief 按当前的方块尺寸重新生成蛇头、蛇身和食物的格子图块
+     */
+    void rebuildSprites();
+    
+    /**
+     * @brief 按当前状态更新分数、提示和调试信息的文字（只在状态变化时调用）
+     */
+    void updateOverlayText();
+    
+    /**
+     * @brief 重画所有待更新的格子，并只请求更新这些格子的窗口区域
+     */
+    void flushDirtyCells();
+    
+    /**
+     * @brief 获取分数文本所在的窗口区域
+     */
+    QRect scoreRect() const;
+
+private:
+    SnakeEngine m_engine;       // 游戏规则（蛇、食物、分数和速度）
+    SnakeAutopilot m_autopilot; // 自动驾驶
+    bool m_autopilotEnabled;    // 是否开启自动驾驶
+    SnakeReplay m_replay;       // 本局的回放
+    QString m_replayPath;       // 回放的保存路径（为空时不保存）
+    bool m_recording;           // 本局是否从开头录制了回放（从检查点继续时为false）
+    SnakeCheckpoint m_checkpoint; // 检查点（记住上次保存的内容，之后只写变化的页）
+    QString m_checkpointPath;   // 检查点的保存路径（为空时不保存）
+    qint64 m_lastCheckpointNs;  // 上一次保存检查点的时刻（纳秒）
+    QTimer m_frameTimer;        // 帧计时器（按显示刷新率触发）
+    QElapsedTimer m_clock;      // 单调时钟，累加每帧经过的时间
+    qint64 m_lastFrameNs;       // 上一帧的时刻（纳秒）
+    qint64 m_accumulatorNs;     // 还没有推进的时间（纳秒），满一个步长推进一步
+    bool m_isGameRunning;       // 游戏是否正在运行
+    bool m_hasPrevious;         // 是否已推进过一步（插值需要上一步的蛇头和蛇尾）
+    QPoint m_previousHead;      // 上一步的蛇头
+    QPoint m_previousTail;      // 上一步的蛇尾
+    bool m_tailVacated;         // 上一步是否让出了蛇尾（吃到食物增长时不让出）
+    QRect m_interpolatedRect;   // 最近一次插值画过的窗口区域
+    struct QueuedTurn {
+        Direction direction;    // 转向的方向
+        qint64 pressedNs;       // 按键的时刻（纳秒），游戏未运行时按下为-1，不计延迟
+    };
+    QVector<QueuedTurn> m_turns;  // 转向队列（每一步取出一个）
+    qint64 m_lastTurnNs;        // 最近一次加入转向的时刻（纳秒）
+    bool m_tickOnInput;         // 是否开启即时转向
+    QVector<qint64> m_appliedTurnNs; // 已经生效、等待绘制的转向的按键时刻
+    QVector<qint64> m_latencySamples; // 最近的输入到画面延迟（环形，纳秒）
+    int m_nextLatencySample;    // 下一个延迟写入的位置
+    bool m_latencyOverlay;      // 是否显示输入延迟
+    bool m_latencyChanged;      // 有新的延迟样本，需要刷新显示
+    QVector<qint64> m_paintSamples; // 最近每次paintEvent的耗时（环形，纳秒）
+    int m_nextPaintSample;      // 下一个绘制耗时写入的位置
+    qint64 m_lastPaintTextNs;   // 上一次刷新绘制耗时文字的时刻（纳秒）
+    QImage m_backbuffer;        // 游戏区域的后备缓冲
+    QPixmap m_sprites;          // 格子图块（蛇头、蛇身、食物横向排列，窗口大小变化时重新生成）
+    QFont m_messageFont;        // 提示文字的字体
+    QFont m_overlayFont;        // 分数和调试信息的字体
+    int m_overlayAscent;        // 分数字体的上升高度（由基线换算文字的顶部）
+    QStaticText m_messageText;  // 居中的提示（开始、暂停、结束）
+    QStaticText m_scoreText;    // 分数
+    QStaticText m_autopilotText; // 自动驾驶的规划耗时
+    QStaticText m_latencyText;  // 输入延迟的分位数
+    QStaticText m_paintText;    // 绘制耗时的分位数
+    bool m_backbufferValid;     // 后备缓冲是否与当前状态和窗口大小一致
+    QVector<QPoint> m_dirtyCells; // 本步需要重画的格子
+    QRect m_bufferCells;        // 后备缓冲覆盖的格子范围
+    QPoint m_camera;            // 镜头模式下视口左上角的格子
+    QImage m_minimap;           // 小地图（每个像素对应占用计数表的一块）
+};
+
+#endif // GAMEBOARD_H
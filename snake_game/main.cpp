@@ -1,23 +1,93 @@
-﻿#include "mainwindow.h"
-#include <QApplication>
-#include <QTextCodec>
-
-int main(int argc, char *argv[])
-{
-    // 先创建QApplication对象
-    QApplication a(argc, argv);
-    
-    // 针对Qt 5的中文显示设置
-    QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
-    
-    // 设置应用程序默认字体 - 使用更安全的方法
-    QFont font;
-    font.setFamily(QStringLiteral("SimHei")); // 使用QStringLiteral避免编码问题
-    font.setPointSize(9);
-    a.setFont(font);
-    
-    MainWindow w;
-    w.show();
-    
-    return a.exec();
-}
+#include "mainwindow.h"
+#include "arenaboard.h"
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QTextCodec>
+
+int main(int argc, char *argv[])
+{
+    // 先创建QApplication对象
+    QApplication a(argc, argv);
+    
+    // 针对Qt 5的中文显示设置
+    QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
+    
+    // 设置应用程序默认字体 - 使用更安全的方法
+    QFont font;
+    font.setFamily(QStringLiteral("SimHei")); // 使用QStringLiteral避免编码问题
+    font.setPointSize(9);
+    a.setFont(font);
+    
+    // 命令行参数：--board <宽>x<高> 设置游戏区域大小（如4096x4096，超出窗口时使用镜头模式）
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption boardOption(QStringLiteral("board"), QStringLiteral("游戏区域大小"), QStringLiteral("WxH"), QStringLiteral("30x20"));
+    QCommandLineOption enduranceOption(QStringLiteral("endurance"), QStringLiteral("耐力模式：使用拐角编码的蛇身，适合超长的蛇"));
+    QCommandLineOption autopilotOption(QStringLiteral("autopilot"), QStringLiteral("开启自动驾驶（运行中按A键切换）"));
+    QCommandLineOption recordOption(QStringLiteral("record"), QStringLiteral("每局结束时把回放保存到该文件"), QStringLiteral("file"));
+    QCommandLineOption arenaOption(QStringLiteral("arena"), QStringLiteral("多蛇竞技场：同时运行的AI蛇数量"), QStringLiteral("count"));
+    QCommandLineOption tickOnInputOption(QStringLiteral("tick-on-input"), QStringLiteral("即时转向：空闲后的第一次转向立即推进一步"));
+    QCommandLineOption speedOption(QStringLiteral("speed"), QStringLiteral("速度曲线：%1").arg(SpeedSchedule::names().join(QStringLiteral("、"))),
+                                   QStringLiteral("name"), QStringLiteral("classic"));
+    QCommandLineOption latencyOption(QStringLiteral("latency"), QStringLiteral("显示输入到画面延迟和绘制耗时的分位数（运行中按F3键切换）"));
+    QCommandLineOption checkpointOption(QStringLiteral("checkpoint"), QStringLiteral("游戏运行时定期、暂停和结束时把整局状态保存到该文件"), QStringLiteral("file"));
+    QCommandLineOption resumeOption(QStringLiteral("resume"), QStringLiteral("从检查点文件继续一局（区域大小和速度曲线按文件设置）"), QStringLiteral("file"));
+    parser.addOptions({boardOption, enduranceOption, autopilotOption, recordOption, arenaOption,
+                       tickOnInputOption, latencyOption, speedOption, checkpointOption, resumeOption});
+    parser.process(a);
+    
+    const QStringList board = parser.value(boardOption).split(QLatin1Char('x'));
+    
+    // 竞技场模式：区域大小未指定时按蛇的数量选择
+    if (parser.isSet(arenaOption)) {
+        QSize fieldSize;
+        if (parser.isSet(boardOption) && board.size() == 2) {
+            fieldSize = QSize(board.at(0).toInt(), board.at(1).toInt());
+        }
+        ArenaBoard arena(qMax(1, parser.value(arenaOption).toInt()), fieldSize);
+        arena.setWindowTitle(QStringLiteral("贪吃蛇竞技场"));
+        arena.resize(800, 800);
+        arena.show();
+        return a.exec();
+    }
+    
+    MainWindow w;
+    if (parser.isSet(boardOption) && board.size() == 2) {
+        w.gameBoard()->setFieldSize(board.at(0).toInt(), board.at(1).toInt());
+    }
+    if (parser.isSet(enduranceOption)) {
+        w.gameBoard()->setCompactBody(true);
+    }
+    if (parser.isSet(autopilotOption)) {
+        w.gameBoard()->setAutopilot(true);
+    }
+    if (parser.isSet(recordOption)) {
+        w.gameBoard()->setReplayPath(parser.value(recordOption));
+    }
+    if (parser.isSet(speedOption)) {
+        bool ok = false;
+        const SpeedSchedule schedule = SpeedSchedule::byName(parser.value(speedOption), &ok);
+        if (!ok) {
+            qWarning("未知的速度曲线：%s", qPrintable(parser.value(speedOption)));
+        }
+        w.gameBoard()->setSpeedSchedule(schedule);
+    }
+    if (parser.isSet(tickOnInputOption)) {
+        w.gameBoard()->setTickOnInput(true);
+    }
+    if (parser.isSet(latencyOption)) {
+        w.gameBoard()->setLatencyOverlay(true);
+    }
+    if (parser.isSet(checkpointOption)) {
+        w.gameBoard()->setCheckpointPath(parser.value(checkpointOption));
+    }
+    if (parser.isSet(resumeOption)) {
+        QString error;
+        if (!w.gameBoard()->resumeCheckpoint(parser.value(resumeOption), &error)) {
+            qWarning("无法从检查点继续：%s（%s）", qPrintable(parser.value(resumeOption)), qPrintable(error));
+        }
+    }
+    w.show();
+    
+    return a.exec();
+}
@@ -1,25 +1,28 @@
-﻿#ifndef MAINWINDOW_H
-#define MAINWINDOW_H
-
-#include <QMainWindow>
-#include "gameboard.h"  // 添加GameBoard头文件
-
-QT_BEGIN_NAMESPACE
-namespace Ui {
-class MainWindow;
-}
-QT_END_NAMESPACE
-
-class MainWindow : public QMainWindow
-{
-    Q_OBJECT
-
-public:
-    MainWindow(QWidget *parent = nullptr);
-    ~MainWindow();
-
-private:
-    Ui::MainWindow *ui;
-    GameBoard *m_gameBoard;  // 添加GameBoard指针成员变量
-};
-#endif // MAINWINDOW_H
+#ifndef MAINWINDOW_H
+#define MAINWINDOW_H
+
+#include <QMainWindow>
+#include "gameboard.h"  // 添加GameBoard头文件
+
+QT_BEGIN_NAMESPACE
+namespace Ui {
+class MainWindow;
+}
+QT_END_NAMESPACE
+
+class MainWindow : public QMainWindow
+{
+    Q_OBJECT
+
+public:
+    MainWindow(QWidget *parent = nullptr);
+    ~MainWindow();
+    
+    // 获取游戏主界面
+    GameBoard *gameBoard() const;
+
+private:
+    Ui::MainWindow *ui;
+    GameBoard *m_gameBoard;  // 添加GameBoard指针成员变量
+};
+#endif // MAINWINDOW_H
@@ -0,0 +1,300 @@
+/**
+ * @file occupancygrid.cpp
+ * @brief 游戏区域占用计数实现文件
+ */
+#include "occupancygrid.h"
+#include <algorithm>
+
+/**
+ * @brief OccupancyGrid类构造函数
+ * @param width 区域宽度（格子数）
+ * @param height 区域高度（格子数）
+ */
+OccupancyGrid::OccupancyGrid(int width, int height)
+    : m_changes(0)
+    , m_generation(0)
+{
+    resize(width, height);
+}
+
+/**
+ * @brief 调整区域大小并清空所有计数
+ * @param width 区域宽度（格子数）
+ * @param height 区域高度（格子数）
+ */
+void OccupancyGrid::resize(int width, int height)
+{
+    m_width = qMax(0, width);
+    m_height = qMax(0, height);
+    m_chunkColumns = (m_width + (1 << ChunkShift) - 1) >> ChunkShift;
+    m_chunkRows = (m_height + (1 << ChunkShift) - 1) >> ChunkShift;
+    m_counts.clear();
+    clear();
+}
+
+/**
+ * @brief 清空所有计数
+ */
+void OccupancyGrid::clear()
+{
+    const int cells = m_width * m_height;
+    m_counts.fill(0, cells);
+    m_chunkCounts.fill(0, m_chunkColumns * m_chunkRows);
+    m_freeCells.resize(cells);
+    m_freeIndex.resize(cells);
+    for (int cell = 0; cell < cells; ++cell) {
+        m_freeCells[cell] = cell;
+        m_freeIndex[cell] = cell;
+    }
+    touchAllPages();
+}
+
+int OccupancyGrid::width() const
+{
+    return m_width;
+}
+
+int OccupancyGrid::height() const
+{
+    return m_height;
+}
+
+/**
+ * @brief 检查坐标是否在区域内
+ * @param pos 格子坐标
+ * @return 在区域内返回true
+ */
+bool OccupancyGrid::contains(const QPoint &pos) const
+{
+    return pos.x() >= 0 && pos.x() < m_width && pos.y() >= 0 && pos.y() < m_height;
+}
+
+/**
+ * @brief 格子的占用计数加一
+ * @param pos 格子坐标
+ */
+void OccupancyGrid::add(const QPoint &pos)
+{
+    if (contains(pos)) {
+        const int cell = pos.y() * m_width + pos.x();
+        if (m_counts[cell]++ == 0) {
+            m_bitmapPages[cell / BitmapPageCells] = ++m_changes;
+            takeFree(cell);
+            ++m_chunkCounts[(pos.y() >> ChunkShift) * m_chunkColumns + (pos.x() >> ChunkShift)];
+        }
+    }
+}
+
+/**
+ * @brief 格子的占用计数减一
+ * @param pos 格子坐标
+ */
+void OccupancyGrid::remove(const QPoint &pos)
+{
+    if (contains(pos)) {
+        const int cell = pos.y() * m_width + pos.x();
+        if (--m_counts[cell] == 0) {
+            m_bitmapPages[cell / BitmapPageCells] = ++m_changes;
+            putFree(cell);
+            --m_chunkCounts[(pos.y() >> ChunkShift) * m_chunkColumns + (pos.x() >> ChunkShift)];
+        }
+    }
+}
+
+/**
+ * @brief 获取格子的占用计数
+ * @param pos 格子坐标
+ * @return 占用计数，区域外为0
+ */
+int OccupancyGrid::count(const QPoint &pos) const
+{
+    return contains(pos) ? m_counts.at(pos.y() * m_width + pos.x()) : 0;
+}
+
+/**
+ * @brief 检查格子是否被占用
+ * @param pos 格子坐标
+ * @return 计数大于0时返回true
+ */
+bool OccupancyGrid::isOccupied(const QPoint &pos) const
+{
+    return count(pos) > 0;
+}
+
+/**
+ * @brief 获取空闲格子的数量
+ * @return 计数为0的格子数
+ */
+int OccupancyGrid::freeCount() const
+{
+    return m_freeCells.size();
+}
+
+/**
+ * @brief 按下标获取一个空闲格子
+ * @param index 下标，范围[0, freeCount())
+ * @return 格子坐标
+ */
+QPoint OccupancyGrid::freeCell(int index) const
+{
+    const int cell = m_freeCells.at(index);
+    return QPoint(cell % m_width, cell / m_width);
+}
+
+const int *OccupancyGrid::freeList() const
+{
+    return m_freeCells.constData();
+}
+
+/**
+ * @brief 从检查点恢复占用状态和空闲集合的顺序
+ * @param bitmap 占用位图
+ * @param freeCells 空闲格子集合
+ * @param freeCount 空闲格子数
+ * @return 数据一致时返回true
+ * 
+ * 先按位图重建计数和块的占用数，再按原来的顺序复制空闲集合并重建“格子到下标”的映射，
+ * 同时检查集合中的格子在区域内、未被占用且不重复，数量与位图一致。
+ */
+bool OccupancyGrid::restore(const quint64 *bitmap, const int *freeCells, int freeCount)
+{
+    const int cells = m_width * m_height;
+    m_chunkCounts.fill(0);
+    int occupied = 0;
+    for (int cell = 0; cell < cells; ++cell) {
+        const quint8 value = (bitmap[cell >> 6] >> (cell & 63)) & 1;
+        m_counts[cell] = value;
+        if (value) {
+            ++occupied;
+            ++m_chunkCounts[((cell / m_width) >> ChunkShift) * m_chunkColumns + ((cell % m_width) >> ChunkShift)];
+        }
+    }
+    
+    bool ok = freeCount == cells - occupied;
+    m_freeIndex.fill(-1, cells);
+    m_freeCells.resize(ok ? freeCount : 0);
+    for (int i = 0; ok && i < freeCount; ++i) {
+        const int cell = freeCells[i];
+        ok = cell >= 0 && cell < cells && m_counts.at(cell) == 0 && m_freeIndex.at(cell) < 0;
+        if (ok) {
+            m_freeCells[i] = cell;
+            m_freeIndex[cell] = i;
+        }
+    }
+    if (!ok) {
+        clear();
+        return false;
+    }
+    touchAllPages();
+    return true;
+}
+
+/**
+ * @brief 把位图的一页打包成字
+ * @param page 页号
+ * @param words 输出的字
+ */
+void OccupancyGrid::packBitmapPage(int page, quint64 *words) const
+{
+    const int first = page * BitmapPageCells;
+    const int last = qMin(first + BitmapPageCells, m_width * m_height);
+    std::fill(words, words + BitmapPageCells / 64, 0);
+    for (int cell = first; cell < last; ++cell) {
+        if (m_counts.at(cell)) {
+            words[(cell - first) >> 6] |= quint64(1) << (cell & 63);
+        }
+    }
+}
+
+quint64 OccupancyGrid::changeCount() const
+{
+    return m_changes;
+}
+
+quint64 OccupancyGrid::generation() const
+{
+    return m_generation;
+}
+
+int OccupancyGrid::bitmapPageCount() const
+{
+    return m_bitmapPages.size();
+}
+
+quint64 OccupancyGrid::bitmapPageChange(int page) const
+{
+    return m_bitmapPages.at(page);
+}
+
+int OccupancyGrid::freeListPageCount() const
+{
+    return m_freePages.size();
+}
+
+quint64 OccupancyGrid::freeListPageChange(int page) const
+{
+    return m_freePages.at(page);
+}
+
+int OccupancyGrid::chunkColumns() const
+{
+    return m_chunkColumns;
+}
+
+int OccupancyGrid::chunkRows() const
+{
+    return m_chunkRows;
+}
+
+/**
+ * @brief 获取一块中被占用的格子数
+ * @param chunkX 块的横向序号
+ * @param chunkY 块的纵向序号
+ * @return 被占用的格子数
+ */
+int OccupancyGrid::chunkOccupied(int chunkX, int chunkY) const
+{
+    return m_chunkCounts.at(chunkY * m_chunkColumns + chunkX);
+}
+
+/**
+ * @brief 把格子从空闲集合中移除
+ * @param cell 格子序号
+ * 
+ * 用集合末尾的格子填补它的位置，O(1)
+ */
+void OccupancyGrid::takeFree(int cell)
+{
+    const int index = m_freeIndex[cell];
+    const int last = m_freeCells.last();
+    m_freePages[index / FreeListPageEntries] = m_changes;
+    m_freeCells[index] = last;
+    m_freeIndex[last] = index;
+    m_freeCells.removeLast();
+    m_freeIndex[cell] = -1;
+}
+
+/**
+ * @brief 把格子加入空闲集合
+ * @param cell 格子序号
+ */
+void OccupancyGrid::putFree(int cell)
+{
+    m_freePages[m_freeCells.size() / FreeListPageEntries] = m_changes;
+    m_freeIndex[cell] = m_freeCells.size();
+    m_freeCells.append(cell);
+}
+
+/**
+ * @brief 所有页都记为刚刚变化
+ * 
+ * 清空、调整大小和恢复之后调用，下一次检查点需要写出全部内容。
+ */
+void OccupancyGrid::touchAllPages()
+{
+    const int cells = m_width * m_height;
+    ++m_generation;
+    ++m_changes;
+    m_bitmapPages.fill(m_changes, (cells + BitmapPageCells - 1) / BitmapPageCells);
+    m_freePages.fill(m_changes, (cells + FreeListPageEntries - 1) / FreeListPageEntries);
+}
@@ -0,0 +1,167 @@
+#ifndef OCCUPANCYGRID_H
+#define OCCUPANCYGRID_H
+
+#include <QPoint>
+#include <QVector>
+
+/**
+ * @brief OccupancyGrid类记录游戏区域中每个格子被蛇身占用的次数
+ * 
+ * 每个格子一个计数器而不是一个比特：蛇移动时新蛇头先计入、旧蛇尾后移出，
+ * 蛇头进入刚被蛇尾让出的格子时计数短暂为2再回到1，不会被误判为碰撞。
+ * 区域外的坐标不计数（撞墙由调用者单独判断）。
+ * 
+ * 另外维护一个可按下标访问的空闲格子集合：计数从0变为1时把格子与集合末尾交换后移除，
+ * 从1变为0时追加到末尾，并用“格子到下标”的映射定位。随机放置食物因此只需
+ * 在集合中均匀取一个下标，与蛇占满区域的程度无关。
+ * 
+ * 区域还按32x32格子划分为块，记录每块中被占用的格子数。大区域只绘制可见部分时，
+ * 可以跳过整块都空闲的区域；小地图也直接由块的占用数生成。
+ * 
+ * 检查点（SnakeCheckpoint）把占用位图和空闲格子集合按4096字节的页写入文件。
+ * 每次占用状态或空闲集合变化时递增一个只增不减的序号，并记在所在的页上，
+ * 增量保存时只需写出序号比上次保存时大的页。
+ */
+class OccupancyGrid
+{
+public:
+    // 块边长为 1 << ChunkShift 个格子
+    static const int ChunkShift = 5;
+    // 检查点的一页（4096字节）对应的位图格子数和空闲集合下标数
+    static const int BitmapPageCells = 4096 * 8;
+    static const int FreeListPageEntries = 4096 / 4;
+
+    /**
+     * @brief 构造函数
+     * @param width 区域宽度（格子数）
+     * @param height 区域高度（格子数）
+     */
+    OccupancyGrid(int width = 0, int height = 0);
+    
+    /**
+     * @brief 调整区域大小并清空所有计数
+     * @param width 区域宽度（格子数）
+     * @param height 区域高度（格子数）
+     */
+    void resize(int width, int height);
+    
+    /**
+     * @brief 清空所有计数
+     */
+    void clear();
+    
+    int width() const;
+    int height() const;
+    
+    /**
+     * @brief 检查坐标是否在区域内
+     * @param pos 格子坐标
+     * @return 在区域内返回true
+     */
+    bool contains(const QPoint &pos) const;
+    
+    /**
+     * @brief 格子的占用计数加一
+     * @param pos 格子坐标，区域外时忽略
+     */
+    void add(const QPoint &pos);
+    
+    /**
+     * @brief 格子的占用计数减一
+     * @param pos 格子坐标，区域外时忽略
+     */
+    void remove(const QPoint &pos);
+    
+    /**
+     * @brief 获取格子的占用计数
+     * @param pos 格子坐标
+     * @return 占用计数，区域外为0
+     */
+    int count(const QPoint &pos) const;
+    
+    /**
+     * @brief 检查格子是否被占用
+     * @param pos 格子坐标
+     * @return 计数大于0时返回true
+     */
+    bool isOccupied(const QPoint &pos) const;
+    
+    /**
+     * @brief 获取空闲格子的数量
+     * @return 计数为0的格子数，为0表示区域已被占满
+     */
+    int freeCount() const;
+    
+    /**
+     * @brief 按下标获取一个空闲格子
+     * @param index 下标，范围[0, freeCount())
+     * @return 格子坐标（集合内的顺序随占用变化而变化）
+     */
+    QPoint freeCell(int index) const;
+    
+    /**
+     * @brief 获取空闲格子集合
+     * @return freeCount()个格子序号（y*width()+x），顺序决定freeCell()的结果
+     */
+    const int *freeList() const;
+    
+    /**
+     * @brief 从检查点恢复占用状态和空闲集合的顺序
+     * @param bitmap 占用位图（每格1位，格子序号为y*width()+x）
+     * @param freeCells 空闲格子集合
+     * @param freeCount 空闲格子数
+     * @return 空闲集合恰好是位图中所有未占用的格子时返回true，否则清空并返回false
+     * 
+     * 恢复后所有格子的计数为0或1，空闲集合的顺序与保存时相同，食物的位置因此也相同
+     */
+    bool restore(const quint64 *bitmap, const int *freeCells, int freeCount);
+    
+    /**
+     * @brief 把位图的一页打包成字
+     * @param page 页号，范围[0, bitmapPageCount())
+     * @param words 输出BitmapPageCells/64个字，区域外的位为0
+     */
+    void packBitmapPage(int page, quint64 *words) const;
+    
+    quint64 changeCount() const;            // 最近一次变化的序号
+    quint64 generation() const;             // 清空、调整大小或恢复的次数（之后所有页都视为变化）
+    int bitmapPageCount() const;            // 位图的页数
+    quint64 bitmapPageChange(int page) const;  // 位图一页最近一次变化的序号
+    int freeListPageCount() const;          // 空闲集合的页数（按格子数计）
+    quint64 freeListPageChange(int page) const; // 空闲集合一页最近一次变化的序号
+    
+    int chunkColumns() const;  // 横向的块数
+    int chunkRows() const;     // 纵向的块数
+    
+    /**
+     * @brief 获取一块中被占用的格子数
+     * @param chunkX 块的横向序号
+     * @param chunkY 块的纵向序号
+     * @return 被占用的格子数，为0时整块空闲
+     */
+    int chunkOccupied(int chunkX, int chunkY) const;
+
+private:
+    // 把格子从空闲集合中交换到末尾后移除
+    void takeFree(int cell);
+    // 把格子追加到空闲集合末尾
+    void putFree(int cell);
+    // 所有页都记为刚刚变化
+    void touchAllPages();
+
+private:
+    int m_width;                // 区域宽度
+    int m_height;               // 区域高度
+    QVector<quint8> m_counts;   // 每个格子的占用计数（按行存储）
+    QVector<int> m_freeCells;   // 空闲格子集合（格子序号）
+    QVector<int> m_freeIndex;   // 每个格子在空闲集合中的下标，被占用时为-1
+    int m_chunkColumns;         // 横向的块数
+    int m_chunkRows;            // 纵向的块数
+    QVector<int> m_chunkCounts; // 每块中被占用的格子数
+    quint64 m_changes;          // 变化的序号
+    quint64 m_generation;       // 清空、调整大小或恢复的次数
+    QVector<quint64> m_bitmapPages; // 位图每页最近一次变化的序号
+    QVector<quint64> m_freePages;   // 空闲集合每页最近一次变化的序号
+};
+
+#endif // OCCUPANCYGRID_H
@@ -1,136 +1,362 @@
-﻿#include "snake.h"
-#include <QDebug>
-
-/**
- * @brief Snake类构造函数
- * @param parent 父对象指针
- * 
- * 初始化蛇对象，设置初始状态
- */
-Snake::Snake(QObject *parent) : QObject(parent)
-{
-    // 调用重置函数初始化蛇的状态
-    reset();
-}
-
-/**
- * @brief 获取蛇的身体部分
- * @return 返回包含蛇身体所有点的QVector
- */
-QVector<QPoint> Snake::getBody() const
-{
-    return m_body;
-}
-
-/**
- * @brief 设置蛇的移动方向
- * @param dir 要设置的方向
- * 
- * 该函数会防止蛇直接180度转向，例如向上移动时不能直接改为向下
- */
-void Snake::setDirection(Direction dir)
-{
-    // 防止180度转向：只有当新方向不是相反方向时才允许更改
-    if ((dir == Up && m_direction != Down) ||
-        (dir == Down && m_direction != Up) ||
-        (dir == Left && m_direction != Right) ||
-        (dir == Right && m_direction != Left)) {
-        m_nextDirection = dir;
-    }
-}
-
-/**
- * @brief 移动蛇
- * 
- * 根据当前方向移动蛇的头部，并根据是否需要增长决定是否移除尾部
- */
-void Snake::move()
-{
-    // 更新方向（使用m_nextDirection确保平滑转向）
-    m_direction = m_nextDirection;
-    
-    // 获取头部位置
-    QPoint head = m_body.first();
-    
-    // 根据方向移动头部
-    switch (m_direction) {
-    case Up:
-        head.setY(head.y() - 1);
-        break;
-    case Down:
-        head.setY(head.y() + 1);
-        break;
-    case Left:
-        head.setX(head.x() - 1);
-        break;
-    case Right:
-        head.setX(head.x() + 1);
-        break;
-    }
-    
-    // 将新头部添加到身体
-    m_body.prepend(head);
-    
-    // 如果不需要增长，则移除尾部
-    if (!m_grow) {
-        m_body.removeLast();
-    } else {
-        m_grow = false;  // 重置增长标志
-    }
-}
-
-/**
- * @brief 检查蛇是否撞到自己
- * @return 如果头部与身体其他部分碰撞则返回true，否则返回false
- */
-bool Snake::checkSelfCollision() const
-{
-    // 检查头部是否与身体其他部分碰撞
-    QPoint head = m_body.first();
-    for (int i = 1; i < m_body.size(); ++i) {
-        if (head == m_body.at(i)) {
-            return true;  // 发生碰撞
-        }
-    }
-    return false;  // 没有碰撞
-}
-
-/**
- * @brief 增长蛇的长度
- * 
- * 标记蛇在下一次移动时需要增长
- */
-void Snake::grow()
-{
-    m_grow = true;
-}
-
-/**
- * @brief 获取蛇头位置
- * @return 返回蛇头的坐标点
- */
-QPoint Snake::getHeadPosition() const
-{
-    return m_body.first();
-}
-
-/**
- * @brief 重置蛇的状态
- * 
- * 将蛇恢复到初始状态，包括位置、长度和方向
- */
-void Snake::reset()
-{
-    // 清空身体
-    m_body.clear();
-    
-    // 初始化蛇的位置（3个点组成的初始长度）
-    m_body.append(QPoint(10, 10));  // 头部
-    m_body.append(QPoint(9, 10));   // 第一节身体
-    m_body.append(QPoint(8, 10));   // 第二节身体
-    
-    // 默认向右移动
-    m_direction = Right;
-    m_nextDirection = Right;
-    m_grow = false;
-}
+#include "snake.h"
+#include <QDebug>
+
+/**
+ * @brief Snake类构造函数
+ * @param parent 父对象指针
+ * 
+ * 初始化蛇对象，设置初始状态
+ */
+Snake::Snake(QObject *parent) : QObject(parent)
+    , m_compact(false)
+    , m_occupancy(30, 20)
+{
+    // 调用重置函数初始化蛇的状态
+    reset();
+}
+
+/**
+ * @brief 获取蛇的长度
+ * @return 蛇身体的节数（含蛇头）
+ */
+int Snake::length() const
+{
+    return m_length;
+}
+
+/**
+ * @brief 按从头到尾的顺序获取身体的一节
+ * @param index 节的序号，0为蛇头
+ * @return 该节的坐标点
+ */
+QPoint Snake::segmentAt(int index) const
+{
+    if (m_compact) {
+        return m_runs.segmentAt(index);
+    }
+    return m_body.at((m_head + index) & (m_body.size() - 1));
+}
+
+/**
+ * @brief 切换蛇身的存储方式
+ * @param compact 为true时使用拐角编码
+ * 
+ * 按从头到尾的顺序把现有蛇身转换到另一种存储中，占用计数表不变
+ */
+void Snake::setCompactBody(bool compact)
+{
+    if (compact == m_compact) {
+        return;
+    }
+    
+    QVector<QPoint> body;
+    body.reserve(m_length);
+    forEachSegment([&body](int, const QPoint &pos) {
+        body.append(pos);
+    });
+    
+    m_compact = compact;
+    if (m_compact) {
+        m_runs.clear();
+        for (int i = body.size() - 1; i >= 0; --i) {
+            m_runs.pushHead(body.at(i));
+        }
+        m_body.fill(QPoint(), 16);  // 释放逐格存储占用的内存
+    } else {
+        int capacity = 16;
+        while (capacity < body.size()) {
+            capacity *= 2;
+        }
+        body.resize(capacity);
+        m_body.swap(body);
+        m_runs.clear();
+    }
+    m_head = 0;
+}
+
+/**
+ * @brief 是否使用拐角编码的蛇身
+ * @return 使用拐角编码时返回true
+ */
+bool Snake::isCompactBody() const
+{
+    return m_compact;
+}
+
+/**
+ * @brief 设置蛇的移动方向
+ * @param dir 要设置的方向
+ * 
+ * 该函数会防止蛇直接180度转向，例如向上移动时不能直接改为向下
+ */
+void Snake::setDirection(Direction dir)
+{
+    // 防止180度转向：只有当新方向不是相反方向时才允许更改
+    if ((dir == Up && m_direction != Down) ||
+        (dir == Down && m_direction != Up) ||
+        (dir == Left && m_direction != Right) ||
+        (dir == Right && m_direction != Left)) {
+        m_nextDirection = dir;
+    }
+}
+
+/**
+ * @brief 移动蛇
+ * 
+ * 根据当前方向移动蛇的头部，并根据是否需要增长决定是否移除尾部
+ */
+void Snake::move()
+{
+    // 更新方向（使用m_nextDirection确保平滑转向）
+    m_direction = m_nextDirection;
+    
+    // 获取头部位置
+    QPoint head = getHeadPosition();
+    
+    // 根据方向移动头部
+    switch (m_direction) {
+    case Up:
+        head.setY(head.y() - 1);
+        break;
+    case Down:
+        head.setY(head.y() + 1);
+        break;
+    case Left:
+        head.setX(head.x() - 1);
+        break;
+    case Right:
+        head.setX(head.x() + 1);
+        break;
+    }
+    
+    // 拐角编码：延长或新增蛇头所在的段，收缩蛇尾所在的段
+    if (m_compact) {
+        m_runs.pushHead(head);
+        m_occupancy.add(head);
+        if (m_grow) {
+            ++m_length;
+            m_grow = false;  // 重置增长标志
+        } else {
+            m_occupancy.remove(m_runs.popTail());
+        }
+        return;
+    }
+    
+    // 需要增长且缓冲区已满时先扩容
+    if (m_grow && m_length == m_body.size()) {
+        growCapacity();
+    }
+    
+    // 记下旧蛇尾（缓冲区已满时新蛇头会覆盖它所在的位置）
+    QPoint tail = getTailPosition();
+    
+    // 将新头部写入头索引前面的位置，先计入新蛇头
+    m_head = (m_head - 1) & (m_body.size() - 1);
+    m_body[m_head] = head;
+    m_occupancy.add(head);
+    
+    // 如果不需要增长，尾部自然移出（长度不变）；否则长度加一
+    if (m_grow) {
+        ++m_length;
+        m_grow = false;  // 重置增长标志
+    } else {
+        m_occupancy.remove(tail);
+    }
+}
+
+/**
+ * @brief 检查蛇是否撞到自己
+ * @return 如果头部与身体其他部分碰撞则返回true，否则返回false
+ */
+bool Snake::checkSelfCollision() const
+{
+    // 蛇头所在格子还被身体其他部分占用时即发生碰撞
+    return m_occupancy.count(getHeadPosition()) > 1;
+}
+
+/**
+ * @brief 设置游戏区域大小
+ * @param width 区域宽度（格子数）
+ * @param height 区域高度（格子数）
+ */
+void Snake::setFieldSize(int width, int height)
+{
+    m_occupancy.resize(width, height);
+    forEachSegment([this](int, const QPoint &pos) {
+        m_occupancy.add(pos);
+    });
+}
+
+/**
+ * @brief 检查格子是否被蛇身占用
+ * @param pos 格子坐标
+ * @return 被占用时返回true
+ */
+bool Snake::isOccupied(const QPoint &pos) const
+{
+    return m_occupancy.isOccupied(pos);
+}
+
+/**
+ * @brief 获取游戏区域的占用计数表
+ * @return 占用计数表的常量引用
+ */
+const OccupancyGrid &Snake::occupancy() const
+{
+    return m_occupancy;
+}
+
+/**
+ * @brief 增长蛇的长度
+ * 
+ * 标记蛇在下一次移动时需要增长
+ */
+void Snake::grow()
+{
+    m_grow = true;
+}
+
+/**
+ * @brief 获取蛇头位置
+ * @return 返回蛇头的坐标点
+ */
+QPoint Snake::getHeadPosition() const
+{
+    return m_compact ? m_runs.head() : m_body.at(m_head);
+}
+
+/**
+ * @brief 获取蛇尾位置
+ * @return 蛇尾的坐标点
+ */
+QPoint Snake::getTailPosition() const
+{
+    return m_compact ? m_runs.tail() : segmentAt(m_length - 1);
+}
+
+/**
+ * @brief 获取最近一次移动的方向
+ * @return 蛇头上一步实际移动的方向
+ */
+Direction Snake::direction() const
+{
+    return m_direction;
+}
+
+/**
+ * @brief 获取下一步的移动方向
+ * @return 尚未生效的方向
+ */
+Direction Snake::nextDirection() const
+{
+    return m_nextDirection;
+}
+
+/**
+ * @brief 是否在下一次移动时增长
+ * @return 吃到食物后、下一次移动前返回true
+ */
+bool Snake::isGrowing() const
+{
+    return m_grow;
+}
+
+/**
+ * @brief 从检查点恢复蛇的状态
+ * @return 数据一致时返回true
+ * 
+ * 蛇身按从头到尾的顺序复制到新的缓冲区开头（拐角编码时从蛇尾到蛇头依次加入），
+ * 占用计数表直接按位图和空闲集合恢复，不逐节累加，空闲集合的顺序与保存时相同。
+ * 每一节都必须在位图中被占用，只有撞墙结束时的蛇头可以在区域外。
+ */
+bool Snake::restore(const QPoint *ring, int capacity, int head, int length,
+                    Direction direction, Direction nextDirection, bool grow,
+                    const quint64 *bitmap, const int *freeCells, int freeCount)
+{
+    bool ok = capacity > 0 && (capacity & (capacity - 1)) == 0 && head >= 0 && head < capacity
+              && length > 0 && length <= capacity
+              && m_occupancy.restore(bitmap, freeCells, freeCount);
+    for (int i = 0; ok && i < length; ++i) {
+        const QPoint &pos = ring[(head + i) & (capacity - 1)];
+        ok = m_occupancy.contains(pos) ? m_occupancy.isOccupied(pos) : i == 0;
+    }
+    if (!ok) {
+        reset();
+        return false;
+    }
+    
+    int bodyCapacity = 16;
+    while (bodyCapacity < length) {
+        bodyCapacity *= 2;
+    }
+    m_body.fill(QPoint(), bodyCapacity);
+    m_head = 0;
+    m_length = length;
+    if (m_compact) {
+        m_runs.clear();
+        for (int i = length - 1; i >= 0; --i) {
+            m_runs.pushHead(ring[(head + i) & (capacity - 1)]);
+        }
+    } else {
+        for (int i = 0; i < length; ++i) {
+            m_body[i] = ring[(head + i) & (capacity - 1)];
+        }
+    }
+    
+    m_direction = direction;
+    m_nextDirection = nextDirection;
+    m_grow = grow;
+    return true;
+}
+
+/**
+ * @brief 重置蛇的状态
+ * 
+ * 将蛇恢复到初始状态，包括位置、长度和方向
+ */
+void Snake::reset()
+{
+    // 清空身体，保留一个较小的初始容量
+    m_body.fill(QPoint(), 16);
+    m_head = 0;
+    
+    // 初始化蛇的位置（3个点组成的初始长度）
+    m_body[0] = QPoint(10, 10);  // 头部
+    m_body[1] = QPoint(9, 10);   // 第一节身体
+    m_body[2] = QPoint(8, 10);   // 第二节身体
+    m_length = 3;
+    
+    // 拐角编码时从蛇尾到蛇头依次加入
+    if (m_compact) {
+        m_runs.clear();
+        for (int i = m_length - 1; i >= 0; --i) {
+            m_runs.pushHead(m_body.at(i));
+        }
+    }
+    
+    // 重建占用计数表
+    m_occupancy.clear();
+    for (int i = 0; i < m_length; ++i) {
+        m_occupancy.add(m_body.at(i));
+    }
+    
+    // 默认向右移动
+    m_direction = Right;
+    m_nextDirection = Right;
+    m_grow = false;
+}
+
+/**
+ * @brief 扩大环形缓冲区
+ * 
+ * 容量翻倍，并把身体按从头到尾的顺序复制到新缓冲区开头，蛇头索引归零
+ */
+void Snake::growCapacity()
+{
+    QVector<QPoint> body(m_body.size() * 2);
+    for (int i = 0; i < m_length; ++i) {
+        body[i] = segmentAt(i);
+    }
+    m_body.swap(body);
+    m_head = 0;
+}
@@ -1,87 +1,272 @@
-﻿#ifndef SNAKE_H
-#define SNAKE_H
-
-#include <QObject>
-#include <QVector>
-#include <QPoint>
-
-// 蛇的移动方向枚举
-enum Direction {
-    Up,    // 向上移动
-    Down,  // 向下移动
-    Left,  // 向左移动
-    Right  // 向右移动
-};
-
-/**
- * @brief Snake类表示游戏中的蛇对象
- * 
- * 该类负责管理蛇的状态、移动、碰撞检测等核心功能。
- * 蛇由一系列的点组成，通过QVector<QPoint>来存储。
- */
-class Snake : public QObject
-{
-    Q_OBJECT
-
-public:
-    /**
-     * @brief 构造函数
-     * @param parent 父对象指针
-     */
-    explicit Snake(QObject *parent = nullptr);
-    
-    /**
-     * @brief 获取蛇的身体部分
-     * @return 返回包含蛇身体所有点的QVector
-     */
-    QVector<QPoint> getBody() const;
-    
-    /**
-     * @brief 设置蛇的移动方向
-     * @param dir 要设置的方向
-     * 
-     * 注意：该函数会防止蛇直接180度转向（例如向上移动时不能直接改为向下）
-     */
-    void setDirection(Direction dir);
-    
-    /**
-     * @brief 移动蛇
-     * 
-     * 根据当前方向移动蛇的头部，并根据是否需要增长决定是否移除尾部
-     */
-    void move();
-    
-    /**
-     * @brief 检查蛇是否撞到自己
-     * @return 如果头部与身体其他部分碰撞则返回true，否则返回false
-     */
-    bool checkSelfCollision() const;
-    
-    /**
-     * @brief 增长蛇的长度
-     * 
-     * 标记蛇在下一次移动时需要增长
-     */
-    void grow();
-    
-    /**
-     * @brief 获取蛇头位置
-     * @return 返回蛇头的坐标点
-     */
-    QPoint getHeadPosition() const;
-    
-    /**
-     * @brief 重置蛇的状态
-     * 
-     * 将蛇恢复到初始状态，包括位置、长度和方向
-     */
-    void reset();
-
-private:
-    QVector<QPoint> m_body;       // 蛇的身体部分（一系列坐标点）
-    Direction m_direction;        // 当前移动方向
-    Direction m_nextDirection;    // 下一个移动方向（用于平滑转向）
-    bool m_grow;                  // 是否需要增长（吃到食物后为true）
-};
-
-#endif // SNAKE_H
+#ifndef SNAKE_H
+#define SNAKE_H
+
+#include <QObject>
+#include <QVector>
+#include <QPoint>
+#include "occupancygrid.h"
+#include "snakerunbody.h"
+
+// 蛇的移动方向枚举
+enum Direction {
+    Up,    // 向上移动
+    Down,  // 向下移动
+    Left,  // 向左移动
+    Right  // 向右移动
+};
+
+// 沿方向前进一格时x、y的变化量（y向下为正）
+inline int directionDx(int dir)
+{
+    return dir == Left ? -1 : dir == Right ? 1 : 0;
+}
+
+inline int directionDy(int dir)
+{
+    return dir == Up ? -1 : dir == Down ? 1 : 0;
+}
+
+// 相反的方向：取值中Up/Down、Left/Right相邻，相反方向只差最低位
+inline Direction opposite(Direction dir)
+{
+    return Direction(dir ^ 1);
+}
+
+/**
+ * @brief Snake类表示游戏中的蛇对象
+ * 
+ * 该类负责管理蛇的状态、移动、碰撞检测等核心功能。
+ * 蛇由一系列的点组成，存储在容量为2的幂的环形缓冲区中：移动时头索引后退一格写入新头部，
+ * 尾部只需把长度减一，因此每次移动都是O(1)，与蛇的长度无关。缓冲区满时容量翻倍（均摊O(1)）。
+ * 同时维护一张游戏区域的占用计数表，移动时增量更新，自身碰撞和格子占用检查只需查表。
+ * 
+ * 耐力模式下蛇可能长达数百万节，可以改用拐角编码的蛇身（SnakeRunBody），只存直线段，
+ * 内存与拐角数成正比；碰撞仍以占用计数表为准，绘制时按直线段整体处理（forEachRun）。
+ */
+class Snake : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 构造函数
+     * @param parent 父对象指针
+     */
+    explicit Snake(QObject *parent = nullptr);
+    
+    /**
+     * @brief 获取蛇的长度
+     * @return 蛇身体的节数（含蛇头）
+     */
+    int length() const;
+    
+    /**
+     * @brief 按从头到尾的顺序获取身体的一节
+     * @param index 节的序号，0为蛇头，length()-1为蛇尾
+     * @return 该节的坐标点
+     */
+    QPoint segmentAt(int index) const;
+    
+    /**
+     * @brief 按从头到尾的顺序访问身体的每一节，不复制身体
+     * @param visitor 可调用对象，参数为(int index, const QPoint &pos)，index为0时是蛇头
+     * 
+     * 环形缓冲区中的身体最多分为两段连续内存，逐段顺序访问，不需要每节取模
+     */
+    template <typename Visitor>
+    void forEachSegment(Visitor visitor) const
+    {
+        if (m_compact) {
+            int index = 0;
+            for (int r = 0; r < m_runs.runCount(); ++r) {
+                const SnakeRunBody::Run &run = m_runs.runAt(r);
+                for (int k = 0; k < run.length; ++k) {
+                    visitor(index++, run.head - run.step * k);
+                }
+            }
+            return;
+        }
+        
+        const QPoint *data = m_body.constData();
+        const int firstCount = qMin(m_length, m_body.size() - m_head);
+        for (int i = 0; i < firstCount; ++i) {
+            visitor(i, data[m_head + i]);
+        }
+        for (int i = firstCount; i < m_length; ++i) {
+            visitor(i, data[i - firstCount]);
+        }
+    }
+    
+    /**
+     * @brief 按从头到尾的顺序访问蛇身的每一条直线段
+     * @param visitor 可调用对象，参数为(const QPoint &head, const QPoint &tail)，即段两端的格子
+     * 
+     * 拐角编码时为O(段数)；逐格存储时需要扫描整条蛇来找出拐角
+     */
+    template <typename Visitor>
+    void forEachRun(Visitor visitor) const
+    {
+        if (m_compact) {
+            for (int r = 0; r < m_runs.runCount(); ++r) {
+                const SnakeRunBody::Run &run = m_runs.runAt(r);
+                visitor(run.head, run.tail());
+            }
+            return;
+        }
+        
+        // 与拐角编码一致：段之间不共享格子，长度为1的段可以沿任意方向延长
+        QPoint runHead = segmentAt(0);
+        QPoint previous = runHead;
+        QPoint step;
+        int runLength = 1;
+        for (int i = 1; i < m_length; ++i) {
+            QPoint current = segmentAt(i);
+            if (runLength > 1 && previous - current != step) {
+                visitor(runHead, previous);
+                runHead = current;
+                runLength = 1;
+            } else {
+                step = previous - current;
+                ++runLength;
+            }
+            previous = current;
+        }
+        visitor(runHead, previous);
+    }
+    
+    /**
+     * @brief 切换蛇身的存储方式
+     * @param compact 为true时使用拐角编码（只存直线段），为false时逐格存储在环形缓冲区中
+     */
+    void setCompactBody(bool compact);
+    
+    /**
+     * @brief 是否使用拐角编码的蛇身
+     */
+    bool isCompactBody() const;
+    
+    /**
+     * @brief 设置蛇的移动方向
+     * @param dir 要设置的方向
+     * 
+     * 注意：该函数会防止蛇直接180度转向（例如向上移动时不能直接改为向下）
+     */
+    void setDirection(Direction dir);
+    
+    /**
+     * @brief 设置游戏区域大小
+     * @param width 区域宽度（格子数）
+     * @param height 区域高度（格子数）
+     * 
+     * 占用计数表按该大小重建，默认为30x20
+     */
+    void setFieldSize(int width, int height);
+    
+    /**
+     * @brief 检查格子是否被蛇身占用
+     * @param pos 格子坐标
+     * @return 被占用时返回true（O(1)查表）
+     */
+    bool isOccupied(const QPoint &pos) const;
+    
+    /**
+     * @brief 获取游戏区域的占用计数表（含空闲格子集合）
+     * @return 占用计数表的常量引用
+     */
+    const OccupancyGrid &occupancy() const;
+    
+    /**
+     * @brief 移动蛇
+     * 
+     * 根据当前方向移动蛇的头部，并根据是否需要增长决定是否移除尾部
+     */
+    void move();
+    
+    /**
+     * @brief 检查蛇是否撞到自己
+     * @return 如果头部与身体其他部分碰撞则返回true，否则返回false
+     */
+    bool checkSelfCollision() const;
+    
+    /**
+     * @brief 增长蛇的长度
+     * 
+     * 标记蛇在下一次移动时需要增长
+     */
+    void grow();
+    
+    /**
+     * @brief 获取蛇头位置
+     * @return 返回蛇头的坐标点
+     */
+    QPoint getHeadPosition() const;
+    
+    /**
+     * @brief 获取蛇尾位置
+     * @return 返回蛇尾的坐标点（两种存储方式下都是O(1)）
+     */
+    QPoint getTailPosition() const;
+    
+    /**
+     * @brief 获取最近一次移动的方向
+     * @return 蛇头上一步实际移动的方向（尚未生效的转向不计入）
+     */
+    Direction direction() const;
+    
+    /**
+     * @brief 获取下一步的移动方向
+     * @return 已设置但尚未生效的方向（没有转向时与direction()相同）
+     */
+    Direction nextDirection() const;
+    
+    /**
+     * @brief 是否在下一次移动时增长
+     */
+    bool isGrowing() const;
+    
+    /**
+     * @brief 从检查点恢复蛇的状态
+     * @param ring 蛇身的环形缓冲区（容量为2的幂），第i节位于(head+i)&(capacity-1)
+     * @param capacity 环形缓冲区的容量
+     * @param head 蛇头在环形缓冲区中的索引
+     * @param length 蛇的长度
+     * @param direction 最近一次移动的方向
+     * @param nextDirection 下一步的移动方向
+     * @param grow 是否在下一次移动时增长
+     * @param bitmap 占用位图，格子序号为y*宽度+x
+     * @param freeCells 空闲格子集合（保持原来的顺序）
+     * @param freeCount 空闲格子数
+     * @return 数据一致时返回true；否则蛇恢复到初始状态并返回false
+     * 
+     * 区域大小不变（需要先调用setFieldSize），蛇身按当前的存储方式重建
+     */
+    bool restore(const QPoint *ring, int capacity, int head, int length,
+                 Direction direction, Direction nextDirection, bool grow,
+                 const quint64 *bitmap, const int *freeCells, int freeCount);
+    
+    /**
+     * @brief 重置蛇的状态
+     * 
+     * 将蛇恢复到初始状态，包括位置、长度和方向
+     */
+    void reset();
+
+private:
+    /**
+     * @brief 环形缓冲区已满时把容量翻倍，并把身体按从头到尾的顺序重新排列到开头
+     */
+    void growCapacity();
+
+private:
+    QVector<QPoint> m_body;       // 蛇身体的环形缓冲区（容量为2的幂）
+    int m_head;                   // 蛇头在环形缓冲区中的索引
+    int m_length;                 // 蛇的长度
+    bool m_compact;               // 是否使用拐角编码的蛇身
+    SnakeRunBody m_runs;          // 拐角编码的蛇身（m_compact为true时使用）
+    OccupancyGrid m_occupancy;    // 游戏区域的占用计数表
+    Direction m_direction;        // 当前移动方向
+    Direction m_nextDirection;    // 下一个移动方向（用于平滑转向）
+    bool m_grow;                  // 是否需要增长（吃到食物后为true）
+};
+
+#endif // SNAKE_H
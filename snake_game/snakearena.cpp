@@ -0,0 +1,670 @@
+#include "snakearena.h"
+#include <QElapsedTimer>
+#include <QtMath>
+#include <climits>
+
+namespace {
+// 每个食物的分数（与SnakeEngine一致）
+const int kFoodScore = 10;
+// 决策时向前搜索的空闲格子数上限，可达格子不少于min(该值, 蛇长)才认为方向安全
+const int kLookahead = 16;
+// 死亡后重生前等待的步数
+const int kRespawnTicks = 20;
+// 重生时随机尝试位置的次数，都不合适时下一步再试
+const int kSpawnTries = 8;
+// 死亡的蛇身每隔几节留下一个食物
+const int kDropEvery = 2;
+// 每条蛇占用的区域格子数（决定默认区域大小）
+const int kCellsPerSnake = 256;
+// 食物桶的边长为 1 << kBucketShift 个格子（默认密度下每桶约一个食物）
+const int kBucketShift = 4;
+const int kBucketSize = 1 << kBucketShift;
+}
+
+/**
+ * @brief 构造函数
+ * @param snakeCount 蛇的数量
+ * @param width 区域宽度（格子数）
+ * @param height 区域高度（格子数）
+ * @param seed 随机数种子
+ *
+ * 区域中保持与蛇数相同的食物数量。
+ */
+SnakeArena::SnakeArena(int snakeCount, int width, int height, quint32 seed)
+    : m_width(qMax(8, width))
+    , m_height(qMax(8, height))
+    , m_pool(nullptr)
+{
+    m_cells = m_width * m_height;
+    m_foodTarget = qMax(1, snakeCount);
+    m_snakes.resize(qMax(0, snakeCount));
+    m_next.resize(m_snakes.size());
+    m_targets.resize(m_snakes.size());
+    m_occupancy.resize(m_width, m_height);
+    m_owner.resize(m_cells);
+    m_isFood.resize(m_cells);
+    m_foodIndex.resize(m_cells);
+    m_bucketColumns = (m_width + kBucketSize - 1) >> kBucketShift;
+    m_bucketRows = (m_height + kBucketSize - 1) >> kBucketShift;
+    m_buckets.resize(m_bucketColumns * m_bucketRows);
+    m_bucketIndex.resize(m_cells);
+    m_claimLength.resize(m_cells);
+    m_claimCount.fill(0, m_cells);
+    reset(seed);
+}
+
+/**
+ * @brief 按蛇的数量给出默认的区域大小
+ * @param snakeCount 蛇的数量
+ * @return 正方形区域，边长至少为40
+ */
+QSize SnakeArena::defaultFieldSize(int snakeCount)
+{
+    const int side = qMax(40, qCeil(qSqrt(qreal(qMax(1, snakeCount)) * kCellsPerSnake)));
+    return QSize(side, side);
+}
+
+void SnakeArena::setThreadPool(WorkStealingPool *pool)
+{
+    m_pool = pool;
+}
+
+/**
+ * @brief 用新的种子清空区域，重新放置所有蛇和食物
+ * @param seed 随机数种子
+ *
+ * 放不下的蛇在之后的步中继续尝试重生。
+ */
+void SnakeArena::reset(quint32 seed)
+{
+    m_random.seed(seed);
+    m_occupancy.clear();
+    m_owner.fill(-1);
+    m_isFood.fill(0);
+    m_foodIndex.fill(-1);
+    m_foods.clear();
+    for (QVector<int> &bucket : m_buckets) {
+        bucket.clear();
+    }
+    m_targets.fill(-1);
+    m_ticks = 0;
+    m_headOnDeaths = 0;
+    m_bodyDeaths = 0;
+    m_wallDeaths = 0;
+    m_lastThinkNs = 0;
+    m_lastResolveNs = 0;
+
+    for (int s = 0; s < m_snakes.size(); ++s) {
+        ArenaSnake &snake = m_snakes[s];
+        snake.length = 0;
+        snake.alive = false;
+        snake.grow = false;
+        snake.score = 0;
+        snake.respawn = spawn(s) ? 0 : 1;
+    }
+    refillFood();
+}
+
+/**
+ * @brief 所有蛇同步推进一步
+ *
+ * 决策阶段按蛇分块并行，每条蛇只写自己的方向和目标；结算阶段按蛇的序号串行：
+ *   1. 计算新蛇头，统计进入每个格子的最长蛇；
+ *   2. 蛇头相撞中不是唯一最长的蛇判定死亡；
+ *   3. 所有不增长的蛇让出蛇尾（即将死亡的蛇也一样，其他蛇可以进入它让出的格子）；
+ *   4. 新蛇头已被占用（任何蛇身，包括即将死亡的蛇）的判定死亡；
+ *   5. 存活的蛇写入新蛇头并吃食物，死亡的蛇移除并留下食物，等待中的蛇重生，补充食物。
+ * 第4步之前不写入任何新蛇头，所以结果与蛇的序号无关。
+ */
+void SnakeArena::step()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    quint8 *next = m_next.data();
+    int *targets = m_targets.data();
+    auto body = [this, next, targets](int begin, int end) {
+        for (int s = begin; s < end; ++s) {
+            next[s] = think(s, targets[s]);
+        }
+    };
+    const int count = m_snakes.size();
+    if (m_pool) {
+        m_pool->parallelFor(count, 0, body);  // 块大小由线程池按线程数决定
+    } else if (count > 0) {
+        body(0, count);
+    }
+    m_lastThinkNs = timer.nsecsElapsed();
+    timer.restart();
+
+    // 1. 新蛇头和每个格子的争夺情况
+    for (int s = 0; s < count; ++s) {
+        ArenaSnake &snake = m_snakes[s];
+        if (!snake.alive) {
+            continue;
+        }
+        snake.direction = next[s];
+        snake.dying = false;
+        snake.newHead = neighbor(snake.body.at(snake.head), snake.direction);
+        const int cell = snake.newHead;
+        if (cell < 0) {
+            continue;
+        }
+        if (m_claimCount[cell] == 0 || snake.length > m_claimLength[cell]) {
+            m_claimLength[cell] = snake.length;
+            m_claimCount[cell] = 1;
+        } else if (snake.length == m_claimLength[cell] && m_claimCount[cell] < 255) {
+            ++m_claimCount[cell];
+        }
+    }
+
+    // 2. 撞墙和蛇头相撞
+    for (int s = 0; s < count; ++s) {
+        ArenaSnake &snake = m_snakes[s];
+        if (!snake.alive) {
+            continue;
+        }
+        const int cell = snake.newHead;
+        if (cell < 0) {
+            snake.dying = true;
+            ++m_wallDeaths;
+        } else if (snake.length < m_claimLength[cell] || m_claimCount[cell] > 1) {
+            snake.dying = true;
+            ++m_headOnDeaths;
+        }
+    }
+    for (const ArenaSnake &snake : qAsConst(m_snakes)) {
+        if (snake.alive && snake.newHead >= 0) {
+            m_claimCount[snake.newHead] = 0;
+        }
+    }
+
+    // 3. 让出蛇尾
+    for (int s = 0; s < count; ++s) {
+        ArenaSnake &snake = m_snakes[s];
+        if (!snake.alive) {
+            continue;
+        }
+        if (snake.grow) {
+            snake.grow = false;
+            continue;
+        }
+        const int tail = snake.body.at((snake.head + snake.length - 1) & (snake.body.size() - 1));
+        m_occupancy.remove(toPoint(tail));
+        if (m_owner[tail] == s) {
+            m_owner[tail] = -1;
+        }
+        --snake.length;
+    }
+
+    // 4. 撞到蛇身（此时占用计数表中只有旧的蛇身）
+    for (ArenaSnake &snake : m_snakes) {
+        if (snake.alive && !snake.dying && m_occupancy.isOccupied(toPoint(snake.newHead))) {
+            snake.dying = true;
+            ++m_bodyDeaths;
+        }
+    }
+
+    // 5. 写入新蛇头、移除死亡的蛇，新蛇头都写入后再重生，重生的蛇不会占住别的蛇刚进入的格子
+    for (int s = 0; s < count; ++s) {
+        ArenaSnake &snake = m_snakes[s];
+        if (!snake.alive) {
+            continue;
+        }
+        if (snake.dying) {
+            kill(s);
+            continue;
+        }
+        pushHead(s, snake.newHead);
+        if (m_isFood[snake.newHead]) {
+            removeFood(snake.newHead);
+            snake.grow = true;
+            snake.score += kFoodScore;
+        }
+    }
+    for (int s = 0; s < count; ++s) {
+        ArenaSnake &snake = m_snakes[s];
+        if (!snake.alive && --snake.respawn <= 0 && !spawn(s)) {
+            snake.respawn = 1;
+        }
+    }
+    refillFood();
+
+    ++m_ticks;
+    m_lastResolveNs = timer.nsecsElapsed();
+}
+
+int SnakeArena::snakeCount() const
+{
+    return m_snakes.size();
+}
+
+int SnakeArena::width() const
+{
+    return m_width;
+}
+
+int SnakeArena::height() const
+{
+    return m_height;
+}
+
+const OccupancyGrid &SnakeArena::occupancy() const
+{
+    return m_occupancy;
+}
+
+int SnakeArena::ownerAt(const QPoint &pos) const
+{
+    if (!m_occupancy.contains(pos)) {
+        return -1;
+    }
+    return m_owner.at(pos.y() * m_width + pos.x());
+}
+
+bool SnakeArena::isFood(const QPoint &pos) const
+{
+    return m_occupancy.contains(pos) && m_isFood.at(pos.y() * m_width + pos.x());
+}
+
+int SnakeArena::foodCount() const
+{
+    return m_foods.size();
+}
+
+QPoint SnakeArena::foodAt(int index) const
+{
+    return toPoint(m_foods.at(index));
+}
+
+bool SnakeArena::isAlive(int snake) const
+{
+    return m_snakes.at(snake).alive;
+}
+
+QPoint SnakeArena::head(int snake) const
+{
+    const ArenaSnake &s = m_snakes.at(snake);
+    return s.alive ? toPoint(s.body.at(s.head)) : QPoint(-1, -1);
+}
+
+int SnakeArena::length(int snake) const
+{
+    return m_snakes.at(snake).length;
+}
+
+int SnakeArena::score(int snake) const
+{
+    return m_snakes.at(snake).score;
+}
+
+int SnakeArena::aliveCount() const
+{
+    int alive = 0;
+    for (const ArenaSnake &snake : m_snakes) {
+        alive += snake.alive ? 1 : 0;
+    }
+    return alive;
+}
+
+quint64 SnakeArena::tickCount() const
+{
+    return m_ticks;
+}
+
+quint64 SnakeArena::headOnDeaths() const
+{
+    return m_headOnDeaths;
+}
+
+quint64 SnakeArena::bodyDeaths() const
+{
+    return m_bodyDeaths;
+}
+
+quint64 SnakeArena::wallDeaths() const
+{
+    return m_wallDeaths;
+}
+
+qint64 SnakeArena::lastThinkNs() const
+{
+    return m_lastThinkNs;
+}
+
+qint64 SnakeArena::lastResolveNs() const
+{
+    return m_lastResolveNs;
+}
+
+/**
+ * @brief 为一条蛇选择方向
+ * @param snake 蛇的序号
+ * @param target 追逐的食物格子，食物被吃掉后重新选择最近的食物
+ * @return 选出的方向，无路可走时保持原方向
+ *
+ * 在不掉头、不进入被占用格子的方向中，依次比较：向前可达的空闲格子是否足够、
+ * 是否可能与不比自己短的蛇头相撞、离目标食物的距离、可达格子数。
+ * 只读取共享状态，可以与其他蛇的决策并发执行。
+ */
+quint8 SnakeArena::think(int snake, int &target) const
+{
+    const ArenaSnake &self = m_snakes.at(snake);
+    if (!self.alive) {
+        return self.direction;
+    }
+    const int head = self.body.at(self.head);
+    if (target < 0 || !m_isFood.at(target)) {
+        target = nearestFood(head);
+    }
+
+    const int need = qMin(kLookahead, self.length);
+    int best = -1;
+    bool bestSafe = false;
+    bool bestCalm = false;
+    int bestDistance = INT_MAX;
+    int bestSpace = -1;
+    for (int dir = Up; dir <= Right; ++dir) {
+        if (dir == opposite(Direction(self.direction))) {
+            continue;
+        }
+        const int cell = neighbor(head, dir);
+        if (cell < 0 || m_owner.at(cell) >= 0) {
+            continue;
+        }
+        const int space = reach(cell, need);
+        const bool safe = space >= need;
+        const bool calm = !isThreatened(cell, snake);
+        const int distance = target < 0 ? 0
+            : qAbs(cell % m_width - target % m_width) + qAbs(cell / m_width - target / m_width);
+        bool better;
+        if (best < 0 || safe != bestSafe) {
+            better = best < 0 || safe;
+        } else if (calm != bestCalm) {
+            better = calm;
+        } else if (distance != bestDistance) {
+            better = distance < bestDistance;
+        } else {
+            better = space > bestSpace;
+        }
+        if (better) {
+            best = dir;
+            bestSafe = safe;
+            bestCalm = calm;
+            bestDistance = distance;
+            bestSpace = space;
+        }
+    }
+    return best >= 0 ? quint8(best) : self.direction;
+}
+
+/**
+ * @brief 格子的相邻格子中是否有不比自己短的其他蛇的蛇头
+ * @param cell 格子序号
+ * @param snake 自己的序号
+ * @return 进入该格可能与对方蛇头相撞并死亡时返回true
+ */
+bool SnakeArena::isThreatened(int cell, int snake) const
+{
+    const int length = m_snakes.at(snake).length;
+    for (int dir = Up; dir <= Right; ++dir) {
+        const int n = neighbor(cell, dir);
+        const int owner = n < 0 ? -1 : m_owner.at(n);
+        if (owner < 0 || owner == snake) {
+            continue;
+        }
+        const ArenaSnake &other = m_snakes.at(owner);
+        if (other.body.at(other.head) == n && other.length >= length) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief 从格子出发做有上限的宽度优先搜索
+ * @param cell 起点（空闲格子）
+ * @param limit 搜索的格子数上限，不超过kLookahead
+ * @return 找到的空闲格子数（含起点），最多为limit
+ *
+ * 已访问的格子不超过kLookahead个，放在栈上的数组中线性查找，不需要与区域一样大的工作区，
+ * 多个线程可以同时调用。
+ */
+int SnakeArena::reach(int cell, int limit) const
+{
+    int queue[kLookahead];
+    int count = 0;
+    queue[count++] = cell;
+    for (int i = 0; i < count && count < limit; ++i) {
+        for (int dir = Up; dir <= Right && count < limit; ++dir) {
+            const int n = neighbor(queue[i], dir);
+            if (n < 0 || m_owner.at(n) >= 0) {
+                continue;
+            }
+            bool seen = false;
+            for (int k = 0; k < count && !seen; ++k) {
+                seen = queue[k] == n;
+            }
+            if (!seen) {
+                queue[count++] = n;
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 查找离格子最近的食物（曼哈顿距离，相同时取格子序号小的）
+ * @param cell 格子序号
+ * @return 食物格子，没有食物时返回-1
+ *
+ * 以格子所在的桶为中心一圈一圈向外查找：第r圈的桶中任何格子的距离都不小于(r-1)*桶边长+1，
+ * 已找到的食物比这更近时停止。默认密度下通常只需查看中心附近的几个桶，
+ * 与区域中的食物总数无关。
+ */
+int SnakeArena::nearestFood(int cell) const
+{
+    const int x = cell % m_width;
+    const int y = cell / m_width;
+    const int centerX = x >> kBucketShift;
+    const int centerY = y >> kBucketShift;
+    const int rings = qMax(m_bucketColumns, m_bucketRows);
+    int best = -1;
+    int bestDistance = INT_MAX;
+    auto scan = [&](int bx, int by) {
+        if (bx < 0 || bx >= m_bucketColumns || by < 0 || by >= m_bucketRows) {
+            return;
+        }
+        for (int food : m_buckets.at(by * m_bucketColumns + bx)) {
+            const int distance = qAbs(food % m_width - x) + qAbs(food / m_width - y);
+            if (distance < bestDistance || (distance == bestDistance && food < best)) {
+                best = food;
+                bestDistance = distance;
+            }
+        }
+    };
+    for (int r = 0; r < rings; ++r) {
+        if (best >= 0 && bestDistance <= (r - 1) * kBucketSize) {
+            break;
+        }
+        if (r == 0) {
+            scan(centerX, centerY);
+            continue;
+        }
+        for (int bx = centerX - r; bx <= centerX + r; ++bx) {
+            scan(bx, centerY - r);
+            scan(bx, centerY + r);
+        }
+        for (int by = centerY - r + 1; by < centerY + r; ++by) {
+            scan(centerX - r, by);
+            scan(centerX + r, by);
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief 在随机的空闲位置放置一条蛇
+ * @param snake 蛇的序号
+ * @return 成功放置返回true
+ *
+ * 从占用计数表的空闲格子集合中抽取蛇头位置，要求蛇头前方一格和身后两格都空闲；
+ * 落在蛇身上的食物会被移除。
+ */
+bool SnakeArena::spawn(int snake)
+{
+    for (int attempt = 0; attempt < kSpawnTries && m_occupancy.freeCount() > 0; ++attempt) {
+        const QPoint pos = m_occupancy.freeCell(int(m_random.bounded(quint32(m_occupancy.freeCount()))));
+        if (pos.x() < 2 || pos.x() + 1 >= m_width) {
+            continue;
+        }
+        const int head = pos.y() * m_width + pos.x();
+        if (m_owner[head - 2] >= 0 || m_owner[head - 1] >= 0 || m_owner[head + 1] >= 0) {
+            continue;
+        }
+
+        ArenaSnake &s = m_snakes[snake];
+        if (s.body.size() < 16) {
+            s.body.resize(16);
+        }
+        s.head = 0;
+        s.length = 0;
+        s.direction = Right;
+        s.grow = false;
+        s.alive = true;
+        s.dying = false;
+        s.score = 0;
+        s.respawn = 0;
+        m_next[snake] = Right;
+        m_targets[snake] = -1;
+        for (int i = 2; i >= 0; --i) {
+            if (m_isFood[head - i]) {
+                removeFood(head - i);
+            }
+            pushHead(snake, head - i);
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief 移除一条死亡的蛇
+ * @param snake 蛇的序号
+ *
+ * 蛇身从蛇头起每隔kDropEvery节留下一个食物，食物总数不超过格子数的八分之一。
+ */
+void SnakeArena::kill(int snake)
+{
+    ArenaSnake &s = m_snakes[snake];
+    const int mask = s.body.size() - 1;
+    for (int i = 0; i < s.length; ++i) {
+        const int cell = s.body.at((s.head + i) & mask);
+        m_occupancy.remove(toPoint(cell));
+        if (m_owner[cell] == snake) {
+            m_owner[cell] = -1;
+        }
+        if (i % kDropEvery == 0 && !m_isFood[cell] && m_foods.size() < m_cells / 8) {
+            addFood(cell);
+        }
+    }
+    s.length = 0;
+    s.alive = false;
+    s.dying = false;
+    s.grow = false;
+    s.score = 0;
+    s.respawn = kRespawnTicks;
+}
+
+/**
+ * @brief 在蛇头前写入一个格子
+ * @param snake 蛇的序号
+ * @param cell 新蛇头的格子
+ *
+ * 环形缓冲区已满时容量翻倍，并把蛇身按从头到尾的顺序重新排列到开头。
+ */
+void SnakeArena::pushHead(int snake, int cell)
+{
+    ArenaSnake &s = m_snakes[snake];
+    if (s.length == s.body.size()) {
+        QVector<int> body(s.body.size() * 2);
+        for (int i = 0; i < s.length; ++i) {
+            body[i] = s.body.at((s.head + i) & (s.body.size() - 1));
+        }
+        s.body.swap(body);
+        s.head = 0;
+    }
+    s.head = (s.head - 1) & (s.body.size() - 1);
+    s.body[s.head] = cell;
+    ++s.length;
+    m_occupancy.add(toPoint(cell));
+    m_owner[cell] = snake;
+}
+
+void SnakeArena::addFood(int cell)
+{
+    m_isFood[cell] = 1;
+    m_foodIndex[cell] = m_foods.size();
+    m_foods.append(cell);
+    QVector<int> &bucket = m_buckets[bucketOf(cell)];
+    m_bucketIndex[cell] = bucket.size();
+    bucket.append(cell);
+}
+
+void SnakeArena::removeFood(int cell)
+{
+    const int index = m_foodIndex[cell];
+    const int last = m_foods.last();
+    m_foods[index] = last;
+    m_foodIndex[last] = index;
+    m_foods.removeLast();
+    m_foodIndex[cell] = -1;
+    m_isFood[cell] = 0;
+
+    QVector<int> &bucket = m_buckets[bucketOf(cell)];
+    const int lastInBucket = bucket.last();
+    bucket[m_bucketIndex[cell]] = lastInBucket;
+    m_bucketIndex[lastInBucket] = m_bucketIndex[cell];
+    bucket.removeLast();
+}
+
+/**
+ * @brief 把食物补充到目标数量
+ *
+ * 从占用计数表的空闲格子集合中均匀抽取，已有食物的格子跳过；尝试次数有上限，
+ * 区域快被占满时下一步再补。
+ */
+void SnakeArena::refillFood()
+{
+    int tries = 4 * (m_foodTarget - m_foods.size());
+    while (m_foods.size() < m_foodTarget && tries-- > 0 && m_occupancy.freeCount() > 0) {
+        const QPoint pos = m_occupancy.freeCell(int(m_random.bounded(quint32(m_occupancy.freeCount()))));
+        const int cell = pos.y() * m_width + pos.x();
+        if (!m_isFood[cell]) {
+            addFood(cell);
+        }
+    }
+}
+
+int SnakeArena::bucketOf(int cell) const
+{
+    return ((cell / m_width) >> kBucketShift) * m_bucketColumns + ((cell % m_width) >> kBucketShift);
+}
+
+QPoint SnakeArena::toPoint(int cell) const
+{
+    return QPoint(cell % m_width, cell / m_width);
+}
+
+/**
+ * @brief 获取相邻格子
+ * @param cell 格子序号
+ * @param dir 方向
+ * @return 相邻格子的序号，超出区域时返回-1
+ */
+int SnakeArena::neighbor(int cell, int dir) const
+{
+    const int x = cell % m_width + directionDx(dir);
+    const int y = cell / m_width + directionDy(dir);
+    return x >= 0 && x < m_width && y >= 0 && y < m_height ? y * m_width + x : -1;
+}
@@ -0,0 +1,156 @@
+#ifndef SNAKEARENA_H
+#define SNAKEARENA_H
+
+#include <QPoint>
+#include <QRandomGenerator>
+#include <QSize>
+#include <QVector>
+#include "occupancygrid.h"
+#include "snake.h"
+#include "workstealingpool.h"
+
+/**
+ * @brief SnakeArena类在同一块大区域上同时推进数百条由AI控制的蛇
+ *
+ * 所有蛇共用一张占用计数表（OccupancyGrid），另有一张“格子属于哪条蛇”的归属表用于绘制
+ * 和判断对方蛇头。区域中同时有多个食物，吃到食物的蛇增长一节。每一步分两个阶段：
+ *   1. 决策：每条蛇只读取上一步结束时的共享状态，选出自己的方向，结果写入自己的槽位，
+ *      因此可以在任务窃取线程池上按蛇分块并行，结果与线程数无关；
+ *   2. 结算（串行，按蛇的序号）：先让出所有不增长的蛇尾，再检查新蛇头——撞墙、撞到任意
+ *      蛇身的死亡；几个蛇头进入同一格时只有最长的一条存活，一样长则都死亡。
+ *      死亡的蛇身每隔一节变为食物，蛇在若干步后在随机的空闲位置重生。
+ * 两个阶段的耗时分别记录，用于观察蛇的数量增加时每步耗时的变化。
+ */
+class SnakeArena
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param snakeCount 蛇的数量
+     * @param width 区域宽度（格子数），至少为8
+     * @param height 区域高度（格子数），至少为8
+     * @param seed 随机数种子（决定重生位置和食物位置）
+     */
+    SnakeArena(int snakeCount, int width, int height, quint32 seed = 0);
+
+    /**
+     * @brief 按蛇的数量给出默认的区域大小（每条蛇约256格）
+     */
+    static QSize defaultFieldSize(int snakeCount);
+
+    /**
+     * @brief 设置决策阶段使用的线程池
+     * @param pool 线程池，为nullptr时在调用线程串行决策；由调用者持有
+     */
+    void setThreadPool(WorkStealingPool *pool);
+
+    /**
+     * @brief 用新的种子清空区域，重新放置所有蛇和食物
+     * @param seed 随机数种子
+     */
+    void reset(quint32 seed);
+
+    /**
+     * @brief 所有蛇同步推进一步（并行决策，串行结算）
+     */
+    void step();
+
+    int snakeCount() const;
+    int width() const;
+    int height() const;
+    const OccupancyGrid &occupancy() const;
+
+    /**
+     * @brief 获取占用格子的蛇
+     * @param pos 格子坐标
+     * @return 蛇的序号，空格子或区域外时返回-1
+     */
+    int ownerAt(const QPoint &pos) const;
+    bool isFood(const QPoint &pos) const;
+    int foodCount() const;
+    QPoint foodAt(int index) const;
+
+    bool isAlive(int snake) const;
+    QPoint head(int snake) const;
+    int length(int snake) const;
+    int score(int snake) const;
+
+    int aliveCount() const;
+    quint64 tickCount() const;
+    quint64 headOnDeaths() const;   // 累计因蛇头相撞死亡的次数
+    quint64 bodyDeaths() const;     // 累计因撞到蛇身死亡的次数
+    quint64 wallDeaths() const;     // 累计因撞墙死亡的次数
+    qint64 lastThinkNs() const;     // 最近一步决策阶段的耗时（纳秒）
+    qint64 lastResolveNs() const;   // 最近一步结算阶段的耗时（纳秒）
+
+private:
+    // 一条蛇的状态，蛇身为容量为2的幂的环形缓冲区（格子序号），与Snake相同
+    struct ArenaSnake {
+        QVector<int> body;          // 蛇身环形缓冲区
+        int head = 0;               // 蛇头在缓冲区中的位置
+        int length = 0;             // 长度，0表示不在区域中
+        quint8 direction = Right;   // 当前方向
+        bool grow = false;          // 下一步是否增长
+        bool alive = false;         // 是否存活
+        bool dying = false;         // 结算阶段已判定死亡
+        int respawn = 0;            // 距离重生的剩余步数
+        int score = 0;              // 存活期间的分数
+        int newHead = -1;           // 结算阶段的新蛇头格子，撞墙时为-1
+    };
+
+    // 为一条蛇选择方向，只读共享状态，target为追逐的食物格子（读写）
+    quint8 think(int snake, int &target) const;
+    // 格子的相邻格子中是否有不比自己短的其他蛇的蛇头
+    bool isThreatened(int cell, int snake) const;
+    // 从格子出发最多搜索limit个空闲格子，返回找到的个数
+    int reach(int cell, int limit) const;
+    // 离格子最近的食物（按桶由近到远查找），没有食物时返回-1
+    int nearestFood(int cell) const;
+    // 格子所在的食物桶
+    int bucketOf(int cell) const;
+    // 在随机的空闲位置放置一条长度为3、向右移动的蛇，找不到位置时返回false
+    bool spawn(int snake);
+    // 移除一条死亡的蛇，每隔一节留下一个食物
+    void kill(int snake);
+    void pushHead(int snake, int cell);
+    void addFood(int cell);
+    void removeFood(int cell);
+    // 把食物补充到目标数量
+    void refillFood();
+
+    QPoint toPoint(int cell) const;
+    // 相邻格子，超出区域时返回-1
+    int neighbor(int cell, int dir) const;
+
+private:
+    int m_width;                    // 区域宽度
+    int m_height;                   // 区域高度
+    int m_cells;                    // 格子数
+    int m_foodTarget;               // 区域中保持的食物数量
+    WorkStealingPool *m_pool;       // 线程池（可为nullptr）
+    QRandomGenerator m_random;      // 重生和食物的随机数（只在串行阶段使用）
+
+    QVector<ArenaSnake> m_snakes;   // 所有的蛇
+    QVector<quint8> m_next;         // 决策阶段每条蛇选出的方向
+    QVector<int> m_targets;         // 每条蛇追逐的食物格子，-1为无
+    OccupancyGrid m_occupancy;      // 所有蛇共用的占用计数表
+    QVector<int> m_owner;           // 每个格子所属的蛇，-1为无
+    QVector<quint8> m_isFood;       // 每个格子是否有食物
+    QVector<int> m_foods;           // 食物格子的集合
+    QVector<int> m_foodIndex;       // 格子在食物集合中的下标，-1为无
+    int m_bucketColumns;            // 横向的食物分桶数
+    int m_bucketRows;               // 纵向的食物分桶数
+    QVector<QVector<int>> m_buckets; // 按区域分桶的食物格子，用于查找最近的食物
+    QVector<int> m_bucketIndex;     // 格子在所在桶中的下标
+    QVector<int> m_claimLength;     // 结算时进入该格的最长蛇的长度
+    QVector<quint8> m_claimCount;   // 结算时以最长长度进入该格的蛇数
+
+    quint64 m_ticks;                // 已推进的步数
+    quint64 m_headOnDeaths;         // 蛇头相撞死亡次数
+    quint64 m_bodyDeaths;           // 撞到蛇身死亡次数
+    quint64 m_wallDeaths;           // 撞墙死亡次数
+    qint64 m_lastThinkNs;           // 最近一步决策耗时
+    qint64 m_lastResolveNs;         // 最近一步结算耗时
+};
+
+#endif // SNAKEARENA_H
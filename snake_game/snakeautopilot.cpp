@@ -0,0 +1,615 @@
+#include "snakeautopilot.h"
+#include "snakeboard.h"
+#include <QElapsedTimer>
+#include <QtAlgorithms>
+#include <algorithm>
+
+namespace {
+// 路径不安全后，等待这么多步再重新寻路（期间蛇尾会让出格子）
+const int kRetryInterval = 8;
+// 哈密顿回路安全检查的余量：一次尚未生效的增长，加上途中可能再吃到的一个食物
+const int kCycleMargin = 2;
+
+using SnakeBits::shiftedWord;
+using SnakeBits::testBit;
+using SnakeBits::setBit;
+using SnakeBits::clearBit;
+}
+
+SnakeAutopilot::SnakeAutopilot()
+    : m_width(0)
+    , m_height(0)
+    , m_cells(0)
+    , m_words(0)
+    , m_cycleAxis(0)
+    , m_fieldBase(1)
+    , m_fieldEnd(1)
+    , m_lastMode(PathToFood)
+    , m_lastReused(false)
+    , m_lastPlanNs(0)
+    , m_maxPlanNs(0)
+    , m_totalPlanNs(0)
+    , m_planCount(0)
+{
+    reset();
+}
+
+/**
+ * @brief 清除缓存的位棋盘和距离场
+ */
+void SnakeAutopilot::reset()
+{
+    m_synced = false;
+    m_fieldFood = -1;
+    m_expectedHead = -1;
+    m_retryTicks = 0;
+    m_retryFood = -1;
+}
+
+/**
+ * @brief 为引擎的当前状态选择下一步的方向
+ * @param engine 游戏引擎
+ * @return 下一步的方向
+ *
+ * 依次尝试：沿用距离场、重新寻路并检查安全、哈密顿回路、追蛇尾、最大可达区域。
+ */
+Direction SnakeAutopilot::plan(const SnakeEngine &engine)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    syncBits(engine);
+    const Snake &snake = engine.snake();
+    const int head = m_head;
+    const QPoint foodPos = engine.food();
+    const int food = foodPos.y() * m_width + foodPos.x();
+
+    // 食物没变且上一步沿距离场前进，距离场仍然有效
+    int next = -1;
+    m_lastReused = false;
+    if (m_fieldFood == food && head == m_expectedHead) {
+        next = descend(head);
+        m_lastReused = next >= 0;
+    }
+
+    if (next < 0) {
+        m_fieldFood = -1;
+        if (food != m_retryFood) {
+            m_retryTicks = 0;
+        }
+        if (m_retryTicks > 0) {
+            --m_retryTicks;
+        } else if (buildDistanceField(food, head) > 0 && isPathSafe(snake, head)) {
+            m_fieldFood = food;
+            next = descend(head);
+        } else {
+            m_retryTicks = kRetryInterval;
+            m_retryFood = food;
+        }
+    }
+
+    if (next >= 0) {
+        m_lastMode = PathToFood;
+        m_expectedHead = next;
+    } else {
+        m_expectedHead = -1;
+        m_lastMode = CycleShortcut;
+        next = m_cycleAxis != 0 ? cycleStep(snake, head, food) : -1;
+        if (next < 0) {
+            m_lastMode = FollowTail;
+            next = tailStep(head);
+        }
+        if (next < 0) {
+            m_lastMode = Survive;
+            next = surviveStep(head);
+        }
+    }
+
+    Direction dir = Up;
+    if (next >= 0) {
+        if (next == head - m_width) {
+            dir = Up;
+        } else if (next == head + m_width) {
+            dir = Down;
+        } else if (next == head - 1) {
+            dir = Left;
+        } else {
+            dir = Right;
+        }
+    }
+
+    m_lastPlanNs = timer.nsecsElapsed();
+    m_maxPlanNs = qMax(m_maxPlanNs, m_lastPlanNs);
+    m_totalPlanNs += m_lastPlanNs;
+    ++m_planCount;
+    return dir;
+}
+
+SnakeAutopilot::Mode SnakeAutopilot::lastMode() const
+{
+    return m_lastMode;
+}
+
+bool SnakeAutopilot::lastReusedField() const
+{
+    return m_lastReused;
+}
+
+qint64 SnakeAutopilot::lastPlanNs() const
+{
+    return m_lastPlanNs;
+}
+
+qint64 SnakeAutopilot::maxPlanNs() const
+{
+    return m_maxPlanNs;
+}
+
+double SnakeAutopilot::averagePlanNs() const
+{
+    return m_planCount > 0 ? double(m_totalPlanNs) / m_planCount : 0.0;
+}
+
+/**
+ * @brief 区域大小变化时重建掩码和距离场
+ * @param width 区域宽度
+ * @param height 区域高度
+ */
+void SnakeAutopilot::resize(int width, int height)
+{
+    m_width = width;
+    m_height = height;
+    m_cells = width * height;
+    m_words = (m_cells + 63) / 64;
+
+    // 哈密顿回路需要一条边为偶数
+    m_cycleAxis = height % 2 == 0 ? 1 : (width % 2 == 0 ? 2 : 0);
+
+    m_bits.fill(0, m_words);
+    m_notFirstColumn.fill(0, m_words);
+    m_notLastColumn.fill(0, m_words);
+    m_valid.fill(0, m_words);
+    m_passable.fill(0, m_words);
+    m_visited.fill(0, m_words);
+    m_frontier.fill(0, m_words);
+    m_next.fill(0, m_words);
+    for (int cell = 0; cell < m_cells; ++cell) {
+        int x = cell % m_width;
+        setBit(m_valid.data(), cell);
+        if (x != 0) {
+            setBit(m_notFirstColumn.data(), cell);
+        }
+        if (x != m_width - 1) {
+            setBit(m_notLastColumn.data(), cell);
+        }
+    }
+
+    m_distance.fill(0, m_cells);
+    m_fieldBase = 1;
+    m_fieldEnd = 1;
+    reset();
+}
+
+/**
+ * @brief 同步位棋盘
+ * @param engine 游戏引擎
+ *
+ * 引擎只推进了一步时，蛇头所在的格子置位，旧蛇尾不再被占用时清零，O(1)；
+ * 否则（第一次规划、重开、跳过了步数）按蛇身重建。
+ */
+void SnakeAutopilot::syncBits(const SnakeEngine &engine)
+{
+    if (engine.width() != m_width || engine.height() != m_height) {
+        resize(engine.width(), engine.height());
+    }
+
+    const Snake &snake = engine.snake();
+    const QPoint headPos = snake.getHeadPosition();
+    const QPoint tailPos = snake.getTailPosition();
+    const int head = headPos.y() * m_width + headPos.x();
+    const int tail = tailPos.y() * m_width + tailPos.x();
+
+    if (m_synced && engine.seed() == m_seed && engine.tickCount() == m_tick) {
+        return;
+    }
+
+    const int distance = qAbs(head - m_head);
+    if (m_synced && engine.seed() == m_seed && engine.tickCount() == m_tick + 1
+            && (distance == 1 || distance == m_width)) {
+        setBit(m_bits.data(), head);
+        if (!snake.isOccupied(QPoint(m_tail % m_width, m_tail / m_width))) {
+            clearBit(m_bits.data(), m_tail);
+        }
+    } else {
+        std::fill(m_bits.begin(), m_bits.end(), 0);
+        quint64 *bits = m_bits.data();
+        const int width = m_width;
+        snake.forEachSegment([bits, width](int, const QPoint &pos) {
+            setBit(bits, pos.y() * width + pos.x());
+        });
+        m_fieldFood = -1;
+        m_expectedHead = -1;
+        m_retryTicks = 0;
+    }
+
+    m_tick = engine.tickCount();
+    m_seed = engine.seed();
+    m_head = head;
+    m_tail = tail;
+    m_synced = true;
+}
+
+/**
+ * @brief 从食物出发计算距离场
+ * @param food 食物格子
+ * @param head 蛇头格子
+ * @return 蛇头到食物的步数，到达不了时返回-1
+ *
+ * 蛇身视为障碍（蛇头除外），搜索到蛇头所在的层就停止。
+ */
+int SnakeAutopilot::buildDistanceField(int food, int head)
+{
+    for (int w = 0; w < m_words; ++w) {
+        m_passable[w] = ~m_bits.at(w);
+    }
+    setBit(m_passable.data(), head);
+    return search(m_passable.constData(), food, head, true);
+}
+
+/**
+ * @brief 检查沿距离场吃到食物后是否安全
+ * @param snake 蛇
+ * @param head 蛇头格子
+ * @return 吃到食物后蛇头仍能到达蛇尾时返回true
+ *
+ * 构造走完整条路径后的虚拟蛇：路径上的最后length格成为新的蛇身，
+ * 旧蛇身的最后min(路径长度, length)节被让出，然后在位棋盘上搜索新蛇头到新蛇尾。
+ */
+bool SnakeAutopilot::isPathSafe(const Snake &snake, int head)
+{
+    m_path.clear();
+    for (int cell = descend(head); cell >= 0; cell = descend(cell)) {
+        m_path.append(cell);
+        if (m_distance.at(cell) == m_fieldBase) {
+            break;  // 到达食物
+        }
+    }
+    if (m_path.isEmpty()) {
+        return false;
+    }
+
+    const int steps = m_path.size();
+    const int length = snake.length();
+    const int moved = qMin(steps, length);
+
+    // 虚拟蛇的占用：先让出旧蛇尾，再占用路径的最后一段
+    quint64 *virtualBits = m_passable.data();
+    std::copy(m_bits.constBegin(), m_bits.constEnd(), virtualBits);
+    int virtualTail = -1;
+    const int width = m_width;
+    snake.forEachSegment([&](int index, const QPoint &pos) {
+        int cell = pos.y() * width + pos.x();
+        if (index >= length - moved) {
+            clearBit(virtualBits, cell);
+        } else if (index == length - moved - 1) {
+            virtualTail = cell;
+        }
+    });
+    for (int i = steps - moved; i < steps; ++i) {
+        setBit(virtualBits, m_path.at(i));
+    }
+    if (virtualTail < 0) {
+        virtualTail = m_path.at(steps - length);
+    }
+
+    // 新蛇头（食物）能否到达新蛇尾
+    for (int w = 0; w < m_words; ++w) {
+        virtualBits[w] = ~virtualBits[w];
+    }
+    setBit(virtualBits, virtualTail);
+    return search(virtualBits, m_path.last(), virtualTail, false) >= 0;
+}
+
+/**
+ * @brief 沿距离场下降一步
+ * @param cell 当前格子
+ * @return 距离小1且未被占用的相邻格子，没有时返回-1
+ */
+int SnakeAutopilot::descend(int cell) const
+{
+    const quint32 value = m_distance.at(cell);
+    if (value <= m_fieldBase || value >= m_fieldEnd) {
+        return -1;
+    }
+    for (int dir = Up; dir <= Right; ++dir) {
+        int next = neighbor(cell, dir);
+        if (next >= 0 && m_distance.at(next) == value - 1 && !testBit(m_bits.constData(), next)) {
+            return next;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief 哈密顿回路模式下选择下一格
+ * @param snake 蛇
+ * @param head 蛇头格子
+ * @param food 食物格子
+ * @return 下一格，没有安全的格子时返回-1
+ *
+ * 候选格子为回路上的下一格，以及（蛇不超过区域一半时）其他相邻的格子。
+ * 假设此后一直沿回路前进，回路前方第j格会在j+1步后到达；蛇身倒数第k节会在k步后让出，
+ * 每节都满足“让出不晚于到达”（加上余量）时这个候选才是安全的。
+ * 安全的候选中选择沿回路离食物最近的一个。
+ */
+int SnakeAutopilot::cycleStep(const Snake &snake, int head, int food)
+{
+    const int length = snake.length();
+    const int headIndex = cycleIndex(head);
+    const int successor = cycleCell((headIndex + 1) % m_cells);
+    const bool shortcuts = length * 2 < m_cells;
+    const int foodIndex = cycleIndex(food);
+    const int width = m_width;
+
+    int best = -1;
+    int bestDistance = m_cells;
+    for (int dir = Up; dir <= Right; ++dir) {
+        int next = neighbor(head, dir);
+        if (next < 0 || (next != successor && !shortcuts)) {
+            continue;
+        }
+        if (testBit(m_bits.constData(), next) && next != m_tail) {
+            continue;
+        }
+
+        const int nextIndex = cycleIndex(next);
+        bool safe = true;
+        snake.forEachSegment([&](int index, const QPoint &pos) {
+            if (safe) {
+                int ahead = cycleIndex(pos.y() * width + pos.x()) - nextIndex;
+                if (ahead < 0) {
+                    ahead += m_cells;
+                }
+                safe = length - index + kCycleMargin <= ahead + 1;
+            }
+        });
+        if (!safe) {
+            continue;
+        }
+
+        int distance = foodIndex - nextIndex;
+        if (distance < 0) {
+            distance += m_cells;
+        }
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = next;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief 选择能到达蛇尾、且离蛇尾最远的相邻格子
+ * @param head 蛇头格子
+ * @return 相邻的空闲格子，都到达不了蛇尾时返回-1
+ *
+ * 从蛇尾出发搜索一次，借用距离场记录到蛇尾的距离（此时到食物的距离场已经失效）。
+ * 绕远路追着蛇尾走可以拖延时间，等蛇尾让出通向食物的格子。
+ */
+int SnakeAutopilot::tailStep(int head)
+{
+    for (int w = 0; w < m_words; ++w) {
+        m_passable[w] = ~m_bits.at(w);
+    }
+    m_fieldFood = -1;
+    search(m_passable.constData(), m_tail, -1, true);
+
+    int best = -1;
+    quint32 bestDistance = 0;
+    for (int dir = Up; dir <= Right; ++dir) {
+        int next = neighbor(head, dir);
+        if (next < 0 || testBit(m_bits.constData(), next)) {
+            continue;
+        }
+        const quint32 value = m_distance.at(next);
+        if (value >= m_fieldBase && value < m_fieldEnd && (best < 0 || value > bestDistance)) {
+            bestDistance = value;
+            best = next;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief 选择可达区域最大的相邻格子
+ * @param head 蛇头格子
+ * @return 相邻的空闲格子，没有时返回-1
+ */
+int SnakeAutopilot::surviveStep(int head)
+{
+    for (int w = 0; w < m_words; ++w) {
+        m_passable[w] = ~m_bits.at(w);
+    }
+
+    int best = -1;
+    int bestArea = -1;
+    for (int dir = Up; dir <= Right; ++dir) {
+        int next = neighbor(head, dir);
+        if (next < 0 || testBit(m_bits.constData(), next)) {
+            continue;
+        }
+        int area = search(m_passable.constData(), next, -1, false);
+        if (area > bestArea) {
+            bestArea = area;
+            best = next;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief 在位棋盘上做宽度优先搜索
+ *
+ * 每一层用移位和列掩码一次算出整层的相邻格子（每字64格），只处理当前层所在的字
+ * 以及上下各一行的范围，开销与搜索到的区域大小成正比，与区域总大小无关。
+ */
+int SnakeAutopilot::search(const quint64 *passable, int source, int target, bool recordDistance)
+{
+    quint64 *visited = m_visited.data();
+    quint64 *frontier = m_frontier.data();
+    quint64 *next = m_next.data();
+    const quint64 *valid = m_valid.constData();
+    const quint64 *notFirst = m_notFirstColumn.constData();
+    const quint64 *notLast = m_notLastColumn.constData();
+    const int reach = m_width / 64 + 1;  // 一层最多向两边扩展的字数
+
+    // 距离场的基准值单调增加，旧的值自动失效；快要溢出时整体清零
+    if (recordDistance) {
+        if (m_fieldEnd > 0xF0000000u) {
+            std::fill(m_distance.begin(), m_distance.end(), 0u);
+            m_fieldEnd = 1;
+        }
+        m_fieldBase = m_fieldEnd;
+        m_distance[source] = m_fieldBase;
+    }
+    setBit(visited, source);
+    setBit(frontier, source);
+    int low = source >> 6;
+    int high = low;
+    int touchedLow = low;
+    int touchedHigh = high;
+    int count = 1;
+    int layer = 0;
+    int result = source == target ? 0 : -1;
+
+    while (result < 0) {
+        ++layer;
+        const int from = qMax(0, low - reach);
+        const int to = qMin(m_words - 1, high + reach);
+        int nextLow = m_words;
+        int nextHigh = -1;
+        for (int w = from; w <= to; ++w) {
+            quint64 spread = (shiftedWord(frontier, m_words, w, 1) & notFirst[w])
+                           | (shiftedWord(frontier, m_words, w, -1) & notLast[w])
+                           | shiftedWord(frontier, m_words, w, m_width)
+                           | shiftedWord(frontier, m_words, w, -m_width);
+            spread &= passable[w] & valid[w] & ~visited[w];
+            next[w] = spread;
+            if (!spread) {
+                continue;
+            }
+            visited[w] |= spread;
+            nextLow = qMin(nextLow, w);
+            nextHigh = w;
+            count += int(qPopulationCount(spread));
+            if (recordDistance) {
+                for (quint64 bits = spread; bits; bits &= bits - 1) {
+                    m_distance[w * 64 + int(qCountTrailingZeroBits(bits))] = m_fieldBase + quint32(layer);
+                }
+            }
+            if (target >= 0 && (target >> 6) == w && testBit(next, target)) {
+                result = layer;
+            }
+        }
+
+        // 当前层清零后与下一层交换
+        std::fill(frontier + low, frontier + high + 1, 0);
+        std::swap(frontier, next);
+        if (nextHigh < 0) {
+            break;  // 没有新的格子，搜索结束
+        }
+        low = nextLow;
+        high = nextHigh;
+        touchedLow = qMin(touchedLow, low);
+        touchedHigh = qMax(touchedHigh, high);
+    }
+
+    // 恢复为全零，下一次搜索只需要清理用过的范围
+    std::fill(frontier + low, frontier + high + 1, 0);
+    std::fill(visited + touchedLow, visited + touchedHigh + 1, 0);
+    if (recordDistance) {
+        m_fieldEnd = m_fieldBase + quint32(layer) + 1;
+    }
+    if (target < 0) {
+        return count;
+    }
+    return result;
+}
+
+/**
+ * @brief 获取相邻格子
+ * @param cell 格子序号
+ * @param dir 方向（Direction的取值）
+ * @return 相邻格子的序号，超出区域时返回-1
+ */
+int SnakeAutopilot::neighbor(int cell, int dir) const
+{
+    const int x = cell % m_width + directionDx(dir);
+    const int y = cell / m_width + directionDy(dir);
+    return x >= 0 && x < m_width && y >= 0 && y * m_width < m_cells ? y * m_width + x : -1;
+}
+
+/**
+ * @brief 获取格子在哈密顿回路中的序号
+ * @param cell 格子序号
+ * @return 回路序号
+ *
+ * 回路（高度为偶数时）：第0行从左到右，然后在第1列到最后一列之间逐行往返，
+ * 最后一行结束于第1列，再沿第0列向上回到起点。宽度为偶数时按转置后的区域计算。
+ */
+int SnakeAutopilot::cycleIndex(int cell) const
+{
+    int x = cell % m_width;
+    int y = cell / m_width;
+    int width = m_width;
+    int height = m_height;
+    if (m_cycleAxis == 2) {
+        std::swap(x, y);
+        std::swap(width, height);
+    }
+
+    if (y == 0) {
+        return x;
+    }
+    if (x == 0) {
+        return width + (height - 1) * (width - 1) + (height - 1 - y);
+    }
+    const int base = width + (y - 1) * (width - 1);
+    return y % 2 == 1 ? base + (width - 1 - x) : base + (x - 1);
+}
+
+/**
+ * @brief 获取哈密顿回路序号对应的格子
+ * @param index 回路序号
+ * @return 格子序号
+ */
+int SnakeAutopilot::cycleCell(int index) const
+{
+    int width = m_width;
+    int height = m_height;
+    if (m_cycleAxis == 2) {
+        std::swap(width, height);
+    }
+
+    int x;
+    int y;
+    const int rowsEnd = width + (height - 1) * (width - 1);
+    if (index < width) {
+        x = index;
+        y = 0;
+    } else if (index >= rowsEnd) {
+        x = 0;
+        y = height - 1 - (index - rowsEnd);
+    } else {
+        const int offset = index - width;
+        y = 1 + offset / (width - 1);
+        const int column = offset % (width - 1);
+        x = y % 2 == 1 ? width - 1 - column : column + 1;
+    }
+
+    if (m_cycleAxis == 2) {
+        std::swap(x, y);
+    }
+    return y * m_width + x;
+}
@@ -0,0 +1,127 @@
+#ifndef SNAKEAUTOPILOT_H
+#define SNAKEAUTOPILOT_H
+
+#include <QVector>
+#include "snakeengine.h"
+
+/**
+ * @brief SnakeAutopilot类为SnakeEngine自动选择每一步的方向
+ *
+ * 用于演示和长时间压力测试引擎。规划都在自己维护的位棋盘上进行（每格1位），
+ * 每步只按蛇头和蛇尾的变化增量更新，不逐格扫描占用计数表：
+ *   1. 从食物出发在空闲格子上做位棋盘BFS，一层一层扩展直到碰到蛇头，得到到食物的距离场；
+ *      沿距离场走到食物后，用“虚拟蛇”检查蛇头还能否到达蛇尾，能到达才采用这条路径。
+ *      食物不变且蛇头一直沿距离场下降时，距离场在后续各步中继续有效（蛇身只会从蛇尾让出格子，
+ *      蛇头经过的格子都在身后），不重新搜索。
+ *   2. 路径不安全时，沿区域的哈密顿回路前进，并在确认回路前方的蛇身都会及时让出时
+ *      抄近路靠近食物；区域宽高都是奇数时没有哈密顿回路。
+ *   3. 回路上也没有安全的走法时，追着蛇尾绕远路，等蛇尾让出通向食物的格子；
+ *   4. 以上都不可行时，选择能到达的空闲格子最多的方向。
+ * 每次规划的耗时都会记录下来，用于界面显示和性能分析。
+ */
+class SnakeAutopilot
+{
+public:
+    // 最近一次规划采用的方式
+    enum Mode {
+        PathToFood,     // 沿最短路径走向食物
+        CycleShortcut,  // 沿哈密顿回路（可能抄近路）
+        FollowTail,     // 追着蛇尾走，等待通向食物的路径变安全
+        Survive         // 选择可达区域最大的方向
+    };
+
+    SnakeAutopilot();
+
+    /**
+     * @brief 清除缓存的位棋盘和距离场，下一次规划时重建
+     */
+    void reset();
+
+    /**
+     * @brief 为引擎的当前状态选择下一步的方向
+     * @param engine 游戏引擎，两次调用之间通常只推进了一步
+     * @return 下一步的方向
+     */
+    Direction plan(const SnakeEngine &engine);
+
+    Mode lastMode() const;
+    bool lastReusedField() const;   // 最近一次规划是否沿用了之前的距离场
+    qint64 lastPlanNs() const;      // 最近一次规划的耗时（纳秒）
+    qint64 maxPlanNs() const;       // 单次规划的最大耗时（纳秒）
+    double averagePlanNs() const;   // 平均规划耗时（纳秒）
+
+private:
+    // 区域大小变化时重建掩码和距离场
+    void resize(int width, int height);
+    // 按蛇的当前状态同步位棋盘（能增量更新时只改蛇头和蛇尾）
+    void syncBits(const SnakeEngine &engine);
+    // 从食物出发计算距离场，返回蛇头的距离，到达不了时返回-1
+    int buildDistanceField(int food, int head);
+    // 沿距离场从蛇头走到食物，检查吃到食物后蛇头能否到达蛇尾
+    bool isPathSafe(const Snake &snake, int head);
+    // 沿距离场下降一步，没有合适的格子时返回-1
+    int descend(int cell) const;
+    // 哈密顿回路模式下选择下一格，没有安全的格子时返回-1
+    int cycleStep(const Snake &snake, int head, int food);
+    // 选择能到达蛇尾且离蛇尾最远的相邻格子，都到达不了时返回-1
+    int tailStep(int head);
+    // 选择可达区域最大的相邻格子，没有空闲的相邻格子时返回-1
+    int surviveStep(int head);
+
+    /**
+     * @brief 在位棋盘上做宽度优先搜索
+     * @param passable 可以进入的格子
+     * @param source 起点（不要求可进入）
+     * @param target 终点，为-1时搜索整个连通区域
+     * @param recordDistance 是否把每个格子所在的层数写入距离场
+     * @return 终点所在的层数；到达不了时返回-1，target为-1时返回可达的格子数
+     */
+    int search(const quint64 *passable, int source, int target, bool recordDistance);
+
+    // 相邻格子，超出区域时返回-1
+    int neighbor(int cell, int dir) const;
+    // 哈密顿回路中格子的序号和序号对应的格子
+    int cycleIndex(int cell) const;
+    int cycleCell(int index) const;
+
+private:
+    int m_width;                    // 区域宽度
+    int m_height;                   // 区域高度
+    int m_cells;                    // 格子数
+    int m_words;                    // 位棋盘字数
+    int m_cycleAxis;                // 0:无哈密顿回路 1:按行往返 2:按列往返（转置）
+
+    QVector<quint64> m_bits;        // 蛇身占用位棋盘
+    QVector<quint64> m_notFirstColumn; // 不在第0列的格子
+    QVector<quint64> m_notLastColumn;  // 不在最后一列的格子
+    QVector<quint64> m_valid;       // 区域内的格子
+    QVector<quint64> m_passable;    // 搜索用的可进入格子
+    QVector<quint64> m_visited;     // 搜索已访问的格子
+    QVector<quint64> m_frontier;    // 搜索当前层
+    QVector<quint64> m_next;        // 搜索下一层
+
+    // 距离场：值减去m_fieldBase即为到食物的步数，小于m_fieldBase表示本次搜索未到达
+    QVector<quint32> m_distance;
+    quint32 m_fieldBase;            // 当前距离场的基准值
+    quint32 m_fieldEnd;             // 当前距离场用到的最大值加一
+    int m_fieldFood;                // 距离场对应的食物格子，-1表示无效
+    int m_expectedHead;             // 沿距离场前进时下一次规划预期的蛇头格子
+
+    quint64 m_tick;                 // 同步位棋盘时引擎的步数
+    quint32 m_seed;                 // 同步位棋盘时引擎的种子
+    int m_head;                     // 同步时的蛇头格子
+    int m_tail;                     // 同步时的蛇尾格子
+    bool m_synced;                  // 位棋盘是否与引擎一致
+    int m_retryTicks;               // 路径不安全后再次尝试寻路前的剩余步数
+    int m_retryFood;                // 路径不安全时的食物格子
+    QVector<int> m_path;            // 安全检查用的路径（从蛇头的下一格到食物）
+
+    Mode m_lastMode;                // 最近一次规划的方式
+    bool m_lastReused;              // 最近一次是否沿用距离场
+    qint64 m_lastPlanNs;            // 最近一次规划耗时
+    qint64 m_maxPlanNs;             // 最大规划耗时
+    qint64 m_totalPlanNs;           // 累计规划耗时
+    quint64 m_planCount;            // 规划次数
+};
+
+#endif // SNAKEAUTOPILOT_H
@@ -0,0 +1,375 @@
+#include "snakebatch.h"
+#include <QtAlgorithms>
+#include <algorithm>
+
+namespace {
+// 每个食物的分数（与SnakeEngine一致）
+const int kFoodScore = 10;
+// 放置食物时先随机尝试的次数，都落在蛇身上时再按位棋盘精确抽取
+const int kFoodTries = 4;
+
+// 由种子和棋盘序号派生出互不相关的随机数状态（splitmix64）
+quint64 deriveState(quint32 seed, int board)
+{
+    quint64 z = (quint64(seed) << 32 | quint32(board)) + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return z ? z : 0x9E3779B97F4A7C15ULL;  // xorshift的状态不能为0
+}
+}
+
+/**
+ * @brief 构造函数
+ * @param boardCount 棋盘数量
+ * @param width 区域宽度（格子数）
+ * @param height 区域高度（格子数）
+ * @param seed 随机数种子
+ */
+SnakeBatch::SnakeBatch(int boardCount, int width, int height, quint32 seed)
+    : m_boardCount(qMax(0, boardCount))
+    , m_width(qMax(4, width))
+    , m_height(qMax(4, height))
+    , m_seed(seed)
+    , m_pool(nullptr)
+    , m_steps(0)
+{
+    m_cells = m_width * m_height;
+    m_words = (m_cells + 63) / 64;
+
+    m_bits.resize(m_boardCount * m_words);
+    m_observations.resize(m_boardCount * m_cells);
+    m_bodies.resize(m_boardCount * m_cells);
+    m_headIndex.resize(m_boardCount);
+    m_length.resize(m_boardCount);
+    m_direction.resize(m_boardCount);
+    m_grow.resize(m_boardCount);
+    m_food.resize(m_boardCount);
+    m_score.resize(m_boardCount);
+    m_lastScore.resize(m_boardCount);
+    m_episodes.resize(m_boardCount);
+    m_random.resize(m_boardCount);
+    m_rewards.resize(m_boardCount);
+    m_dones.resize(m_boardCount);
+
+    reset(seed);
+}
+
+void SnakeBatch::setThreadPool(WorkStealingPool *pool)
+{
+    m_pool = pool;
+}
+
+/**
+ * @brief 用新的种子重开所有棋盘
+ * @param seed 随机数种子
+ */
+void SnakeBatch::reset(quint32 seed)
+{
+    m_seed = seed;
+    m_steps = 0;
+    for (int board = 0; board < m_boardCount; ++board) {
+        m_random[board] = deriveState(seed, board);
+        m_lastScore[board] = 0;
+        m_episodes[board] = 0;
+        m_rewards[board] = 0.0f;
+        m_dones[board] = 0;
+        resetBoard(board);
+    }
+}
+
+/**
+ * @brief 所有棋盘同步推进一步
+ * @param actions 每个棋盘的动作，可以为nullptr
+ *
+ * 按棋盘分块，每个线程约4块；每块只访问自己棋盘的数据。
+ */
+void SnakeBatch::step(const quint8 *actions)
+{
+    auto body = [this, actions](int begin, int end) {
+        for (int board = begin; board < end; ++board) {
+            stepBoard(board, actions ? actions[board] : -1);
+        }
+    };
+
+    if (m_pool) {
+        m_pool->parallelFor(m_boardCount, 0, body);  // 块大小由线程池按线程数决定
+    } else if (m_boardCount > 0) {
+        body(0, m_boardCount);
+    }
+    ++m_steps;
+}
+
+int SnakeBatch::boardCount() const
+{
+    return m_boardCount;
+}
+
+int SnakeBatch::width() const
+{
+    return m_width;
+}
+
+int SnakeBatch::height() const
+{
+    return m_height;
+}
+
+int SnakeBatch::cellCount() const
+{
+    return m_cells;
+}
+
+const quint8 *SnakeBatch::observations() const
+{
+    return m_observations.constData();
+}
+
+const float *SnakeBatch::rewards() const
+{
+    return m_rewards.constData();
+}
+
+const quint8 *SnakeBatch::dones() const
+{
+    return m_dones.constData();
+}
+
+const quint64 *SnakeBatch::occupancyBits(int board) const
+{
+    return m_bits.constData() + board * m_words;
+}
+
+int SnakeBatch::wordsPerBoard() const
+{
+    return m_words;
+}
+
+bool SnakeBatch::isOccupied(int board, const QPoint &pos) const
+{
+    if (pos.x() < 0 || pos.x() >= m_width || pos.y() < 0 || pos.y() >= m_height) {
+        return false;
+    }
+    int cell = pos.y() * m_width + pos.x();
+    return (occupancyBits(board)[cell >> 6] >> (cell & 63)) & 1;
+}
+
+QPoint SnakeBatch::head(int board) const
+{
+    int cell = m_bodies.at(board * m_cells + m_headIndex.at(board));
+    return QPoint(cell % m_width, cell / m_width);
+}
+
+QPoint SnakeBatch::food(int board) const
+{
+    int cell = m_food.at(board);
+    return QPoint(cell % m_width, cell / m_width);
+}
+
+Direction SnakeBatch::direction(int board) const
+{
+    return Direction(m_direction.at(board));
+}
+
+int SnakeBatch::length(int board) const
+{
+    return m_length.at(board);
+}
+
+int SnakeBatch::score(int board) const
+{
+    return m_score.at(board);
+}
+
+int SnakeBatch::lastEpisodeScore(int board) const
+{
+    return m_lastScore.at(board);
+}
+
+quint64 SnakeBatch::episodeCount() const
+{
+    quint64 total = 0;
+    for (quint64 episodes : m_episodes) {
+        total += episodes;
+    }
+    return total;
+}
+
+quint64 SnakeBatch::stepCount() const
+{
+    return m_steps;
+}
+
+/**
+ * @brief 重开一个棋盘
+ * @param board 棋盘序号
+ *
+ * 清空位棋盘和观测，蛇位于区域中央、长度为3、向右移动，再放置第一个食物。
+ */
+void SnakeBatch::resetBoard(int board)
+{
+    quint64 *bits = m_bits.data() + board * m_words;
+    quint8 *observation = m_observations.data() + board * m_cells;
+    int *body = m_bodies.data() + board * m_cells;
+    std::fill(bits, bits + m_words, 0);
+    std::fill(observation, observation + m_cells, quint8(Empty));
+
+    // 环形缓冲区中蛇头在前，依次为蛇身
+    int head = (m_height / 2) * m_width + m_width / 2;
+    for (int i = 0; i < 3; ++i) {
+        int cell = head - i;
+        body[i] = cell;
+        bits[cell >> 6] |= quint64(1) << (cell & 63);
+        observation[cell] = i == 0 ? Head : Body;
+    }
+    m_headIndex[board] = 0;
+    m_length[board] = 3;
+    m_direction[board] = Right;
+    m_grow[board] = 0;
+    m_score[board] = 0;
+    placeFood(board);
+}
+
+/**
+ * @brief 推进一个棋盘
+ * @param board 棋盘序号
+ * @param action 动作（Direction的取值），无效时保持原方向
+ *
+ * 不增长时先让出蛇尾再检测蛇头，因此蛇头可以移到刚让出的蛇尾格子上（与SnakeEngine一致）。
+ * 一局结束时记录分数并立即重开。
+ */
+void SnakeBatch::stepBoard(int board, int action)
+{
+    m_rewards[board] = 0.0f;
+    m_dones[board] = 0;
+
+    int direction = m_direction[board];
+    if (action >= Up && action <= Right && opposite(Direction(action)) != direction) {
+        direction = action;
+        m_direction[board] = quint8(direction);
+    }
+
+    quint64 *bits = m_bits.data() + board * m_words;
+    quint8 *observation = m_observations.data() + board * m_cells;
+    int *body = m_bodies.data() + board * m_cells;
+    int headIndex = m_headIndex[board];
+    int length = m_length[board];
+
+    int oldHead = body[headIndex];
+    const int x = oldHead % m_width + directionDx(direction);
+    const int y = oldHead / m_width + directionDy(direction);
+
+    bool dead = x < 0 || x >= m_width || y < 0 || y >= m_height;
+    if (!dead) {
+        // 让出蛇尾或增长一节
+        if (m_grow[board]) {
+            ++length;
+            m_grow[board] = 0;
+        } else {
+            int tail = body[headIndex + length - 1 < m_cells ? headIndex + length - 1 : headIndex + length - 1 - m_cells];
+            bits[tail >> 6] &= ~(quint64(1) << (tail & 63));
+            observation[tail] = Empty;
+        }
+
+        int cell = y * m_width + x;
+        quint64 mask = quint64(1) << (cell & 63);
+        dead = (bits[cell >> 6] & mask) != 0;
+        if (!dead) {
+            bits[cell >> 6] |= mask;
+            observation[oldHead] = Body;
+            observation[cell] = Head;
+            headIndex = headIndex == 0 ? m_cells - 1 : headIndex - 1;
+            body[headIndex] = cell;
+            m_headIndex[board] = headIndex;
+            m_length[board] = length;
+
+            if (cell == m_food[board]) {
+                m_grow[board] = 1;
+                m_score[board] += kFoodScore;
+                m_rewards[board] = 1.0f;
+                if (!placeFood(board)) {
+                    // 没有空闲格子：蛇占满整个区域，通关
+                    m_lastScore[board] = m_score[board];
+                    ++m_episodes[board];
+                    m_dones[board] = 1;
+                    resetBoard(board);
+                }
+            }
+            return;
+        }
+    }
+
+    m_rewards[board] = -1.0f;
+    m_lastScore[board] = m_score[board];
+    ++m_episodes[board];
+    m_dones[board] = 1;
+    resetBoard(board);
+}
+
+/**
+ * @brief 在空闲格子中均匀放置食物
+ * @param board 棋盘序号
+ * @return 成功放置返回true，没有空闲格子时返回false
+ *
+ * 蛇较短时随机取一个格子基本都是空闲的，先尝试几次；都落在蛇身上时，
+ * 按位棋盘逐字统计空闲位数，找到第k个空闲格子，开销为O(格子数/64)。
+ * 两种方式都在空闲格子中均匀抽取，合起来仍然是均匀的。
+ */
+bool SnakeBatch::placeFood(int board)
+{
+    const quint64 *bits = m_bits.constData() + board * m_words;
+    quint8 *observation = m_observations.data() + board * m_cells;
+
+    int freeCount = m_cells - m_length[board];
+    if (freeCount <= 0) {
+        return false;
+    }
+
+    int cell = -1;
+    for (int i = 0; i < kFoodTries && cell < 0; ++i) {
+        int candidate = int(random(board, quint32(m_cells)));
+        if (!((bits[candidate >> 6] >> (candidate & 63)) & 1)) {
+            cell = candidate;
+        }
+    }
+
+    if (cell < 0) {
+        int k = int(random(board, quint32(freeCount)));
+        for (int w = 0; w < m_words; ++w) {
+            quint64 freeBits = ~bits[w];
+            if (w == m_words - 1 && (m_cells & 63)) {
+                freeBits &= (quint64(1) << (m_cells & 63)) - 1;  // 最后一个字中超出区域的位
+            }
+            int count = int(qPopulationCount(freeBits));
+            if (k < count) {
+                for (; k > 0; --k) {
+                    freeBits &= freeBits - 1;  // 去掉最低的k个空闲位
+                }
+                cell = w * 64 + int(qCountTrailingZeroBits(freeBits));
+                break;
+            }
+            k -= count;
+        }
+    }
+
+    m_food[board] = cell;
+    observation[cell] = Food;
+    return true;
+}
+
+/**
+ * @brief 棋盘自己的随机数（xorshift64*）
+ * @param board 棋盘序号
+ * @param bound 上界
+ * @return [0, bound)中的随机数
+ */
+quint32 SnakeBatch::random(int board, quint32 bound)
+{
+    quint64 x = m_random[board];
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    m_random[board] = x;
+    quint32 value = quint32((x * 0x2545F4914F6CDD1DULL) >> 32);
+    return quint32((quint64(value) * bound) >> 32);
+}
@@ -0,0 +1,139 @@
+#ifndef SNAKEBATCH_H
+#define SNAKEBATCH_H
+
+#include <QPoint>
+#include <QVector>
+#include "snake.h"
+#include "workstealingpool.h"
+
+/**
+ * @brief SnakeBatch类同步推进大量相互独立、大小相同的贪吃蛇棋盘
+ *
+ * 用于批量模拟和训练贪吃蛇AI。规则与SnakeEngine相同（不能180度转向，吃到食物后
+ * 下一步增长，撞墙或撞到自己结束，占满整个区域通关），但所有状态按“数组的结构”存放：
+ *   - 每个棋盘的占用情况是一块位棋盘（每格1位），碰撞检测只需测试一位；
+ *   - 蛇身是每个棋盘一段固定容量的环形缓冲区（格子序号），移动为O(1)；
+ *   - 观测是所有棋盘连续存放的格子张量[棋盘][行][列]，每步只改写变化的几个格子，
+ *     通过observations()直接读取，不复制；
+ *   - 奖励和结束标志也各是一段连续数组。
+ * 结束的棋盘在同一步内自动重开：dones()标记这一步结束了一局，观测已是新一局的开局。
+ *
+ * 每个棋盘有自己的随机数状态，棋盘之间不共享可变数据，因此可以在任务窃取线程池上
+ * 按棋盘分块并行推进，结果与线程数无关。
+ */
+class SnakeBatch
+{
+public:
+    // 观测张量中格子的取值
+    enum Cell : quint8 {
+        Empty = 0,  // 空格子
+        Body = 1,   // 蛇身
+        Head = 2,   // 蛇头
+        Food = 3    // 食物
+    };
+
+    /**
+     * @brief 构造函数
+     * @param boardCount 棋盘数量
+     * @param width 区域宽度（格子数），至少为4
+     * @param height 区域高度（格子数），至少为4
+     * @param seed 随机数种子，每个棋盘由它派生出不同的食物序列
+     */
+    SnakeBatch(int boardCount, int width, int height, quint32 seed = 0);
+
+    /**
+     * @brief 设置推进时使用的线程池
+     * @param pool 线程池，为nullptr时在调用线程串行推进；由调用者持有
+     */
+    void setThreadPool(WorkStealingPool *pool);
+
+    /**
+     * @brief 用新的种子重开所有棋盘
+     * @param seed 随机数种子
+     */
+    void reset(quint32 seed);
+
+    /**
+     * @brief 所有棋盘同步推进一步
+     * @param actions 每个棋盘的动作（Direction的取值），长度为boardCount()；
+     *                为nullptr或取值无效时保持原方向，180度转向被忽略
+     */
+    void step(const quint8 *actions);
+
+    int boardCount() const;
+    int width() const;
+    int height() const;
+    int cellCount() const;          // 每个棋盘的格子数（width*height）
+
+    /**
+     * @brief 获取所有棋盘的观测张量
+     * @return 连续的boardCount()*height()*width()个Cell取值，下一次step()前有效
+     */
+    const quint8 *observations() const;
+
+    /**
+     * @brief 获取上一步每个棋盘的奖励（吃到食物+1，死亡-1，其他为0）
+     */
+    const float *rewards() const;
+
+    /**
+     * @brief 获取上一步每个棋盘是否结束了一局（1为结束，棋盘已自动重开）
+     */
+    const quint8 *dones() const;
+
+    /**
+     * @brief 获取棋盘的占用位棋盘
+     * @param board 棋盘序号
+     * @return wordsPerBoard()个64位字，格子序号为y*width()+x
+     */
+    const quint64 *occupancyBits(int board) const;
+    int wordsPerBoard() const;
+
+    bool isOccupied(int board, const QPoint &pos) const;
+    QPoint head(int board) const;
+    QPoint food(int board) const;
+    Direction direction(int board) const;
+    int length(int board) const;
+    int score(int board) const;            // 当前这一局的分数
+    int lastEpisodeScore(int board) const; // 上一局结束时的分数
+    quint64 episodeCount() const;          // 所有棋盘累计结束的局数
+    quint64 stepCount() const;             // 已推进的步数（每步含所有棋盘）
+
+private:
+    // 重开一个棋盘：蛇位于中央，长度为3，向右移动
+    void resetBoard(int board);
+    // 推进一个棋盘
+    void stepBoard(int board, int action);
+    // 在空闲格子中均匀放置食物，没有空闲格子时返回false
+    bool placeFood(int board);
+    // 棋盘自己的随机数，返回[0, bound)
+    quint32 random(int board, quint32 bound);
+
+private:
+    int m_boardCount;               // 棋盘数量
+    int m_width;                    // 区域宽度
+    int m_height;                   // 区域高度
+    int m_cells;                    // 每个棋盘的格子数
+    int m_words;                    // 每个棋盘的位棋盘字数
+    quint32 m_seed;                 // 当前的随机数种子
+    WorkStealingPool *m_pool;       // 线程池（可为nullptr）
+    quint64 m_steps;                // 已推进的步数
+
+    // 以下数组按棋盘序号存放
+    QVector<quint64> m_bits;        // 位棋盘，每个棋盘m_words个字
+    QVector<quint8> m_observations; // 观测张量，每个棋盘m_cells个格子
+    QVector<int> m_bodies;          // 蛇身环形缓冲区，每个棋盘m_cells个格子序号
+    QVector<int> m_headIndex;       // 蛇头在环形缓冲区中的位置
+    QVector<int> m_length;          // 蛇的长度
+    QVector<quint8> m_direction;    // 当前移动方向
+    QVector<quint8> m_grow;         // 下一步是否增长
+    QVector<int> m_food;            // 食物的格子序号
+    QVector<int> m_score;           // 当前这一局的分数
+    QVector<int> m_lastScore;       // 上一局结束时的分数
+    QVector<quint64> m_episodes;    // 结束的局数
+    QVector<quint64> m_random;      // 随机数状态
+    QVector<float> m_rewards;       // 上一步的奖励
+    QVector<quint8> m_dones;        // 上一步是否结束
+};
+
+#endif // SNAKEBATCH_H
@@ -0,0 +1,262 @@
+#ifndef SNAKEBOARD_H
+#define SNAKEBOARD_H
+
+#include <QVector>
+#include <QtAlgorithms>
+#include <array>
+
+/**
+ * @brief 位棋盘的基本操作（每格1位，格子序号为y*宽度+x）
+ */
+namespace SnakeBits {
+
+// 位棋盘整体向高位移动shift位（格子序号增加shift）后的第w个字，shift可以为负
+inline quint64 shiftedWord(const quint64 *bits, int words, int w, int shift)
+{
+    if (shift >= 0) {
+        int source = w - (shift >> 6);
+        int offset = shift & 63;
+        quint64 value = source >= 0 && source < words ? bits[source] << offset : 0;
+        if (offset != 0 && source - 1 >= 0 && source - 1 < words) {
+            value |= bits[source - 1] >> (64 - offset);
+        }
+        return value;
+    }
+    shift = -shift;
+    int source = w + (shift >> 6);
+    int offset = shift & 63;
+    quint64 value = source >= 0 && source < words ? bits[source] >> offset : 0;
+    if (offset != 0 && source + 1 >= 0 && source + 1 < words) {
+        value |= bits[source + 1] << (64 - offset);
+    }
+    return value;
+}
+
+inline bool testBit(const quint64 *bits, int cell)
+{
+    return (bits[cell >> 6] >> (cell & 63)) & 1;
+}
+
+inline void setBit(quint64 *bits, int cell)
+{
+    bits[cell >> 6] |= quint64(1) << (cell & 63);
+}
+
+inline void clearBit(quint64 *bits, int cell)
+{
+    bits[cell >> 6] &= ~(quint64(1) << (cell & 63));
+}
+
+/**
+ * @brief 从一个格子出发统计可到达的空闲格子数
+ * @param board 位棋盘（SnakeBoard的任意特化）
+ * @param source 起点，本身被占用也会计入
+ * @param visited、frontier、next 三块wordCount()个字的全零工作区
+ * @return 可到达的格子数（含起点）
+ *
+ * 每一层用移位和列掩码一次算出整层的相邻格子。区域大小是编译期常量时，
+ * 字数和移位量都是常量，循环可以完全展开。
+ */
+template <typename Board>
+int floodFill(const Board &board, int source, quint64 *visited, quint64 *frontier, quint64 *next)
+{
+    const int words = board.wordCount();
+    const int width = board.width();
+    const quint64 *occupied = board.bits();
+    const quint64 *notFirst = board.notFirstColumn();
+    const quint64 *notLast = board.notLastColumn();
+    const quint64 *valid = board.validMask();
+
+    setBit(visited, source);
+    setBit(frontier, source);
+    int count = 1;
+    for (;;) {
+        quint64 any = 0;
+        for (int w = 0; w < words; ++w) {
+            quint64 spread = (shiftedWord(frontier, words, w, 1) & notFirst[w])
+                           | (shiftedWord(frontier, words, w, -1) & notLast[w])
+                           | shiftedWord(frontier, words, w, width)
+                           | shiftedWord(frontier, words, w, -width);
+            spread &= valid[w] & ~occupied[w] & ~visited[w];
+            next[w] = spread;
+            visited[w] |= spread;
+            count += int(qPopulationCount(spread));
+            any |= spread;
+        }
+        if (!any) {
+            return count;
+        }
+        quint64 *swap = frontier;
+        frontier = next;
+        next = swap;
+    }
+}
+
+/**
+ * @brief 编译期计算的位棋盘掩码
+ */
+template <int W, int H>
+struct BoardMasks {
+    static constexpr int Words = (W * H + 63) / 64;
+
+    std::array<quint64, Words> notFirstColumn {};  // 不在第0列的格子（向右移一格后有效）
+    std::array<quint64, Words> notLastColumn {};   // 不在最后一列的格子（向左移一格后有效）
+    std::array<quint64, Words> valid {};           // 区域内的格子
+
+    constexpr BoardMasks()
+    {
+        for (int cell = 0; cell < W * H; ++cell) {
+            const quint64 bit = quint64(1) << (cell & 63);
+            valid[cell >> 6] |= bit;
+            if (cell % W != 0) {
+                notFirstColumn[cell >> 6] |= bit;
+            }
+            if (cell % W != W - 1) {
+                notLastColumn[cell >> 6] |= bit;
+            }
+        }
+    }
+};
+
+} // namespace SnakeBits
+
+/**
+ * @brief 区域大小在编译期确定的贪吃蛇位棋盘
+ *
+ * 字数、列掩码（防止左右移位时跨行）和区域掩码（最后一个字中超出区域的位）都由constexpr
+ * 在编译期算好，碰撞检测和连通区域搜索都是固定长度、可以展开的位运算。
+ * 常用的尺寸为SnakeBoard<30, 20>（默认区域）、SnakeBoard<64, 64>和SnakeBoard<128, 128>；
+ * 其他尺寸使用运行时版本SnakeBoard<0, 0>（RuntimeSnakeBoard），接口相同。
+ * 目前只有snake_bench使用；引擎用占用计数表做碰撞检测，自动驾驶的搜索只扫描前沿附近的字，
+ * 在这些尺寸上比每层扫描整个棋盘更快，都没有改用这里的版本。
+ */
+template <int W, int H>
+class SnakeBoard
+{
+    static_assert(W > 0 && H > 0, "SnakeBoard<0, 0>为运行时版本，其他尺寸必须为正数");
+
+public:
+    static constexpr int Cells = W * H;
+    static constexpr int Words = (Cells + 63) / 64;
+    using Storage = std::array<quint64, Words>;
+
+    SnakeBoard() : m_bits() {}
+
+    static constexpr int width() { return W; }
+    static constexpr int height() { return H; }
+    static constexpr int cellCount() { return Cells; }
+    static constexpr int wordCount() { return Words; }
+
+    void clear() { m_bits.fill(0); }
+    bool test(int cell) const { return SnakeBits::testBit(m_bits.data(), cell); }
+    void set(int cell) { SnakeBits::setBit(m_bits.data(), cell); }
+    void reset(int cell) { SnakeBits::clearBit(m_bits.data(), cell); }
+
+    /**
+     * @brief 检查移动到(x, y)是否会撞墙或撞到蛇身
+     */
+    bool collides(int x, int y) const
+    {
+        return unsigned(x) >= unsigned(W) || unsigned(y) >= unsigned(H) || test(y * W + x);
+    }
+
+    /**
+     * @brief 从一个格子出发统计可到达的空闲格子数（工作区在栈上）
+     */
+    int floodFill(int source) const
+    {
+        Storage visited {};
+        Storage frontier {};
+        Storage next {};
+        return SnakeBits::floodFill(*this, source, visited.data(), frontier.data(), next.data());
+    }
+
+    const quint64 *bits() const { return m_bits.data(); }
+    static const quint64 *notFirstColumn() { return kMasks.notFirstColumn.data(); }
+    static const quint64 *notLastColumn() { return kMasks.notLastColumn.data(); }
+    static const quint64 *validMask() { return kMasks.valid.data(); }
+
+private:
+    static constexpr SnakeBits::BoardMasks<W, H> kMasks {};  // 编译期计算的掩码
+
+    Storage m_bits;  // 占用位棋盘
+};
+
+/**
+ * @brief 区域大小在运行时确定的贪吃蛇位棋盘
+ *
+ * 与编译期版本接口相同，用于任意的区域大小；掩码在构造时计算，
+ * 连通区域搜索的工作区作为成员复用。
+ */
+template <>
+class SnakeBoard<0, 0>
+{
+public:
+    using Storage = QVector<quint64>;
+
+    SnakeBoard(int width, int height)
+        : m_width(width)
+        , m_height(height)
+        , m_cells(width * height)
+        , m_words((width * height + 63) / 64)
+        , m_bits(m_words, 0)
+        , m_notFirstColumn(m_words, 0)
+        , m_notLastColumn(m_words, 0)
+        , m_valid(m_words, 0)
+    {
+        for (int cell = 0; cell < m_cells; ++cell) {
+            SnakeBits::setBit(m_valid.data(), cell);
+            if (cell % m_width != 0) {
+                SnakeBits::setBit(m_notFirstColumn.data(), cell);
+            }
+            if (cell % m_width != m_width - 1) {
+                SnakeBits::setBit(m_notLastColumn.data(), cell);
+            }
+        }
+    }
+
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int cellCount() const { return m_cells; }
+    int wordCount() const { return m_words; }
+
+    void clear() { m_bits.fill(0); }
+    bool test(int cell) const { return SnakeBits::testBit(m_bits.constData(), cell); }
+    void set(int cell) { SnakeBits::setBit(m_bits.data(), cell); }
+    void reset(int cell) { SnakeBits::clearBit(m_bits.data(), cell); }
+
+    bool collides(int x, int y) const
+    {
+        return unsigned(x) >= unsigned(m_width) || unsigned(y) >= unsigned(m_height) || test(y * m_width + x);
+    }
+
+    int floodFill(int source) const
+    {
+        m_visited.fill(0, m_words);
+        m_frontier.fill(0, m_words);
+        m_next.fill(0, m_words);
+        return SnakeBits::floodFill(*this, source, m_visited.data(), m_frontier.data(), m_next.data());
+    }
+
+    const quint64 *bits() const { return m_bits.constData(); }
+    const quint64 *notFirstColumn() const { return m_notFirstColumn.constData(); }
+    const quint64 *notLastColumn() const { return m_notLastColumn.constData(); }
+    const quint64 *validMask() const { return m_valid.constData(); }
+
+private:
+    int m_width;                       // 区域宽度
+    int m_height;                      // 区域高度
+    int m_cells;                       // 格子数
+    int m_words;                       // 字数
+    Storage m_bits;                    // 占用位棋盘
+    Storage m_notFirstColumn;          // 不在第0列的格子
+    Storage m_notLastColumn;           // 不在最后一列的格子
+    Storage m_valid;                   // 区域内的格子
+    mutable Storage m_visited;         // 连通区域搜索的工作区
+    mutable Storage m_frontier;
+    mutable Storage m_next;
+};
+
+using RuntimeSnakeBoard = SnakeBoard<0, 0>;
+
+#endif // SNAKEBOARD_H
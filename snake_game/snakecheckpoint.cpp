@@ -0,0 +1,473 @@
+#include "snakecheckpoint.h"
+#include <QElapsedTimer>
+#include <cstddef>
+#include <cstring>
+
+namespace {
+// 文件的页大小（字节），各部分都从页的边界开始
+const qint64 kPageSize = 4096;
+// 文件格式的版本
+const quint32 kVersion = 1;
+// 按本机字节序写入的标记，读出的值不同说明文件来自字节序不同的机器
+const quint32 kByteOrderMark = 0x01020304;
+// 速度曲线名字的最大字节数
+const int kScheduleNameSize = 32;
+
+// 文件头中的标志位
+enum HeaderFlag {
+    GameOverFlag = 1,
+    GameWonFlag = 2,
+    GrowFlag = 4,
+    CompactFlag = 8
+};
+
+// 第0页的文件头（本机字节序）
+struct Header {
+    char magic[4];              // "SNKC"
+    quint32 version;            // 文件格式的版本
+    quint32 byteOrder;          // kByteOrderMark
+    quint32 complete;           // 写入完成为1，正在写入为0
+    quint32 flags;              // HeaderFlag
+    qint32 width;               // 区域宽度
+    qint32 height;              // 区域高度
+    quint32 seed;               // 本局的随机数种子
+    qint32 direction;           // 蛇最近一次移动的方向
+    qint32 nextDirection;       // 蛇下一步的方向
+    qint32 score;               // 分数
+    qint32 length;              // 蛇的长度
+    qint32 foodX;               // 食物位置
+    qint32 foodY;
+    qint32 ringCapacity;        // 蛇身环形缓冲区的容量
+    qint32 ringHead;            // 蛇头在环形缓冲区中的索引
+    qint32 freeCount;           // 空闲格子数
+    qint32 reserved;
+    quint64 ticks;              // 已推进的步数
+    quint64 foodDraws;          // 生成食物时已抽取的随机数个数
+    qint64 intervalNs;          // 每步的时间间隔
+    qint64 elapsedNs;           // 游戏时间
+    qint64 ringOffset;          // 蛇身环形缓冲区的位置
+    qint64 bitmapOffset;        // 占用位图的位置
+    qint64 freeListOffset;      // 空闲集合的位置
+    qint64 fileSize;            // 文件大小
+    char schedule[kScheduleNameSize]; // 速度曲线的名字（UTF-8，不足时补0）
+};
+
+// 向上取整到页的边界
+qint64 pageAlign(qint64 size)
+{
+    return (size + kPageSize - 1) / kPageSize * kPageSize;
+}
+
+// 文件中[offset, offset+size)跨越的页数
+int pagesSpanned(qint64 offset, qint64 size)
+{
+    return size > 0 ? int((offset + size - 1) / kPageSize - offset / kPageSize + 1) : 0;
+}
+
+void setError(QString *error, const QString &message)
+{
+    if (error) {
+        *error = message;
+    }
+}
+}
+
+SnakeCheckpoint::SnakeCheckpoint()
+    : m_engine(nullptr)
+    , m_width(0)
+    , m_height(0)
+    , m_seed(0)
+    , m_compact(false)
+    , m_ticks(0)
+    , m_generation(0)
+    , m_changes(0)
+    , m_ringCapacity(0)
+    , m_ringHead(0)
+    , m_ringOffset(0)
+    , m_bitmapOffset(0)
+    , m_freeListOffset(0)
+    , m_fileSize(0)
+{
+}
+
+/**
+ * @brief 保存引擎的当前状态
+ * @param engine 游戏引擎
+ * @param path 检查点文件的路径
+ * @param error 失败时写入原因
+ * @return 保存成功返回true
+ *
+ * 失败后关闭文件，下一次保存重新完整写入。
+ */
+bool SnakeCheckpoint::save(const SnakeEngine &engine, const QString &path, QString *error)
+{
+    QElapsedTimer timer;
+    timer.start();
+    if (path != m_file.fileName()) {
+        close();
+        m_file.setFileName(path);
+    }
+    const bool incremental = canSaveIncremental(engine);
+    const bool ok = incremental ? saveIncremental(engine, error) : saveFull(engine, error);
+    if (!ok) {
+        close();
+        return false;
+    }
+    remember(engine);
+    m_lastSave.incremental = incremental;
+    m_lastSave.pageCount = int(m_fileSize / kPageSize);
+    m_lastSave.elapsedNs = timer.nsecsElapsed();
+    return true;
+}
+
+/**
+ * @brief 关闭文件
+ */
+void SnakeCheckpoint::close()
+{
+    m_file.close();
+    m_engine = nullptr;
+}
+
+QString SnakeCheckpoint::path() const
+{
+    return m_file.fileName();
+}
+
+const SnakeCheckpoint::SaveStats &SnakeCheckpoint::lastSave() const
+{
+    return m_lastSave;
+}
+
+/**
+ * @brief 从检查点文件恢复一局
+ * @param path 检查点文件的路径
+ * @param engine 游戏引擎
+ * @param error 失败时写入原因
+ * @return 恢复成功返回true
+ *
+ * 映射整个文件，校验文件头和各部分的范围后，蛇身、位图和空闲集合直接以映射中的数组
+ * 交给引擎，引擎复制到自己的缓冲区后解除映射。文件头无效时引擎不变；各部分的内容
+ * 互相矛盾时引擎的restore()会拒绝，并用文件中的种子重新开始一局。
+ */
+bool SnakeCheckpoint::load(const QString &path, SnakeEngine *engine, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, file.errorString());
+        return false;
+    }
+    const qint64 size = file.size();
+    if (size < kPageSize) {
+        setError(error, QStringLiteral("不是检查点文件"));
+        return false;
+    }
+    uchar *data = file.map(0, size);
+    if (!data) {
+        setError(error, file.errorString());
+        return false;
+    }
+
+    Header header;
+    memcpy(&header, data, sizeof(header));
+    QString message;
+    const qint64 cells = qint64(header.width) * header.height;
+    if (memcmp(header.magic, "SNKC", 4) != 0) {
+        message = QStringLiteral("不是检查点文件");
+    } else if (header.version != kVersion) {
+        message = QStringLiteral("不支持的检查点版本%1").arg(header.version);
+    } else if (header.byteOrder != kByteOrderMark) {
+        message = QStringLiteral("检查点来自字节序不同的机器");
+    } else if (header.complete != 1) {
+        message = QStringLiteral("检查点没有写完");
+    } else if (header.fileSize != size) {
+        message = QStringLiteral("文件大小与检查点记录的不符");
+    } else if (header.width <= 0 || header.height <= 0 || cells > 0x7fffffff
+               || header.ringCapacity <= 0 || (header.ringCapacity & (header.ringCapacity - 1)) != 0
+               || header.ringHead < 0 || header.ringHead >= header.ringCapacity
+               || header.length <= 0 || header.length > header.ringCapacity
+               || header.freeCount < 0 || header.freeCount > cells
+               || header.foodDraws > header.ticks + 1 || header.foodDraws > quint64(cells) + 1
+               || header.direction < Up || header.direction > Right
+               || header.nextDirection < Up || header.nextDirection > Right) {
+        message = QStringLiteral("文件头数据无效");
+    } else if (header.ringOffset < kPageSize || header.ringOffset % kPageSize != 0
+               || header.bitmapOffset % kPageSize != 0 || header.freeListOffset % kPageSize != 0
+               || header.ringOffset + header.ringCapacity * qint64(sizeof(QPoint)) > size
+               || header.bitmapOffset < kPageSize || header.bitmapOffset + (cells + 63) / 64 * 8 > size
+               || header.freeListOffset < kPageSize || header.freeListOffset + header.freeCount * qint64(sizeof(int)) > size) {
+        message = QStringLiteral("检查点的各部分超出文件范围");
+    }
+    if (!message.isEmpty()) {
+        file.unmap(data);
+        setError(error, message);
+        return false;
+    }
+
+    engine->setCompactBody(header.flags & CompactFlag);
+    bool known = false;
+    const SpeedSchedule schedule = SpeedSchedule::byName(
+        QString::fromUtf8(header.schedule, int(strnlen(header.schedule, kScheduleNameSize))), &known);
+    if (known) {
+        engine->setSpeedSchedule(schedule);  // 自定义的曲线保持引擎当前的设置
+    }
+
+    SnakeEngine::State state;
+    state.width = header.width;
+    state.height = header.height;
+    state.seed = header.seed;
+    state.foodDraws = header.foodDraws;
+    state.food = QPoint(header.foodX, header.foodY);
+    state.score = header.score;
+    state.intervalNs = header.intervalNs;
+    state.elapsedNs = header.elapsedNs;
+    state.ticks = header.ticks;
+    state.gameOver = header.flags & GameOverFlag;
+    state.gameWon = header.flags & GameWonFlag;
+    state.direction = Direction(header.direction);
+    state.nextDirection = Direction(header.nextDirection);
+    state.grow = header.flags & GrowFlag;
+    state.ring = reinterpret_cast<const QPoint *>(data + header.ringOffset);
+    state.ringCapacity = header.ringCapacity;
+    state.ringHead = header.ringHead;
+    state.length = header.length;
+    state.bitmap = reinterpret_cast<const quint64 *>(data + header.bitmapOffset);
+    state.freeCells = reinterpret_cast<const int *>(data + header.freeListOffset);
+    state.freeCount = header.freeCount;
+    const bool ok = engine->restore(state);
+    file.unmap(data);
+    if (!ok) {
+        setError(error, QStringLiteral("检查点的蛇身、占用位图和空闲格子互相矛盾"));
+    }
+    return ok;
+}
+
+/**
+ * @brief 重新建立文件并写入全部内容
+ *
+ * 环形缓冲区的容量取不小于两倍蛇长的2的幂，蛇再长一倍之前都可以增量保存。
+ * 先把文件调整到最终大小（未写的部分为0），最后写文件头。
+ */
+bool SnakeCheckpoint::saveFull(const SnakeEngine &engine, QString *error)
+{
+    m_file.close();
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        setError(error, m_file.errorString());
+        return false;
+    }
+
+    const Snake &snake = engine.snake();
+    const OccupancyGrid &grid = snake.occupancy();
+    const qint64 cells = qint64(grid.width()) * grid.height();
+    m_ringCapacity = 16;
+    while (m_ringCapacity < 2 * snake.length()) {
+        m_ringCapacity *= 2;
+    }
+    m_ringHead = 0;
+    m_ringOffset = kPageSize;
+    m_bitmapOffset = m_ringOffset + pageAlign(m_ringCapacity * qint64(sizeof(QPoint)));
+    m_freeListOffset = m_bitmapOffset + grid.bitmapPageCount() * kPageSize;
+    m_fileSize = m_freeListOffset + pageAlign(cells * 4);
+    if (!m_file.resize(m_fileSize)) {
+        setError(error, m_file.errorString());
+        return false;
+    }
+
+    if (writeRing(snake, snake.length(), error) < 0) {
+        return false;
+    }
+    QVector<quint64> words(OccupancyGrid::BitmapPageCells / 64);
+    for (int page = 0; page < grid.bitmapPageCount(); ++page) {
+        grid.packBitmapPage(page, words.data());
+        if (!writeAt(m_bitmapOffset + page * kPageSize, words.constData(), kPageSize, error)) {
+            return false;
+        }
+    }
+    if (!writeAt(m_freeListOffset, grid.freeList(), grid.freeCount() * qint64(sizeof(int)), error)
+        || !writeHeader(engine, true, error)) {
+        return false;
+    }
+    m_lastSave.pagesWritten = int(m_fileSize / kPageSize);
+    return true;
+}
+
+/**
+ * @brief 只写入上次保存后变化的页
+ *
+ * 上次保存后蛇头前进了ticks步：文件中的蛇头索引后退同样的格数，写入新的蛇头
+ * （步数超过蛇长时整条蛇都是新的），其余各节仍在原来的位置。位图和空闲集合
+ * 只写变化序号大于上次保存的页，空闲集合中超出当前空闲格子数的部分不再有效，不用写。
+ */
+bool SnakeCheckpoint::saveIncremental(const SnakeEngine &engine, QString *error)
+{
+    const quint32 incomplete = 0;
+    if (!writeAt(offsetof(Header, complete), &incomplete, sizeof(incomplete), error) || !m_file.flush()) {
+        setError(error, m_file.errorString());
+        return false;
+    }
+
+    const Snake &snake = engine.snake();
+    const OccupancyGrid &grid = snake.occupancy();
+    const quint64 moves = engine.tickCount() - m_ticks;
+    m_ringHead = (m_ringHead - int(moves & quint64(m_ringCapacity - 1))) & (m_ringCapacity - 1);
+    const int pages = writeRing(snake, int(qMin(moves, quint64(snake.length()))), error);
+    if (pages < 0) {
+        return false;
+    }
+    m_lastSave.pagesWritten = pages + 1;  // 文件头
+
+    QVector<quint64> words(OccupancyGrid::BitmapPageCells / 64);
+    for (int page = 0; page < grid.bitmapPageCount(); ++page) {
+        if (grid.bitmapPageChange(page) > m_changes) {
+            grid.packBitmapPage(page, words.data());
+            if (!writeAt(m_bitmapOffset + page * kPageSize, words.constData(), kPageSize, error)) {
+                return false;
+            }
+            ++m_lastSave.pagesWritten;
+        }
+    }
+    for (int page = 0; page < grid.freeListPageCount(); ++page) {
+        const int first = page * OccupancyGrid::FreeListPageEntries;
+        if (grid.freeListPageChange(page) > m_changes && first < grid.freeCount()) {
+            const int count = qMin(OccupancyGrid::FreeListPageEntries, grid.freeCount() - first);
+            if (!writeAt(m_freeListOffset + page * kPageSize, grid.freeList() + first,
+                         count * qint64(sizeof(int)), error)) {
+                return false;
+            }
+            ++m_lastSave.pagesWritten;
+        }
+    }
+    return writeHeader(engine, true, error);
+}
+
+/**
+ * @brief 能否在上次保存的基础上增量保存
+ *
+ * 需要是同一个引擎的同一局（占用计数表之后没有清空、调整大小或恢复过），
+ * 区域大小、种子和存储方式不变，并且蛇仍然放得下文件中的环形缓冲区。
+ */
+bool SnakeCheckpoint::canSaveIncremental(const SnakeEngine &engine) const
+{
+    const OccupancyGrid &grid = engine.snake().occupancy();
+    return m_file.isOpen() && m_engine == &engine
+           && grid.generation() == m_generation
+           && engine.width() == m_width && engine.height() == m_height
+           && engine.seed() == m_seed && engine.snake().isCompactBody() == m_compact
+           && engine.tickCount() >= m_ticks
+           && engine.snake().length() <= m_ringCapacity;
+}
+
+/**
+ * @brief 把蛇头开始的count节写入文件中的环形缓冲区
+ * @return 写入的页数，失败时返回-1
+ *
+ * 环形缓冲区中的count节最多分为两段连续的位置，各写一次。
+ */
+int SnakeCheckpoint::writeRing(const Snake &snake, int count, QString *error)
+{
+    QVector<QPoint> segments(count);
+    if (snake.isCompactBody()) {
+        snake.forEachSegment([&segments, count](int index, const QPoint &pos) {
+            if (index < count) {
+                segments[index] = pos;
+            }
+        });
+    } else {
+        for (int i = 0; i < count; ++i) {
+            segments[i] = snake.segmentAt(i);
+        }
+    }
+
+    const qint64 pointSize = sizeof(QPoint);
+    const int firstCount = qMin(count, m_ringCapacity - m_ringHead);
+    const qint64 firstOffset = m_ringOffset + m_ringHead * pointSize;
+    if (!writeAt(firstOffset, segments.constData(), firstCount * pointSize, error)
+        || !writeAt(m_ringOffset, segments.constData() + firstCount, (count - firstCount) * pointSize, error)) {
+        return -1;
+    }
+    return pagesSpanned(firstOffset, firstCount * pointSize)
+           + pagesSpanned(m_ringOffset, (count - firstCount) * pointSize);
+}
+
+/**
+ * @brief 写入文件头
+ * @param engine 游戏引擎
+ * @param complete 为false时标记为正在写入
+ * @return 写入成功返回true
+ */
+bool SnakeCheckpoint::writeHeader(const SnakeEngine &engine, bool complete, QString *error)
+{
+    const Snake &snake = engine.snake();
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "SNKC", 4);
+    header.version = kVersion;
+    header.byteOrder = kByteOrderMark;
+    header.complete = complete ? 1 : 0;
+    header.flags = (engine.isGameOver() ? GameOverFlag : 0) | (engine.isWon() ? GameWonFlag : 0)
+                   | (snake.isGrowing() ? GrowFlag : 0) | (snake.isCompactBody() ? CompactFlag : 0);
+    header.width = engine.width();
+    header.height = engine.height();
+    header.seed = engine.seed();
+    header.direction = snake.direction();
+    header.nextDirection = snake.nextDirection();
+    header.score = engine.score();
+    header.length = snake.length();
+    header.foodX = engine.food().x();
+    header.foodY = engine.food().y();
+    header.ringCapacity = m_ringCapacity;
+    header.ringHead = m_ringHead;
+    header.freeCount = snake.occupancy().freeCount();
+    header.ticks = engine.tickCount();
+    header.foodDraws = engine.foodDraws();
+    header.intervalNs = engine.intervalNs();
+    header.elapsedNs = engine.elapsedNs();
+    header.ringOffset = m_ringOffset;
+    header.bitmapOffset = m_bitmapOffset;
+    header.freeListOffset = m_freeListOffset;
+    header.fileSize = m_fileSize;
+    const QByteArray schedule = engine.speedSchedule().name().toUtf8();
+    memcpy(header.schedule, schedule.constData(), qMin(schedule.size(), kScheduleNameSize));
+
+    if (!writeAt(0, &header, sizeof(header), error)) {
+        return false;
+    }
+    if (!m_file.flush()) {
+        setError(error, m_file.errorString());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 在文件的指定位置写入数据
+ * @return 写入成功返回true
+ */
+bool SnakeCheckpoint::writeAt(qint64 offset, const void *data, qint64 size, QString *error)
+{
+    if (size <= 0) {
+        return true;
+    }
+    if (!m_file.seek(offset) || m_file.write(static_cast<const char *>(data), size) != size) {
+        setError(error, m_file.errorString());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 记下本次保存的状态
+ * @param engine 游戏引擎
+ */
+void SnakeCheckpoint::remember(const SnakeEngine &engine)
+{
+    const OccupancyGrid &grid = engine.snake().occupancy();
+    m_engine = &engine;
+    m_width = engine.width();
+    m_height = engine.height();
+    m_seed = engine.seed();
+    m_compact = engine.snake().isCompactBody();
+    m_ticks = engine.tickCount();
+    m_generation = grid.generation();
+    m_changes = grid.changeCount();
+}
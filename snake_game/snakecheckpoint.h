@@ -0,0 +1,123 @@
+#ifndef SNAKECHECKPOINT_H
+#define SNAKECHECKPOINT_H
+
+#include <QFile>
+#include <QString>
+#include "snakeengine.h"
+
+/**
+ * @brief SnakeCheckpoint类把进行中的一局保存为可以直接映射恢复的检查点文件
+ *
+ * 文件按4096字节分页，各部分都从页的边界开始，内容就是内存中的布局（本机字节序），
+ * 恢复时用QFile::map()映射整个文件，校验文件头后直接把各部分交给SnakeEngine::restore()，
+ * 不需要解析：
+ *   第0页   文件头：区域大小、种子、已抽取的随机数个数、食物、分数、每步的时间间隔、
+ *           游戏时间、步数、方向、速度曲线的名字和各部分的位置
+ *   蛇身    QPoint的环形缓冲区，容量为不小于两倍蛇长的2的幂
+ *   位图    每格1位的占用位图（quint64），一页对应OccupancyGrid::BitmapPageCells个格子
+ *   空闲集合 int32的格子序号，保持OccupancyGrid中的顺序，恢复后的食物序列与不中断时相同
+ *
+ * 同一个对象对同一局反复保存时只写变化的部分：蛇身环形缓冲区只写新增的蛇头（蛇尾不用擦掉，
+ * 长度在文件头里），位图和空闲集合只写OccupancyGrid记录的、上次保存后变化过的页，最后写文件头。
+ * 写入期间文件头标记为未完成，进程在保存中途退出时恢复会失败，而不是得到前后不一致的状态。
+ * 区域大小、种子、存储方式改变，蛇长超过环形缓冲区，或者重新开始一局之后，自动改为完整保存。
+ */
+class SnakeCheckpoint
+{
+public:
+    // 最近一次保存的统计
+    struct SaveStats {
+        bool incremental = false;   // 是否为增量保存
+        int pagesWritten = 0;       // 写入的页数（含文件头）
+        int pageCount = 0;          // 文件的总页数
+        qint64 elapsedNs = 0;       // 保存的耗时（纳秒）
+    };
+
+    SnakeCheckpoint();
+
+    /**
+     * @brief 保存引擎的当前状态
+     * @param engine 游戏引擎
+     * @param path 检查点文件的路径
+     * @param error 失败时写入原因，可为nullptr
+     * @return 保存成功返回true
+     *
+     * 与上次保存的是同一个文件和同一局时增量保存，否则完整保存
+     */
+    bool save(const SnakeEngine &engine, const QString &path, QString *error = nullptr);
+
+    /**
+     * @brief 关闭文件，下一次保存为完整保存
+     */
+    void close();
+
+    QString path() const;
+    const SaveStats &lastSave() const;
+
+    /**
+     * @brief 从检查点文件恢复一局
+     * @param path 检查点文件的路径
+     * @param engine 游戏引擎，区域大小、蛇身的存储方式和速度曲线（名字已知时）都按文件设置
+     * @param error 失败时写入原因，可为nullptr
+     * @return 恢复成功返回true；文件无效时引擎不变
+     */
+    static bool load(const QString &path, SnakeEngine *engine, QString *error = nullptr);
+
+private:
+    /**
+     * @brief 重新建立文件并写入全部内容
+     */
+    bool saveFull(const SnakeEngine &engine, QString *error);
+
+    /**
+     * @brief 只写入上次保存后变化的页
+     */
+    bool saveIncremental(const SnakeEngine &engine, QString *error);
+
+    /**
+     * @brief 能否在上次保存的基础上增量保存
+     */
+    bool canSaveIncremental(const SnakeEngine &engine) const;
+
+    /**
+     * @brief 把蛇头开始的count节写入文件中的环形缓冲区（蛇头在m_ringHead）
+     * @return 写入的页数，失败时返回-1
+     */
+    int writeRing(const Snake &snake, int count, QString *error);
+
+    /**
+     * @brief 写入文件头
+     * @param complete 为false时标记为正在写入
+     */
+    bool writeHeader(const SnakeEngine &engine, bool complete, QString *error);
+
+    /**
+     * @brief 在文件的指定位置写入数据
+     */
+    bool writeAt(qint64 offset, const void *data, qint64 size, QString *error);
+
+    /**
+     * @brief 记下本次保存的状态，供下一次增量保存比较
+     */
+    void remember(const SnakeEngine &engine);
+
+private:
+    QFile m_file;               // 打开的检查点文件
+    const SnakeEngine *m_engine; // 上次保存的引擎
+    int m_width;                // 上次保存的区域大小
+    int m_height;
+    quint32 m_seed;             // 上次保存的种子
+    bool m_compact;             // 上次保存时是否使用拐角编码
+    quint64 m_ticks;            // 上次保存时的步数
+    quint64 m_generation;       // 上次保存时占用计数表的清空次数
+    quint64 m_changes;          // 上次保存时占用计数表的变化序号
+    int m_ringCapacity;         // 文件中环形缓冲区的容量
+    int m_ringHead;             // 文件中蛇头的索引
+    qint64 m_ringOffset;        // 各部分在文件中的位置
+    qint64 m_bitmapOffset;
+    qint64 m_freeListOffset;
+    qint64 m_fileSize;          // 文件大小
+    SaveStats m_lastSave;       // 最近一次保存的统计
+};
+
+#endif // SNAKECHECKPOINT_H
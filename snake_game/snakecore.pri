@@ -0,0 +1,32 @@
+# 贪吃蛇核心逻辑（只依赖QtCore），供游戏界面和无界面工具共用
+# 批量环境和多蛇竞技场复用小球碰撞游戏的任务窃取线程池
+INCLUDEPATH += $$PWD $$PWD/../ball_game
+
+SOURCES += \
+    $$PWD/snake.cpp \
+    $$PWD/occupancygrid.cpp \
+    $$PWD/snakerunbody.cpp \
+    $$PWD/speedschedule.cpp \
+    $$PWD/snakeengine.cpp \
+    $$PWD/snakebatch.cpp \
+    $$PWD/snakeautopilot.cpp \
+    $$PWD/snakereplay.cpp \
+    $$PWD/snakearena.cpp \
+    $$PWD/snakeobserver.cpp \
+    $$PWD/snakecheckpoint.cpp \
+    $$PWD/../ball_game/workstealingpool.cpp
+
+HEADERS += \
+    $$PWD/snake.h \
+    $$PWD/occupancygrid.h \
+    $$PWD/snakerunbody.h \
+    $$PWD/speedschedule.h \
+    $$PWD/snakeengine.h \
+    $$PWD/snakebatch.h \
+    $$PWD/snakeautopilot.h \
+    $$PWD/snakereplay.h \
+    $$PWD/snakearena.h \
+    $$PWD/snakeobserver.h \
+    $$PWD/snakecheckpoint.h \
+    $$PWD/snakeboard.h \
+    $$PWD/../ball_game/workstealingpool.h
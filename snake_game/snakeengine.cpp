@@ -0,0 +1,290 @@
+#include "snakeengine.h"
+
+namespace {
+// 每个食物的分数
+const int kFoodScore = 10;
+}
+
+/**
+ * @brief 构造函数
+ * @param seed 随机数种子
+ *
+ * 默认游戏区域为30x20，构造后即可开始推进。
+ */
+SnakeEngine::SnakeEngine(quint32 seed)
+    : m_seed(seed)
+    , m_fieldWidth(30)
+    , m_fieldHeight(20)
+{
+    m_snake.setFieldSize(m_fieldWidth, m_fieldHeight);
+    reset(seed);
+}
+
+/**
+ * @brief 用当前种子重新开始一局
+ */
+void SnakeEngine::reset()
+{
+    reset(m_seed);
+}
+
+/**
+ * @brief 用新的种子重新开始一局
+ * @param seed 随机数种子
+ *
+ * 重置蛇、分数和速度，再用新种子的随机数发生器放置第一个食物。
+ */
+void SnakeEngine::reset(quint32 seed)
+{
+    m_seed = seed;
+    m_random.seed(seed);
+    m_foodDraws = 0;
+    m_snake.reset();
+    m_score = 0;
+    m_elapsedNs = 0;
+    m_gameOver = false;
+    m_gameWon = false;
+    m_ticks = 0;
+    updateInterval();
+    generateFood();
+}
+
+/**
+ * @brief 设置游戏区域大小并重新开始一局
+ * @param width 区域宽度（格子数）
+ * @param height 区域高度（格子数）
+ */
+void SnakeEngine::setFieldSize(int width, int height)
+{
+    m_fieldWidth = qMax(20, width);  // 蛇的初始位置需要至少20x20的区域
+    m_fieldHeight = qMax(20, height);
+    m_snake.setFieldSize(m_fieldWidth, m_fieldHeight);
+    reset();
+}
+
+/**
+ * @brief 设置是否使用拐角编码的蛇身
+ * @param compact 是否使用拐角编码
+ */
+void SnakeEngine::setCompactBody(bool compact)
+{
+    m_snake.setCompactBody(compact);
+}
+
+/**
+ * @brief 设置速度曲线
+ * @param schedule 速度曲线
+ */
+void SnakeEngine::setSpeedSchedule(const SpeedSchedule &schedule)
+{
+    m_schedule = schedule;
+    updateInterval();
+}
+
+const SpeedSchedule &SnakeEngine::speedSchedule() const
+{
+    return m_schedule;
+}
+
+/**
+ * @brief 设置下一步的移动方向
+ * @param dir 移动方向
+ */
+void SnakeEngine::setDirection(Direction dir)
+{
+    m_snake.setDirection(dir);
+}
+
+/**
+ * @brief 按当前方向推进一步
+ * @return 这一步的结果
+ *
+ * 移动蛇，检查撞墙和自身碰撞；吃到食物时增长、加分、放置新食物。
+ * 这一步按原来的时间间隔计入游戏时间，之后按速度曲线查出下一步的时间间隔。
+ */
+SnakeEngine::StepResult SnakeEngine::step()
+{
+    if (m_gameOver) {
+        return m_gameWon ? Won : Died;
+    }
+
+    m_snake.move();
+    ++m_ticks;
+    m_elapsedNs += m_intervalNs;
+
+    if (checkWallCollision() || m_snake.checkSelfCollision()) {
+        m_gameOver = true;
+        return Died;
+    }
+
+    if (m_snake.getHeadPosition() != m_food) {
+        if (m_schedule.basis() == SpeedSchedule::ByTime) {
+            updateInterval();  // 按分数的曲线只在加分时变化
+        }
+        return Moved;
+    }
+
+    m_snake.grow();
+    m_score += kFoodScore;
+    updateInterval();
+
+    // 没有空闲格子说明蛇已占满整个区域
+    if (!generateFood()) {
+        m_gameWon = true;
+        m_gameOver = true;
+        return Won;
+    }
+    return AteFood;
+}
+
+/**
+ * @brief 先设置方向再推进一步
+ * @param dir 移动方向
+ * @return 这一步的结果
+ */
+SnakeEngine::StepResult SnakeEngine::step(Direction dir)
+{
+    m_snake.setDirection(dir);
+    return step();
+}
+
+/**
+ * @brief 从检查点恢复整局的状态
+ * @param state 保存时的状态
+ * @return 成功返回true
+ *
+ * 区域大小必须与setFieldSize()调整后的结果一致（不小于20x20）。QRandomGenerator不能读出内部状态，
+ * 因此按种子重新播种，再跳过生成食物时已抽取的随机数（每个食物恰好抽取一个）。
+ */
+bool SnakeEngine::restore(const State &state)
+{
+    if (state.width != qMax(20, state.width) || state.height != qMax(20, state.height)) {
+        reset(state.seed);
+        return false;
+    }
+    if (state.width != m_fieldWidth || state.height != m_fieldHeight) {
+        m_fieldWidth = state.width;
+        m_fieldHeight = state.height;
+        m_snake.setFieldSize(m_fieldWidth, m_fieldHeight);
+    }
+    if (!m_snake.restore(state.ring, state.ringCapacity, state.ringHead, state.length,
+                         state.direction, state.nextDirection, state.grow,
+                         state.bitmap, state.freeCells, state.freeCount)) {
+        reset(state.seed);
+        return false;
+    }
+
+    m_seed = state.seed;
+    m_random.seed(state.seed);
+    m_random.discard(state.foodDraws);
+    m_foodDraws = state.foodDraws;
+    m_food = state.food;
+    m_score = state.score;
+    m_intervalNs = state.intervalNs;
+    m_elapsedNs = state.elapsedNs;
+    m_ticks = state.ticks;
+    m_gameOver = state.gameOver;
+    m_gameWon = state.gameWon;
+    return true;
+}
+
+const Snake &SnakeEngine::snake() const
+{
+    return m_snake;
+}
+
+QPoint SnakeEngine::food() const
+{
+    return m_food;
+}
+
+int SnakeEngine::score() const
+{
+    return m_score;
+}
+
+int SnakeEngine::interval() const
+{
+    return int((m_intervalNs + 500000) / 1000000);
+}
+
+qint64 SnakeEngine::intervalNs() const
+{
+    return m_intervalNs;
+}
+
+qint64 SnakeEngine::elapsedNs() const
+{
+    return m_elapsedNs;
+}
+
+bool SnakeEngine::isGameOver() const
+{
+    return m_gameOver;
+}
+
+bool SnakeEngine::isWon() const
+{
+    return m_gameWon;
+}
+
+quint32 SnakeEngine::seed() const
+{
+    return m_seed;
+}
+
+quint64 SnakeEngine::tickCount() const
+{
+    return m_ticks;
+}
+
+quint64 SnakeEngine::foodDraws() const
+{
+    return m_foodDraws;
+}
+
+int SnakeEngine::width() const
+{
+    return m_fieldWidth;
+}
+
+int SnakeEngine::height() const
+{
+    return m_fieldHeight;
+}
+
+/**
+ * @brief 生成食物
+ * @return 成功放置食物返回true，没有空闲格子时返回false
+ *
+ * 在空闲格子集合中均匀随机取一个，O(1)，不会因蛇身占满大部分区域而反复重试。
+ */
+bool SnakeEngine::generateFood()
+{
+    const OccupancyGrid &grid = m_snake.occupancy();
+    if (grid.freeCount() == 0) {
+        return false;
+    }
+    m_food = grid.freeCell(m_random.bounded(grid.freeCount()));
+    ++m_foodDraws;
+    return true;
+}
+
+/**
+ * @brief 按速度曲线更新时间间隔
+ */
+void SnakeEngine::updateInterval()
+{
+    m_intervalNs = m_schedule.periodNs(m_score, m_elapsedNs);
+}
+
+/**
+ * @brief 检查是否撞到墙壁
+ * @return 如果蛇头超出游戏区域边界返回true，否则返回false
+ */
+bool SnakeEngine::checkWallCollision() const
+{
+    QPoint head = m_snake.getHeadPosition();
+    return head.x() < 0 || head.x() >= m_fieldWidth ||
+           head.y() < 0 || head.y() >= m_fieldHeight;
+}
@@ -0,0 +1,170 @@
+#ifndef SNAKEENGINE_H
+#define SNAKEENGINE_H
+
+#include <QPoint>
+#include <QRandomGenerator>
+#include "snake.h"
+#include "speedschedule.h"
+
+/**
+ * @brief SnakeEngine类是不依赖界面的贪吃蛇游戏规则
+ *
+ * 持有蛇、食物、分数和速度，实现移动、撞墙、自身碰撞、吃食物、生成食物、通关和加速规则。
+ * 每步的时间间隔由SpeedSchedule按分数或游戏时间查表得到，引擎只记录它，不负责计时。
+ * 只依赖QtCore，没有计时器和信号，调用一次step()就推进一步，可以在无界面的工具、
+ * 训练环境或测试中以每秒数百万步的速度运行。
+ *
+ * 食物位置只由本引擎自己的随机数发生器决定：相同的种子、区域大小和方向序列
+ * 总是得到完全相同的对局。GameBoard只负责把引擎的状态画出来并把按键转成方向。
+ */
+class SnakeEngine
+{
+public:
+    // 检查点恢复时使用的完整状态（数组由调用者持有，restore()返回后不再引用）
+    struct State {
+        int width;                  // 区域宽度
+        int height;                 // 区域高度
+        quint32 seed;               // 本局的随机数种子
+        quint64 foodDraws;          // 生成食物时已抽取的随机数个数
+        QPoint food;                // 食物位置
+        int score;                  // 分数
+        qint64 intervalNs;          // 每步的时间间隔
+        qint64 elapsedNs;           // 游戏时间
+        quint64 ticks;              // 已推进的步数
+        bool gameOver;              // 游戏是否结束
+        bool gameWon;               // 是否通关
+        Direction direction;        // 蛇最近一次移动的方向
+        Direction nextDirection;    // 蛇下一步的方向
+        bool grow;                  // 蛇是否在下一次移动时增长
+        const QPoint *ring;         // 蛇身的环形缓冲区
+        int ringCapacity;           // 环形缓冲区的容量（2的幂）
+        int ringHead;               // 蛇头在环形缓冲区中的索引
+        int length;                 // 蛇的长度
+        const quint64 *bitmap;      // 占用位图
+        const int *freeCells;       // 空闲格子集合
+        int freeCount;              // 空闲格子数
+    };
+
+    // 一步的结果
+    enum StepResult {
+        Moved,    // 正常移动
+        AteFood,  // 吃到食物
+        Died,     // 撞墙或撞到自己，游戏结束
+        Won       // 蛇占满整个区域，游戏结束
+    };
+
+    /**
+     * @brief 构造函数
+     * @param seed 随机数种子
+     */
+    explicit SnakeEngine(quint32 seed = 0);
+
+    /**
+     * @brief 用当前种子重新开始一局
+     */
+    void reset();
+
+    /**
+     * @brief 用新的种子重新开始一局
+     * @param seed 随机数种子
+     */
+    void reset(quint32 seed);
+
+    /**
+     * @brief 设置游戏区域大小并重新开始一局
+     * @param width 区域宽度（格子数），至少为20
+     * @param height 区域高度（格子数），至少为20
+     */
+    void setFieldSize(int width, int height);
+
+    /**
+     * @brief 设置是否使用拐角编码的蛇身
+     * @param compact 是否使用拐角编码
+     */
+    void setCompactBody(bool compact);
+
+    /**
+     * @brief 设置速度曲线（立即按当前分数和游戏时间生效，重新开始一局后保留）
+     * @param schedule 速度曲线
+     */
+    void setSpeedSchedule(const SpeedSchedule &schedule);
+    const SpeedSchedule &speedSchedule() const;
+
+    /**
+     * @brief 设置下一步的移动方向（不能直接180度转向）
+     * @param dir 移动方向
+     */
+    void setDirection(Direction dir);
+
+    /**
+     * @brief 按当前方向推进一步
+     * @return 这一步的结果；游戏已结束时不再移动，直接返回结束的原因
+     */
+    StepResult step();
+
+    /**
+     * @brief 先设置方向再推进一步
+     * @param dir 移动方向
+     * @return 这一步的结果
+     */
+    StepResult step(Direction dir);
+
+    /**
+     * @brief 从检查点恢复整局的状态
+     * @param state 保存时的状态
+     * @return 成功返回true；数据不一致或区域大小不合法时用state中的种子重新开始一局并返回false
+     *
+     * 速度曲线和蛇身的存储方式保持不变。随机数发生器按种子重新播种后跳过已抽取的个数，
+     * 恢复后的食物序列与不中断时完全相同。
+     */
+    bool restore(const State &state);
+
+    const Snake &snake() const;
+    QPoint food() const;
+    int score() const;
+    int interval() const;       // 当前每步的时间间隔（毫秒，四舍五入），随分数增加而缩短
+    qint64 intervalNs() const;  // 当前每步的时间间隔（纳秒）
+    qint64 elapsedNs() const;   // 游戏时间：已推进各步的时间间隔之和（纳秒）
+    bool isGameOver() const;
+    bool isWon() const;
+    quint32 seed() const;
+    quint64 tickCount() const;  // 本局已推进的步数
+    quint64 foodDraws() const;  // 本局生成食物时已抽取的随机数个数
+    int width() const;
+    int height() const;
+
+private:
+    /**
+     * @brief 从空闲格子集合中均匀抽取食物位置
+     * @return 成功放置食物返回true；没有空闲格子时返回false
+     */
+    bool generateFood();
+
+    /**
+     * @brief 按速度曲线更新时间间隔
+     */
+    void updateInterval();
+
+    /**
+     * @brief 检查蛇头是否超出游戏区域
+     */
+    bool checkWallCollision() const;
+
+private:
+    Snake m_snake;              // 蛇对象
+    QRandomGenerator m_random;  // 只用于生成食物的随机数发生器
+    quint32 m_seed;             // 本局的随机数种子
+    quint64 m_foodDraws;        // 生成食物时已抽取的随机数个数
+    QPoint m_food;              // 食物位置
+    int m_score;                // 当前分数
+    SpeedSchedule m_schedule;   // 速度曲线
+    qint64 m_intervalNs;        // 每步的时间间隔（纳秒）
+    qint64 m_elapsedNs;         // 游戏时间（纳秒）
+    int m_fieldWidth;           // 游戏区域宽度（格子数）
+    int m_fieldHeight;          // 游戏区域高度（格子数）
+    bool m_gameOver;            // 游戏是否结束
+    bool m_gameWon;             // 是否通关
+    quint64 m_ticks;            // 本局已推进的步数
+};
+
+#endif // SNAKEENGINE_H
@@ -0,0 +1,338 @@
+#include "snakeobserver.h"
+#include "snakebatch.h"
+#include "snakeboard.h"
+#include <cstring>
+
+namespace {
+// 左转、右转后的方向（右转后前进一格即为原方向的右侧）
+const Direction kTurnLeft[4] = {Left, Right, Down, Up};
+const Direction kTurnRight[4] = {Right, Left, Up, Down};
+
+// 宽区域按SnakeBits::floodFill需要的接口包装一块线性的位棋盘
+struct LinearBoard {
+    const quint64 *occupied;
+    int columns;
+    int words;
+    const quint64 *notFirst;
+    const quint64 *notLast;
+    const quint64 *valid;
+
+    int wordCount() const { return words; }
+    int width() const { return columns; }
+    const quint64 *bits() const { return occupied; }
+    const quint64 *notFirstColumn() const { return notFirst; }
+    const quint64 *notLastColumn() const { return notLast; }
+    const quint64 *validMask() const { return valid; }
+};
+}
+
+/**
+ * @brief 构造函数
+ * @param boardCount 棋盘数量
+ * @param width 区域宽度
+ * @param height 区域高度
+ * @param cropSize 窗口边长
+ *
+ * 预先算好每个朝向下窗口各格相对蛇头的偏移：窗口第i行第j列在蛇头前方cropSize/2-i格、
+ * 右侧j-cropSize/2格。宽度超过64时再算出宽区域搜索用的掩码。
+ */
+SnakeObserver::SnakeObserver(int boardCount, int width, int height, int cropSize)
+    : m_boardCount(qMax(0, boardCount))
+    , m_width(qMax(1, width))
+    , m_height(qMax(1, height))
+    , m_cells(m_width * m_height)
+    , m_words((m_cells + 63) / 64)
+    , m_rowFill(m_width <= 64)
+    , m_rowMask(m_width == 64 ? ~quint64(0) : (quint64(1) << qMin(m_width, 63)) - 1)
+    , m_cropSize(qMax(1, cropSize) | 1)
+    , m_pool(nullptr)
+    , m_features(m_boardCount * FeatureCount, 0.0f)
+    , m_crops(m_boardCount * m_cropSize * m_cropSize, Empty)
+{
+    const int center = m_cropSize / 2;
+    for (int dir = Up; dir <= Right; ++dir) {
+        m_cropOffsets[dir].reserve(m_cropSize * m_cropSize);
+        for (int i = 0; i < m_cropSize; ++i) {
+            for (int j = 0; j < m_cropSize; ++j) {
+                const int ahead = center - i;
+                const int right = j - center;
+                m_cropOffsets[dir].append(QPoint(directionDx(dir) * ahead + directionDx(kTurnRight[dir]) * right,
+                                                 directionDy(dir) * ahead + directionDy(kTurnRight[dir]) * right));
+            }
+        }
+    }
+
+    if (!m_rowFill) {
+        m_notFirstColumn.fill(0, m_words);
+        m_notLastColumn.fill(0, m_words);
+        m_valid.fill(0, m_words);
+        for (int cell = 0; cell < m_cells; ++cell) {
+            SnakeBits::setBit(m_valid.data(), cell);
+            if (cell % m_width != 0) {
+                SnakeBits::setBit(m_notFirstColumn.data(), cell);
+            }
+            if (cell % m_width != m_width - 1) {
+                SnakeBits::setBit(m_notLastColumn.data(), cell);
+            }
+        }
+    }
+}
+
+void SnakeObserver::setThreadPool(WorkStealingPool *pool)
+{
+    m_pool = pool;
+}
+
+/**
+ * @brief 编码一个棋盘
+ * @param slot 写入输出数组的位置
+ * @param bits 占用位棋盘
+ * @param head 蛇头的格子序号
+ * @param direction 蛇头的朝向
+ * @param food 食物的格子序号
+ * @param length 蛇的长度
+ */
+void SnakeObserver::encode(int slot, const quint64 *bits, int head, Direction direction, int food, int length)
+{
+    if (slot < 0 || slot >= m_boardCount) {
+        return;
+    }
+    Workspace workspace = makeWorkspace();
+    encodeBoard(slot, bits, head, direction, food, length, workspace);
+}
+
+/**
+ * @brief 编码批量环境的所有棋盘
+ * @param batch 批量环境
+ *
+ * 与SnakeBatch::step()一样按棋盘分块，每个线程约4块；每块创建一份工作区，
+ * 只写入自己棋盘的那一段输出。
+ */
+void SnakeObserver::encode(const SnakeBatch &batch)
+{
+    if (batch.width() != m_width || batch.height() != m_height) {
+        return;
+    }
+    const int count = qMin(batch.boardCount(), m_boardCount);
+    auto body = [this, &batch](int begin, int end) {
+        Workspace workspace = makeWorkspace();
+        for (int board = begin; board < end; ++board) {
+            const QPoint head = batch.head(board);
+            const QPoint food = batch.food(board);
+            encodeBoard(board, batch.occupancyBits(board), head.y() * m_width + head.x(), batch.direction(board),
+                        food.y() * m_width + food.x(), batch.length(board), workspace);
+        }
+    };
+
+    if (m_pool) {
+        m_pool->parallelFor(count, 0, body);  // 块大小由线程池按线程数决定
+    } else if (count > 0) {
+        body(0, count);
+    }
+}
+
+int SnakeObserver::boardCount() const
+{
+    return m_boardCount;
+}
+
+int SnakeObserver::width() const
+{
+    return m_width;
+}
+
+int SnakeObserver::height() const
+{
+    return m_height;
+}
+
+int SnakeObserver::cropSize() const
+{
+    return m_cropSize;
+}
+
+int SnakeObserver::cropCells() const
+{
+    return m_cropSize * m_cropSize;
+}
+
+const float *SnakeObserver::features() const
+{
+    return m_features.constData();
+}
+
+const quint8 *SnakeObserver::crops() const
+{
+    return m_crops.constData();
+}
+
+/**
+ * @brief 创建大小合适的工作区
+ * @return 按行搜索时每块height+2个字（首尾为哨兵行），否则为位棋盘的字数
+ */
+SnakeObserver::Workspace SnakeObserver::makeWorkspace() const
+{
+    Workspace workspace;
+    const int size = m_rowFill ? m_height + 2 : m_words;
+    workspace.free.fill(0, m_height + 2);
+    for (QVector<quint64> &fill : workspace.fills) {
+        fill.fill(0, size);
+    }
+    workspace.scratch.fill(0, m_rowFill ? size : 2 * size);  // 宽区域搜索需要两块：当前一层和下一层
+    return workspace;
+}
+
+/**
+ * @brief 编码一个棋盘
+ *
+ * 按行搜索时先把位棋盘拆成每行一个字的空闲格子表。前、左、右三个相邻格子中，
+ * 已经出现在前一次搜索结果里的格子与它连通，直接沿用那次的格子数。
+ */
+void SnakeObserver::encodeBoard(int slot, const quint64 *bits, int head, Direction direction, int food, int length,
+                                Workspace &workspace)
+{
+    int freeCount = 0;
+    if (m_rowFill) {
+        quint64 *free = workspace.free.data();
+        for (int y = 0; y < m_height; ++y) {
+            const int start = y * m_width;
+            const int word = start >> 6;
+            const int offset = start & 63;
+            quint64 row = bits[word] >> offset;
+            if (offset + m_width > 64) {
+                row |= bits[word + 1] << (64 - offset);
+            }
+            free[y + 1] = ~row & m_rowMask;
+            freeCount += int(qPopulationCount(free[y + 1]));
+        }
+    } else {
+        int occupied = 0;
+        for (int w = 0; w < m_words; ++w) {
+            occupied += int(qPopulationCount(bits[w] & m_valid.at(w)));
+        }
+        freeCount = m_cells - occupied;
+    }
+
+    const int headX = head % m_width;
+    const int headY = head / m_width;
+    float *features = m_features.data() + slot * FeatureCount;
+
+    // 前、左、右三个相邻格子
+    const Direction moves[3] = {direction, kTurnLeft[direction], kTurnRight[direction]};
+    int counts[3];
+    int fills = 0;
+    for (int k = 0; k < 3; ++k) {
+        const int x = headX + directionDx(moves[k]);
+        const int y = headY + directionDy(moves[k]);
+        const bool danger = unsigned(x) >= unsigned(m_width) || unsigned(y) >= unsigned(m_height)
+                || SnakeBits::testBit(bits, y * m_width + x);
+        float area = 0.0f;
+        if (!danger) {
+            const int cell = y * m_width + x;
+            int count = -1;
+            for (int j = 0; j < fills && count < 0; ++j) {
+                if (inFill(workspace, j, cell)) {
+                    count = counts[j];
+                }
+            }
+            if (count < 0) {
+                count = reachable(bits, cell, workspace, fills);
+                counts[fills++] = count;
+            }
+            area = freeCount > 0 ? float(count) / freeCount : 0.0f;
+        }
+        features[DangerAhead + k] = danger ? 1.0f : 0.0f;
+        features[AreaAhead + k] = area;
+    }
+
+    // 食物的相对位置：投影到蛇头的前方和右侧
+    if (food >= 0) {
+        const int dx = food % m_width - headX;
+        const int dy = food / m_width - headY;
+        const float side = float(qMax(m_width, m_height));
+        const Direction right = kTurnRight[direction];
+        features[FoodAhead] = (dx * directionDx(direction) + dy * directionDy(direction)) / side;
+        features[FoodRight] = (dx * directionDx(right) + dy * directionDy(right)) / side;
+        features[FoodDistance] = float(qAbs(dx) + qAbs(dy)) / (m_width + m_height);
+    } else {
+        features[FoodAhead] = 0.0f;
+        features[FoodRight] = 0.0f;
+        features[FoodDistance] = 0.0f;
+    }
+    features[Length] = float(length) / m_cells;
+
+    // 以蛇头为中心、蛇头朝上的窗口
+    quint8 *crop = m_crops.data() + slot * cropCells();
+    const QPoint *offsets = m_cropOffsets[direction].constData();
+    for (int i = 0; i < cropCells(); ++i) {
+        const int x = headX + offsets[i].x();
+        const int y = headY + offsets[i].y();
+        if (unsigned(x) >= unsigned(m_width) || unsigned(y) >= unsigned(m_height)) {
+            crop[i] = Wall;
+        } else {
+            const int cell = y * m_width + x;
+            crop[i] = cell == food ? Food : SnakeBits::testBit(bits, cell) ? Body : Empty;
+        }
+    }
+    crop[cropCells() / 2] = Head;
+}
+
+/**
+ * @brief 从一个空闲格子出发统计可到达的空闲格子数
+ *
+ * 按行搜索：每一轮把已到达的格子向左右移一位、与上下两行相或，再与空闲格子相与，
+ * 所有行的运算相同且互不依赖（结果写入另一块缓冲区），直到没有新的格子为止。
+ */
+int SnakeObserver::reachable(const quint64 *bits, int cell, Workspace &workspace, int index) const
+{
+    QVector<quint64> &result = workspace.fills[index];
+    if (!m_rowFill) {
+        result.fill(0);
+        quint64 *frontier = workspace.scratch.data();
+        quint64 *next = frontier + m_words;
+        std::memset(frontier, 0, sizeof(quint64) * 2 * m_words);
+        const LinearBoard board = {bits, m_width, m_words, m_notFirstColumn.constData(),
+                                   m_notLastColumn.constData(), m_valid.constData()};
+        return SnakeBits::floodFill(board, cell, result.data(), frontier, next);
+    }
+
+    const quint64 *free = workspace.free.constData();
+    quint64 *reach = result.data();
+    quint64 *next = workspace.scratch.data();
+    std::memset(reach, 0, sizeof(quint64) * (m_height + 2));
+    reach[cell / m_width + 1] = quint64(1) << (cell % m_width);
+    for (;;) {
+        quint64 changed = 0;
+        for (int y = 1; y <= m_height; ++y) {
+            const quint64 row = reach[y];
+            const quint64 spread = (row | (row << 1) | (row >> 1) | reach[y - 1] | reach[y + 1]) & free[y];
+            next[y] = spread;
+            changed |= spread ^ row;
+        }
+        qSwap(reach, next);
+        if (!changed) {
+            break;
+        }
+    }
+
+    int count = 0;
+    for (int y = 1; y <= m_height; ++y) {
+        count += int(qPopulationCount(reach[y]));
+    }
+    if (reach != result.data()) {
+        std::memcpy(result.data() + 1, reach + 1, sizeof(quint64) * m_height);
+    }
+    return count;
+}
+
+/**
+ * @brief 检查格子是否在某次搜索的结果中
+ */
+bool SnakeObserver::inFill(const Workspace &workspace, int index, int cell) const
+{
+    const quint64 *fill = workspace.fills[index].constData();
+    if (m_rowFill) {
+        return (fill[cell / m_width + 1] >> (cell % m_width)) & 1;
+    }
+    return SnakeBits::testBit(fill, cell);
+}
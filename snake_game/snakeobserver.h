@@ -0,0 +1,155 @@
+#ifndef SNAKEOBSERVER_H
+#define SNAKEOBSERVER_H
+
+#include <QPoint>
+#include <QVector>
+#include "snake.h"
+#include "workstealingpool.h"
+
+class SnakeBatch;
+
+/**
+ * @brief SnakeObserver类把贪吃蛇棋盘编码成AI使用的观测
+ *
+ * 每个棋盘得到两部分，分别连续存放在一块数组中，可以直接交给训练代码：
+ *   - 特征向量[棋盘][Feature]（float）：以蛇头朝向为准的前、左、右三个方向是否危险，
+ *     从这三个相邻格子出发可到达的空闲格子占比，食物的相对位置和距离，蛇的长度；
+ *   - 以蛇头为中心、旋转到蛇头朝上的固定大小窗口[棋盘][行][列]（Cell取值，quint8），
+ *     区域外的格子记为Wall。
+ *
+ * 输入是占用位棋盘（格子序号为y*宽度+x，蛇尾按占用处理）。区域宽度不超过64时，
+ * 可到达区域的搜索把每一行放在一个64位字中：每一轮对所有行做同样的移位、或和与运算，
+ * 没有分支，编译器可以向量化，最后用popcount数出格子数；前、左、右三个格子连通时
+ * 只搜索一次。更宽的区域使用SnakeBits::floodFill。
+ *
+ * 批量编码时按棋盘分块在任务窃取线程池上并行，每块使用自己的工作区。
+ */
+class SnakeObserver
+{
+public:
+    // 特征向量中各项的位置
+    enum Feature {
+        DangerAhead,    // 前方一格撞墙或撞到蛇身（1或0）
+        DangerLeft,     // 左侧一格
+        DangerRight,    // 右侧一格
+        AreaAhead,      // 从前方一格出发可到达的空闲格子数/空闲格子总数，危险时为0
+        AreaLeft,       // 从左侧一格出发
+        AreaRight,      // 从右侧一格出发
+        FoodAhead,      // 食物在前方的距离/区域的较长边（在后方时为负）
+        FoodRight,      // 食物在右侧的距离/区域的较长边（在左侧时为负）
+        FoodDistance,   // 到食物的曼哈顿距离/(宽度+高度)
+        Length,         // 蛇的长度/格子数
+        FeatureCount
+    };
+
+    // 窗口中格子的取值（前四项与SnakeBatch::Cell相同）
+    enum Cell : quint8 {
+        Empty = 0,  // 空格子
+        Body = 1,   // 蛇身
+        Head = 2,   // 蛇头（窗口中央）
+        Food = 3,   // 食物
+        Wall = 4    // 区域外
+    };
+
+    /**
+     * @brief 构造函数
+     * @param boardCount 编码的棋盘数量（输出数组的容量）
+     * @param width 区域宽度（格子数）
+     * @param height 区域高度（格子数）
+     * @param cropSize 窗口边长（格子数），偶数时加1，使蛇头位于中央
+     */
+    SnakeObserver(int boardCount, int width, int height, int cropSize = 11);
+
+    /**
+     * @brief 设置批量编码时使用的线程池
+     * @param pool 线程池，为nullptr时在调用线程串行编码；由调用者持有
+     */
+    void setThreadPool(WorkStealingPool *pool);
+
+    /**
+     * @brief 编码一个棋盘
+     * @param slot 写入输出数组的位置（棋盘序号）
+     * @param bits 占用位棋盘，(width*height+63)/64个字
+     * @param head 蛇头的格子序号
+     * @param direction 蛇头的朝向
+     * @param food 食物的格子序号，没有食物时为-1
+     * @param length 蛇的长度
+     */
+    void encode(int slot, const quint64 *bits, int head, Direction direction, int food, int length);
+
+    /**
+     * @brief 编码批量环境的所有棋盘
+     * @param batch 批量环境，区域大小与本对象不同时不编码；棋盘数超过boardCount()时只编码前面的
+     */
+    void encode(const SnakeBatch &batch);
+
+    int boardCount() const;
+    int width() const;
+    int height() const;
+    int cropSize() const;
+    int cropCells() const;      // 每个窗口的格子数（cropSize*cropSize）
+
+    /**
+     * @brief 获取所有棋盘的特征向量
+     * @return 连续的boardCount()*FeatureCount个float
+     */
+    const float *features() const;
+
+    /**
+     * @brief 获取所有棋盘的窗口
+     * @return 连续的boardCount()*cropCells()个Cell取值
+     */
+    const quint8 *crops() const;
+
+private:
+    // 一次编码的工作区（每个线程一份）
+    struct Workspace {
+        QVector<quint64> free;      // 每行的空闲格子（首尾各一行全零的哨兵）
+        QVector<quint64> fills[3];  // 前、左、右三次搜索的结果
+        QVector<quint64> scratch;   // 搜索时交替使用的缓冲区
+    };
+
+    /**
+     * @brief 创建大小合适的工作区
+     */
+    Workspace makeWorkspace() const;
+
+    /**
+     * @brief 编码一个棋盘（使用给定的工作区）
+     */
+    void encodeBoard(int slot, const quint64 *bits, int head, Direction direction, int food, int length,
+                     Workspace &workspace);
+
+    /**
+     * @brief 从一个空闲格子出发统计可到达的空闲格子数
+     * @param bits 占用位棋盘
+     * @param cell 起点的格子序号
+     * @param workspace 工作区，结果留在workspace.fills[index]中
+     * @param index 使用的结果缓冲区
+     */
+    int reachable(const quint64 *bits, int cell, Workspace &workspace, int index) const;
+
+    /**
+     * @brief 检查格子是否在某次搜索的结果中
+     */
+    bool inFill(const Workspace &workspace, int index, int cell) const;
+
+private:
+    int m_boardCount;               // 棋盘数量
+    int m_width;                    // 区域宽度
+    int m_height;                   // 区域高度
+    int m_cells;                    // 格子数
+    int m_words;                    // 位棋盘字数
+    bool m_rowFill;                 // 宽度不超过64，按行搜索
+    quint64 m_rowMask;              // 一行中有效的位
+    int m_cropSize;                 // 窗口边长
+    WorkStealingPool *m_pool;       // 线程池（可为nullptr）
+    QVector<QPoint> m_cropOffsets[4]; // 每个朝向下窗口各格相对蛇头的偏移
+    QVector<quint64> m_notFirstColumn; // 宽区域搜索用的列掩码和区域掩码
+    QVector<quint64> m_notLastColumn;
+    QVector<quint64> m_valid;
+    QVector<float> m_features;      // 特征向量
+    QVector<quint8> m_crops;        // 窗口
+};
+
+#endif // SNAKEOBSERVER_H
@@ -0,0 +1,373 @@
+#include "snakereplay.h"
+#include <QElapsedTimer>
+#include <QFile>
+#include <climits>
+
+namespace {
+// 文件头的魔数和版本
+const char kMagic[] = "SNKR";
+const quint8 kVersion = 1;
+// 标志位
+const quint8 kFlagFinished = 1;
+const quint8 kFlagWon = 2;
+// 区域边长和格子数的上限，防止错误数据导致分配过多内存或格子数溢出int
+const quint64 kMaxSide = 1 << 16;
+const quint64 kMaxCells = 1 << 26;  // 8192x8192，覆盖--board能用的区域（如4096x4096）
+
+void writeVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+// 字节读取器，越界后ok()返回false，之后的读取都返回0
+class Reader
+{
+public:
+    explicit Reader(const QByteArray &data) : m_data(data), m_pos(0), m_ok(true) {}
+
+    bool ok() const { return m_ok; }
+    int position() const { return m_pos; }
+
+    quint8 byte()
+    {
+        if (m_pos >= m_data.size()) {
+            m_ok = false;
+            return 0;
+        }
+        return quint8(m_data[m_pos++]);
+    }
+
+    quint32 word()
+    {
+        quint32 value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= quint32(byte()) << (8 * i);
+        }
+        return value;
+    }
+
+    quint64 varint()
+    {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const quint8 b = byte();
+            value |= quint64(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        m_ok = false;
+        return 0;
+    }
+
+private:
+    const QByteArray &m_data;
+    int m_pos;
+    bool m_ok;
+};
+
+void setError(QString *error, const QString &message)
+{
+    if (error) {
+        *error = message;
+    }
+}
+}
+
+/**
+ * @brief 构造函数，得到一个空的回放
+ */
+SnakeReplay::SnakeReplay()
+    : m_width(0)
+    , m_height(0)
+    , m_seed(0)
+    , m_ticks(0)
+    , m_score(0)
+    , m_length(0)
+    , m_finished(false)
+    , m_won(false)
+{
+}
+
+/**
+ * @brief 从引擎的当前状态开始录制
+ * @param engine 游戏引擎
+ *
+ * 记录种子和区域大小，清除之前录制的方向。
+ */
+void SnakeReplay::start(const SnakeEngine &engine)
+{
+    m_width = engine.width();
+    m_height = engine.height();
+    m_seed = engine.seed();
+    m_ticks = 0;
+    m_score = 0;
+    m_length = 0;
+    m_finished = false;
+    m_won = false;
+    m_moves.clear();
+}
+
+/**
+ * @brief 记录一步实际移动的方向
+ * @param dir 这一步蛇头移动的方向
+ */
+void SnakeReplay::record(Direction dir)
+{
+    const int shift = int(m_ticks & 3) * 2;
+    if (shift == 0) {
+        m_moves.append(char(0));
+    }
+    m_moves.data()[m_moves.size() - 1] |= char(quint8(dir & 3) << shift);
+    ++m_ticks;
+}
+
+/**
+ * @brief 记录结束时的分数、长度和结果
+ * @param engine 游戏引擎
+ */
+void SnakeReplay::finish(const SnakeEngine &engine)
+{
+    m_score = engine.score();
+    m_length = engine.snake().length();
+    m_finished = engine.isGameOver();
+    m_won = engine.isWon();
+}
+
+bool SnakeReplay::isEmpty() const
+{
+    return m_ticks == 0;
+}
+
+bool SnakeReplay::isFinished() const
+{
+    return m_finished;
+}
+
+bool SnakeReplay::isWon() const
+{
+    return m_won;
+}
+
+int SnakeReplay::width() const
+{
+    return m_width;
+}
+
+int SnakeReplay::height() const
+{
+    return m_height;
+}
+
+quint32 SnakeReplay::seed() const
+{
+    return m_seed;
+}
+
+quint64 SnakeReplay::tickCount() const
+{
+    return m_ticks;
+}
+
+int SnakeReplay::score() const
+{
+    return m_score;
+}
+
+int SnakeReplay::length() const
+{
+    return m_length;
+}
+
+Direction SnakeReplay::directionAt(quint64 tick) const
+{
+    return Direction((quint8(m_moves.at(int(tick >> 2))) >> (int(tick & 3) * 2)) & 3);
+}
+
+/**
+ * @brief 序列化为紧凑的字节序列
+ * @return 文件头加每步2位的方向
+ */
+QByteArray SnakeReplay::toByteArray() const
+{
+    QByteArray out;
+    out.reserve(32 + m_moves.size());
+    out.append(kMagic, 4);
+    out.append(char(kVersion));
+    out.append(char((m_finished ? kFlagFinished : 0) | (m_won ? kFlagWon : 0)));
+    writeVarint(out, quint64(m_width));
+    writeVarint(out, quint64(m_height));
+    for (int i = 0; i < 4; i++) {
+        out.append(char((m_seed >> (8 * i)) & 0xff));
+    }
+    writeVarint(out, m_ticks);
+    writeVarint(out, quint64(m_score));
+    writeVarint(out, quint64(m_length));
+    out.append(m_moves);
+    return out;
+}
+
+/**
+ * @brief 从字节序列解析回放
+ * @param data 字节序列
+ * @param error 解析失败时写入原因
+ * @return 解析成功返回true，失败时回放保持不变
+ */
+bool SnakeReplay::fromByteArray(const QByteArray &data, QString *error)
+{
+    if (data.size() < 6 || !data.startsWith(kMagic)) {
+        setError(error, QStringLiteral("不是回放文件"));
+        return false;
+    }
+    if (quint8(data.at(4)) != kVersion) {
+        setError(error, QStringLiteral("不支持的回放版本%1").arg(quint8(data.at(4))));
+        return false;
+    }
+
+    Reader reader(data);
+    for (int i = 0; i < 5; i++) {
+        reader.byte();
+    }
+    const quint8 flags = reader.byte();
+    const quint64 width = reader.varint();
+    const quint64 height = reader.varint();
+    const quint32 seed = reader.word();
+    const quint64 ticks = reader.varint();
+    const quint64 score = reader.varint();
+    const quint64 length = reader.varint();
+    if (!reader.ok()) {
+        setError(error, QStringLiteral("文件头不完整"));
+        return false;
+    }
+    if (width == 0 || height == 0 || width > kMaxSide || height > kMaxSide || width * height > kMaxCells
+        || score > quint64(INT_MAX) || length > width * height) {
+        setError(error, QStringLiteral("文件头数据无效"));
+        return false;
+    }
+    const quint64 moveBytes = (ticks + 3) / 4;
+    if (ticks > quint64(INT_MAX) * 4 || quint64(data.size() - reader.position()) != moveBytes) {
+        setError(error, QStringLiteral("方向数据长度与步数不符"));
+        return false;
+    }
+
+    m_width = int(width);
+    m_height = int(height);
+    m_seed = seed;
+    m_ticks = ticks;
+    m_score = int(score);
+    m_length = int(length);
+    m_finished = flags & kFlagFinished;
+    m_won = flags & kFlagWon;
+    m_moves = data.mid(reader.position());
+    return true;
+}
+
+/**
+ * @brief 保存到文件
+ * @param path 文件路径
+ * @return 写入成功返回true
+ */
+bool SnakeReplay::save(const QString &path) const
+{
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    const QByteArray data = toByteArray();
+    return file.write(data) == data.size();
+}
+
+/**
+ * @brief 从文件读取
+ * @param path 文件路径
+ * @param error 失败时写入原因
+ * @return 读取并解析成功返回true
+ */
+bool SnakeReplay::load(const QString &path, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        setError(error, file.errorString());
+        return false;
+    }
+    return fromByteArray(file.readAll(), error);
+}
+
+/**
+ * @brief 在无界面的引擎上重新推进整局并与记录的结果比较
+ * @param tickNs 不为nullptr时写入每一步的耗时
+ * @return 校验结果
+ *
+ * 按种子和区域大小重置引擎，逐字节取出4步的方向推进。每一步都检查蛇头确实按记录的
+ * 方向移动（伪造的180度转向会被引擎忽略，这里直接判为无效），并且对局不能提前结束；
+ * 最后比较分数、长度和结束状态。
+ */
+SnakeReplay::Verification SnakeReplay::verify(QVector<qint64> *tickNs) const
+{
+    Verification result;
+    if (m_width < 20 || m_height < 20) {
+        result.error = QStringLiteral("区域%1x%2小于20x20").arg(m_width).arg(m_height);
+        return result;
+    }
+    if (quint64(m_width) * quint64(m_height) > kMaxCells) {
+        result.error = QStringLiteral("区域%1x%2超过%3格").arg(m_width).arg(m_height).arg(kMaxCells);
+        return result;
+    }
+
+    SnakeEngine engine(m_seed);
+    engine.setFieldSize(m_width, m_height);
+    if (tickNs) {
+        tickNs->resize(int(m_ticks));
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 last = 0;
+    const quint8 *moves = reinterpret_cast<const quint8 *>(m_moves.constData());
+    for (quint64 tick = 0; tick < m_ticks; ++tick) {
+        if (engine.isGameOver()) {
+            result.error = QStringLiteral("对局在第%1步提前结束").arg(tick);
+            break;
+        }
+        const Direction dir = Direction((moves[tick >> 2] >> (int(tick & 3) * 2)) & 3);
+        engine.step(dir);
+        if (engine.snake().direction() != dir) {
+            result.error = QStringLiteral("第%1步是无效的180度转向").arg(tick);
+            break;
+        }
+        if (tickNs) {
+            const qint64 now = timer.nsecsElapsed();
+            (*tickNs)[int(tick)] = now - last;
+            if (now - last > result.slowestTickNs) {
+                result.slowestTickNs = now - last;
+                result.slowestTick = tick;
+            }
+            last = now;
+        }
+    }
+    result.elapsedNs = timer.nsecsElapsed();
+    result.ticks = engine.tickCount();
+    result.score = engine.score();
+    result.length = engine.snake().length();
+    if (!result.error.isEmpty()) {
+        return result;
+    }
+
+    if (m_finished && !engine.isGameOver()) {
+        result.error = QStringLiteral("记录为已结束，但重新推进后对局仍在进行");
+    } else if (!m_finished && engine.isGameOver()) {
+        result.error = QStringLiteral("记录为未结束，但重新推进后对局已结束");
+    } else if (m_finished && m_won != engine.isWon()) {
+        result.error = QStringLiteral("通关状态不一致");
+    } else if (result.score != m_score || result.length != m_length) {
+        result.error = QStringLiteral("分数或长度不一致：记录为%1分/%2节，重新推进为%3分/%4节")
+                           .arg(m_score).arg(m_length).arg(result.score).arg(result.length);
+    } else {
+        result.ok = true;
+    }
+    return result;
+}
@@ -0,0 +1,105 @@
+#ifndef SNAKEREPLAY_H
+#define SNAKEREPLAY_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include "snakeengine.h"
+
+/**
+ * @brief SnakeReplay类记录和校验一局贪吃蛇的回放
+ *
+ * SnakeEngine的对局只由种子、区域大小和每一步的方向决定，因此回放只保存这些：
+ * 每一步的方向占2位，一个字节存4步，一局几十万步的回放也只有几十KB。
+ * 文件中同时保存结束时的分数、长度和结果，校验时在无界面的引擎上按种子和方向
+ * 重新推进（每秒数百万步），结果一致才算有效，可以廉价地验证排行榜提交的成绩。
+ *
+ * 校验时还可以记录每一步的耗时，用于复现玩家报告的偶发卡顿。
+ *
+ * 文件格式（整数均为小端，varint为每字节7位的变长整数）：
+ *   "SNKR" 版本(1字节) 标志(1字节，bit0已结束 bit1通关)
+ *   宽度(varint) 高度(varint) 种子(4字节) 步数(varint) 分数(varint) 长度(varint)
+ *   方向(每步2位，从字节的低位开始，共(步数+3)/4字节)
+ */
+class SnakeReplay
+{
+public:
+    // 校验的结果
+    struct Verification {
+        bool ok = false;            // 重新推进的结果是否与回放记录的一致
+        QString error;              // 不一致的原因
+        quint64 ticks = 0;          // 实际推进的步数
+        int score = 0;              // 重新推进得到的分数
+        int length = 0;             // 重新推进得到的长度
+        qint64 elapsedNs = 0;       // 重新推进的总耗时（纳秒）
+        quint64 slowestTick = 0;    // 最慢的一步（记录每步耗时时有效）
+        qint64 slowestTickNs = 0;   // 最慢一步的耗时（纳秒）
+    };
+
+    SnakeReplay();
+
+    /**
+     * @brief 从引擎的当前状态开始录制（引擎应刚刚重置）
+     * @param engine 游戏引擎
+     */
+    void start(const SnakeEngine &engine);
+
+    /**
+     * @brief 记录一步实际移动的方向
+     * @param dir 这一步蛇头移动的方向（Snake::direction()）
+     */
+    void record(Direction dir);
+
+    /**
+     * @brief 记录结束时的分数、长度和结果
+     * @param engine 游戏引擎
+     */
+    void finish(const SnakeEngine &engine);
+
+    bool isEmpty() const;
+    bool isFinished() const;        // 是否已调用finish()
+    bool isWon() const;
+    int width() const;
+    int height() const;
+    quint32 seed() const;
+    quint64 tickCount() const;
+    int score() const;              // 录制时结束的分数
+    int length() const;             // 录制时结束的长度
+    Direction directionAt(quint64 tick) const;
+
+    /**
+     * @brief 序列化为紧凑的字节序列
+     */
+    QByteArray toByteArray() const;
+
+    /**
+     * @brief 从字节序列解析回放
+     * @param data 字节序列
+     * @param error 解析失败时写入原因，可为nullptr
+     * @return 解析成功返回true
+     */
+    bool fromByteArray(const QByteArray &data, QString *error = nullptr);
+
+    bool save(const QString &path) const;
+    bool load(const QString &path, QString *error = nullptr);
+
+    /**
+     * @brief 在无界面的引擎上重新推进整局并与记录的结果比较
+     * @param tickNs 不为nullptr时写入每一步的耗时（纳秒），会让整体变慢
+     * @return 校验结果
+     */
+    Verification verify(QVector<qint64> *tickNs = nullptr) const;
+
+private:
+    int m_width;                    // 区域宽度
+    int m_height;                   // 区域高度
+    quint32 m_seed;                 // 随机数种子
+    quint64 m_ticks;                // 步数
+    int m_score;                    // 结束时的分数
+    int m_length;                   // 结束时的长度
+    bool m_finished;                // 是否已记录结果
+    bool m_won;                     // 是否通关
+    QByteArray m_moves;             // 每步2位的方向
+};
+
+#endif // SNAKEREPLAY_H
@@ -0,0 +1,131 @@
+/**
+ * @file snakerunbody.cpp
+ * @brief 拐角编码蛇身实现文件
+ */
+#include "snakerunbody.h"
+
+/**
+ * @brief SnakeRunBody类构造函数
+ */
+SnakeRunBody::SnakeRunBody()
+{
+    clear();
+}
+
+/**
+ * @brief 清空蛇身，保留一个较小的初始容量
+ */
+void SnakeRunBody::clear()
+{
+    m_runs.fill(Run(), 16);
+    m_first = 0;
+    m_count = 0;
+    m_length = 0;
+}
+
+/**
+ * @brief 在蛇头前面增加一格
+ * @param head 新的蛇头
+ * 
+ * 第一段长度为1时还没有方向，可以沿任意方向延长；否则方向相同才延长，
+ * 方向不同（拐弯）时新增一段。
+ */
+void SnakeRunBody::pushHead(const QPoint &head)
+{
+    ++m_length;
+    
+    if (m_count > 0) {
+        Run &first = m_runs[m_first];
+        QPoint step = head - first.head;
+        if (first.length == 1 || step == first.step) {
+            first.step = step;
+            first.head = head;
+            ++first.length;
+            return;
+        }
+    }
+    
+    if (m_count == m_runs.size()) {
+        growCapacity();
+    }
+    m_first = (m_first - 1) & (m_runs.size() - 1);
+    m_runs[m_first] = {head, QPoint(0, 0), 1};
+    ++m_count;
+}
+
+/**
+ * @brief 移除蛇尾的一格
+ * @return 被移除的格子
+ */
+QPoint SnakeRunBody::popTail()
+{
+    Run &last = m_runs[(m_first + m_count - 1) & (m_runs.size() - 1)];
+    QPoint tail = last.tail();
+    --m_length;
+    if (--last.length == 0) {
+        --m_count;
+    }
+    return tail;
+}
+
+QPoint SnakeRunBody::head() const
+{
+    return m_runs.at(m_first).head;
+}
+
+QPoint SnakeRunBody::tail() const
+{
+    return runAt(m_count - 1).tail();
+}
+
+int SnakeRunBody::length() const
+{
+    return m_length;
+}
+
+int SnakeRunBody::runCount() const
+{
+    return m_count;
+}
+
+/**
+ * @brief 按从头到尾的顺序获取一条直线段
+ * @param index 段的序号，0为蛇头所在的段
+ * @return 直线段
+ */
+const SnakeRunBody::Run &SnakeRunBody::runAt(int index) const
+{
+    return m_runs.at((m_first + index) & (m_runs.size() - 1));
+}
+
+/**
+ * @brief 按从头到尾的顺序获取一节
+ * @param index 节的序号，0为蛇头
+ * @return 该节的格子
+ */
+QPoint SnakeRunBody::segmentAt(int index) const
+{
+    for (int i = 0; i < m_count; ++i) {
+        const Run &run = runAt(i);
+        if (index < run.length) {
+            return run.head - run.step * index;
+        }
+        index -= run.length;
+    }
+    return QPoint();
+}
+
+/**
+ * @brief 扩大环形缓冲区
+ * 
+ * 容量翻倍，并把各段按从头到尾的顺序复制到新缓冲区开头
+ */
+void SnakeRunBody::growCapacity()
+{
+    QVector<Run> runs(m_runs.size() * 2);
+    for (int i = 0; i < m_count; ++i) {
+        runs[i] = runAt(i);
+    }
+    m_runs.swap(runs);
+    m_first = 0;
+}
@@ -0,0 +1,77 @@
+#ifndef SNAKERUNBODY_H
+#define SNAKERUNBODY_H
+
+#include <QPoint>
+#include <QVector>
+
+/**
+ * @brief SnakeRunBody类以“拐角 + 直线段长度”的形式存储蛇身
+ * 
+ * 蛇身绝大部分是很长的直线段，逐格存储时长度为L的蛇需要L个点。这里每条直线段只存
+ * 靠近蛇头一端的格子、前进方向（单位步长）和长度，内存与拐角数成正比。
+ * 直线段存放在容量为2的幂的环形缓冲区中：
+ *   - 蛇头前进：方向不变时只把第一段延长一格，否则在前面新增一段，O(1)；
+ *   - 蛇尾收缩：最后一段长度减一，减到0时移除，O(1)。
+ * 按序号访问某一节需要逐段查找（O(段数)），绘制时应按段整体处理。
+ */
+class SnakeRunBody
+{
+public:
+    // 一条直线段
+    struct Run {
+        QPoint head;    // 靠近蛇头一端的格子
+        QPoint step;    // 从蛇尾走向蛇头的单位步长，长度为1的段可以为(0, 0)
+        int length;     // 段内的格子数
+        
+        // 靠近蛇尾一端的格子
+        QPoint tail() const { return head - step * (length - 1); }
+    };
+    
+    SnakeRunBody();
+    
+    /**
+     * @brief 清空蛇身
+     */
+    void clear();
+    
+    /**
+     * @brief 在蛇头前面增加一格
+     * @param head 新的蛇头，必须与当前蛇头相邻（蛇身为空时任意）
+     */
+    void pushHead(const QPoint &head);
+    
+    /**
+     * @brief 移除蛇尾的一格
+     * @return 被移除的格子
+     */
+    QPoint popTail();
+    
+    QPoint head() const;    // 蛇头
+    QPoint tail() const;    // 蛇尾
+    int length() const;     // 总格子数
+    int runCount() const;   // 直线段数
+    
+    /**
+     * @brief 按从头到尾的顺序获取一条直线段
+     * @param index 段的序号，0为蛇头所在的段
+     */
+    const Run &runAt(int index) const;
+    
+    /**
+     * @brief 按从头到尾的顺序获取一节（逐段查找，O(段数)）
+     * @param index 节的序号，0为蛇头
+     */
+    QPoint segmentAt(int index) const;
+
+private:
+    // 环形缓冲区已满时容量翻倍
+    void growCapacity();
+
+private:
+    QVector<Run> m_runs;    // 直线段的环形缓冲区（容量为2的幂）
+    int m_first;            // 蛇头所在段的索引
+    int m_count;            // 段数
+    int m_length;           // 总格子数
+};
+
+#endif // SNAKERUNBODY_H
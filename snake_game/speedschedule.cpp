@@ -0,0 +1,127 @@
+#include "speedschedule.h"
+#include <QtMath>
+
+namespace {
+// 每个食物的分数（与SnakeEngine一致，按分数的表每个食物一项）
+const int kFoodScore = 10;
+// 原来的规则：初始间隔、下限和每次缩短的量（毫秒），以及每次加速的分数
+const int kClassicStartMs = 200;
+const int kClassicFloorMs = 50;
+const int kClassicStepMs = 10;
+const int kClassicSpeedUpScore = 50;
+// 按分数的曲线：与下限的差减半所需的分数，表的项数
+const qreal kSmoothHalfLifeScore = 150;
+const int kSmoothEntries = 1024;
+// 按时间的曲线：每一项的游戏时间（纳秒），与下限的差减半所需的时间（秒），表的项数
+const qint64 kTimeUnitNs = 250000000;
+const qreal kTimeHalfLifeSeconds = 60;
+const int kTimeEntries = 4096;
+
+// 从start到floor按指数衰减的表，第i项对应i*unit，与下限的差每halfLife减半
+QVector<qint64> decayTable(qreal startMs, qreal floorMs, int entries, qreal unit, qreal halfLife)
+{
+    QVector<qint64> periods(entries);
+    for (int i = 0; i < entries; ++i) {
+        const qreal ms = floorMs + (startMs - floorMs) * qPow(0.5, i * unit / halfLife);
+        periods[i] = qRound64(ms * 1e6);
+    }
+    return periods;
+}
+}
+
+SpeedSchedule::SpeedSchedule()
+{
+    *this = classic();
+}
+
+/**
+ * @brief 用算好的表构造
+ * @param basis 查表依据
+ * @param unit 表中相邻两项相差的分数或游戏时间（纳秒）
+ * @param periodsNs 每一项的时间间隔（纳秒）
+ * @param name 名字
+ */
+SpeedSchedule::SpeedSchedule(Basis basis, qint64 unit, const QVector<qint64> &periodsNs, const QString &name)
+    : m_basis(basis)
+    , m_unit(qMax(qint64(1), unit))
+    , m_periodsNs(periodsNs)
+    , m_name(name)
+{
+    if (m_periodsNs.isEmpty()) {
+        m_periodsNs.append(qint64(kClassicStartMs) * 1000000);  // 空表按固定的初始速度
+    }
+}
+
+/**
+ * @brief 原来的规则
+ *
+ * 每个食物一项，直到达到下限为止，之后保持最后一项。
+ */
+SpeedSchedule SpeedSchedule::classic()
+{
+    QVector<qint64> periods;
+    for (int score = 0; ; score += kFoodScore) {
+        const int ms = qMax(kClassicFloorMs, kClassicStartMs - kClassicStepMs * (score / kClassicSpeedUpScore));
+        periods.append(qint64(ms) * 1000000);
+        if (ms == kClassicFloorMs) {
+            break;
+        }
+    }
+    return SpeedSchedule(ByScore, kFoodScore, periods, QStringLiteral("classic"));
+}
+
+/**
+ * @brief 按分数连续加速
+ * @param startMs 初始时间间隔（毫秒）
+ * @param floorMs 时间间隔的下限（毫秒）
+ */
+SpeedSchedule SpeedSchedule::smooth(qreal startMs, qreal floorMs)
+{
+    return SpeedSchedule(ByScore, kFoodScore,
+                         decayTable(startMs, floorMs, kSmoothEntries, kFoodScore, kSmoothHalfLifeScore),
+                         QStringLiteral("smooth"));
+}
+
+/**
+ * @brief 按游戏时间连续加速
+ * @param startMs 初始时间间隔（毫秒）
+ * @param floorMs 时间间隔的下限（毫秒）
+ */
+SpeedSchedule SpeedSchedule::byTime(qreal startMs, qreal floorMs)
+{
+    return SpeedSchedule(ByTime, kTimeUnitNs,
+                         decayTable(startMs, floorMs, kTimeEntries, kTimeUnitNs / 1e9, kTimeHalfLifeSeconds),
+                         QStringLiteral("time"));
+}
+
+SpeedSchedule SpeedSchedule::byName(const QString &name, bool *ok)
+{
+    if (ok) {
+        *ok = true;
+    }
+    if (name == QLatin1String("smooth")) {
+        return smooth();
+    }
+    if (name == QLatin1String("time")) {
+        return byTime();
+    }
+    if (ok && name != QLatin1String("classic")) {
+        *ok = false;
+    }
+    return classic();
+}
+
+QStringList SpeedSchedule::names()
+{
+    return {QStringLiteral("classic"), QStringLiteral("smooth"), QStringLiteral("time")};
+}
+
+SpeedSchedule::Basis SpeedSchedule::basis() const
+{
+    return m_basis;
+}
+
+QString SpeedSchedule::name() const
+{
+    return m_name;
+}
@@ -0,0 +1,95 @@
+#ifndef SPEEDSCHEDULE_H
+#define SPEEDSCHEDULE_H
+
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief SpeedSchedule类是预先算好的每步时间间隔表
+ *
+ * 时间间隔按分数或游戏时间（已推进各步的时间间隔之和）查表得到，单位为纳秒，
+ * 可以做到亚毫秒级的平滑变化。表在构造时一次算好，推进时只做一次除法和一次数组访问；
+ * 超出表尾时保持最后一项（速度的下限）。
+ *
+ * classic()与原来的规则相同（每50分缩短10毫秒，最短50毫秒）；smooth()和byTime()
+ * 按指数曲线逐个食物或逐段时间连续加速，可以低于50毫秒。需要其他曲线时直接用
+ * 构造函数传入自己算好的表即可。
+ */
+class SpeedSchedule
+{
+public:
+    // 查表依据
+    enum Basis {
+        ByScore,  // 按分数
+        ByTime    // 按游戏时间（纳秒）
+    };
+
+    /**
+     * @brief 构造函数，默认为classic()
+     */
+    SpeedSchedule();
+
+    /**
+     * @brief 用算好的表构造
+     * @param basis 查表依据
+     * @param unit 表中相邻两项相差的分数或游戏时间（纳秒），至少为1
+     * @param periodsNs 每一项的时间间隔（纳秒），不能为空
+     * @param name 名字（显示用）
+     */
+    SpeedSchedule(Basis basis, qint64 unit, const QVector<qint64> &periodsNs, const QString &name = QString());
+
+    /**
+     * @brief 原来的规则：从200毫秒开始，分数每增加50缩短10毫秒，最短50毫秒
+     */
+    static SpeedSchedule classic();
+
+    /**
+     * @brief 按分数连续加速：每个食物缩短一点，与下限的差每150分减半
+     * @param startMs 初始时间间隔（毫秒）
+     * @param floorMs 时间间隔的下限（毫秒）
+     */
+    static SpeedSchedule smooth(qreal startMs = 200, qreal floorMs = 30);
+
+    /**
+     * @brief 按游戏时间连续加速：每0.25秒缩短一点，与下限的差每60秒减半
+     * @param startMs 初始时间间隔（毫秒）
+     * @param floorMs 时间间隔的下限（毫秒）
+     */
+    static SpeedSchedule byTime(qreal startMs = 200, qreal floorMs = 30);
+
+    /**
+     * @brief 按名字选择内置的曲线
+     * @param name 曲线的名字，见names()
+     * @param ok 不为空时写入名字是否有效
+     * @return 对应的曲线，名字无效时为classic()
+     */
+    static SpeedSchedule byName(const QString &name, bool *ok = nullptr);
+
+    /**
+     * @brief 所有内置曲线的名字
+     */
+    static QStringList names();
+
+    /**
+     * @brief 查表得到时间间隔
+     * @param score 当前分数
+     * @param elapsedNs 当前的游戏时间（纳秒）
+     * @return 每步的时间间隔（纳秒）
+     */
+    qint64 periodNs(int score, qint64 elapsedNs) const
+    {
+        const qint64 index = (m_basis == ByScore ? score : elapsedNs) / m_unit;
+        return m_periodsNs.at(int(qMin(index, qint64(m_periodsNs.size() - 1))));
+    }
+
+    Basis basis() const;
+    QString name() const;
+
+private:
+    Basis m_basis;                  // 查表依据
+    qint64 m_unit;                  // 相邻两项相差的分数或游戏时间
+    QVector<qint64> m_periodsNs;    // 每一项的时间间隔（纳秒）
+    QString m_name;                 // 名字
+};
+
+#endif // SPEEDSCHEDULE_H
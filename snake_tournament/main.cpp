@@ -0,0 +1,303 @@
+#include "snakecontroller.h"
+#include "workstealingpool.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+#include <QThread>
+
+namespace {
+
+// 一局的结束方式
+enum Outcome {
+    Died,     // 撞墙或撞到自己
+    Won,      // 占满整个区域
+    Starved   // 太久没有吃到食物，判为超时
+};
+
+// 一局的结果
+struct GameResult {
+    int controller = 0;         // 策略的序号
+    quint32 seed = 0;           // 种子
+    int score = 0;              // 分数
+    int length = 0;             // 结束时的长度
+    quint64 ticks = 0;          // 步数
+    Outcome outcome = Died;     // 结束方式
+    qint64 controllerNs = 0;    // 策略决策的累计耗时（纳秒）
+    qint64 engineNs = 0;        // 引擎推进的累计耗时（纳秒）
+};
+
+// 锦标赛的设置
+struct Tournament {
+    QStringList controllers;    // 参加比较的策略
+    QVector<quint32> seeds;     // 每个策略都要下的种子
+    QSize field;                // 区域大小
+    quint64 starveTicks = 0;    // 连续多少步没吃到食物判为超时
+};
+
+/**
+ * @brief 用一个策略完整地下一局
+ * @param controller 策略（已创建）
+ * @param seed 种子
+ * @param tournament 锦标赛设置
+ * @return 这一局的结果（controller序号由调用者填写）
+ *
+ * 每一步读两次单调时钟，策略的耗时按决策前后之差累计，其余都计入引擎。
+ */
+GameResult playGame(SnakeController *controller, quint32 seed, const Tournament &tournament)
+{
+    SnakeEngine engine(seed);
+    engine.setFieldSize(tournament.field.width(), tournament.field.height());
+    controller->reset(seed);
+
+    GameResult result;
+    result.seed = seed;
+    quint64 lastMeal = 0;
+    QElapsedTimer timer;
+    timer.start();
+    while (!engine.isGameOver()) {
+        if (engine.tickCount() - lastMeal > tournament.starveTicks) {
+            result.outcome = Starved;
+            break;
+        }
+        const qint64 before = timer.nsecsElapsed();
+        const Direction dir = controller->decide(engine);
+        result.controllerNs += timer.nsecsElapsed() - before;
+        if (engine.step(dir) == SnakeEngine::AteFood) {
+            lastMeal = engine.tickCount();
+        }
+    }
+    result.engineNs = timer.nsecsElapsed() - result.controllerNs;
+    if (engine.isGameOver()) {
+        result.outcome = engine.isWon() ? Won : Died;
+    }
+    result.score = engine.score();
+    result.length = engine.snake().length();
+    result.ticks = engine.tickCount();
+    return result;
+}
+
+/**
+ * @brief 在线程池上下完所有对局
+ * @param tournament 锦标赛设置
+ * @param pool 线程池
+ * @param wallNs 写入总耗时（纳秒）
+ * @return 按(种子, 策略)排列的结果，与线程数无关
+ *
+ * 每局一个任务块：对局的长短相差很大（随机策略几十步，自动驾驶几万步），
+ * 由任务窃取来平衡各线程的负载。相邻的块属于不同的策略，长局不会集中在某个线程的队列里。
+ */
+QVector<GameResult> runTournament(const Tournament &tournament, WorkStealingPool &pool, qint64 *wallNs)
+{
+    const int controllerCount = tournament.controllers.size();
+    QVector<GameResult> results(controllerCount * tournament.seeds.size());
+    GameResult *out = results.data();
+
+    QElapsedTimer timer;
+    timer.start();
+    pool.parallelFor(results.size(), 1, [&tournament, controllerCount, out](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            const int index = i % controllerCount;
+            SnakeController *controller = SnakeController::create(tournament.controllers.at(index));
+            out[i] = playGame(controller, tournament.seeds.at(i / controllerCount), tournament);
+            out[i].controller = index;
+            delete controller;
+        }
+    });
+    *wallNs = timer.nsecsElapsed();
+    return results;
+}
+
+/**
+ * @brief 解析种子列表
+ * @param text "N"（1到N）、"A-B"（A到B）或逗号分隔的种子
+ * @return 种子，格式错误时为空
+ */
+QVector<quint32> parseSeeds(const QString &text)
+{
+    QVector<quint32> seeds;
+    bool ok = true;
+    if (text.contains(QLatin1Char(','))) {
+        for (const QString &part : text.split(QLatin1Char(','))) {
+            seeds.append(part.trimmed().toUInt(&ok));
+            if (!ok) {
+                return {};
+            }
+        }
+        return seeds;
+    }
+    const QStringList range = text.split(QLatin1Char('-'));
+    quint32 first = 1;
+    quint32 last = 0;
+    if (range.size() == 2) {
+        first = range.at(0).toUInt(&ok);
+        last = ok ? range.at(1).toUInt(&ok) : 0;
+    } else {
+        last = text.toUInt(&ok);
+    }
+    if (!ok || last < first) {
+        return {};
+    }
+    for (quint64 seed = first; seed <= last; ++seed) {
+        seeds.append(quint32(seed));
+    }
+    return seeds;
+}
+
+// 所有对局结果的校验和，用于确认不同线程数下结果一致
+quint64 checksum(const QVector<GameResult> &results)
+{
+    quint64 sum = 0;
+    for (const GameResult &r : results) {
+        sum = sum * 1000003 + quint64(r.score) * 31 + quint64(r.length) * 7 + r.ticks + quint64(r.outcome);
+    }
+    return sum;
+}
+
+/**
+ * @brief 输出每局的结果（CSV，写到标准输出，便于导入表格或脚本）
+ */
+void printGames(const Tournament &tournament, const QVector<GameResult> &results)
+{
+    static const char *const outcomeNames[] = {"died", "won", "starved"};
+    QTextStream out(stdout);
+    out << "controller,seed,score,length,ticks,outcome,controller_us,engine_us\n";
+    for (const GameResult &r : results) {
+        out << tournament.controllers.at(r.controller) << ',' << r.seed << ',' << r.score << ','
+            << r.length << ',' << r.ticks << ',' << outcomeNames[r.outcome] << ','
+            << QString::number(r.controllerNs / 1000.0, 'f', 1) << ','
+            << QString::number(r.engineNs / 1000.0, 'f', 1) << '\n';
+    }
+}
+
+/**
+ * @brief 按策略汇总结果，并输出整体的吞吐量
+ */
+void printSummary(const Tournament &tournament, const QVector<GameResult> &results, int threads, qint64 wallNs)
+{
+    quint64 totalTicks = 0;
+    for (int c = 0; c < tournament.controllers.size(); ++c) {
+        int games = 0;
+        int wins = 0;
+        int starved = 0;
+        int maxScore = 0;
+        qint64 score = 0;
+        qint64 length = 0;
+        quint64 ticks = 0;
+        qint64 controllerNs = 0;
+        qint64 engineNs = 0;
+        for (const GameResult &r : results) {
+            if (r.controller != c) {
+                continue;
+            }
+            ++games;
+            wins += r.outcome == Won ? 1 : 0;
+            starved += r.outcome == Starved ? 1 : 0;
+            maxScore = qMax(maxScore, r.score);
+            score += r.score;
+            length += r.length;
+            ticks += r.ticks;
+            controllerNs += r.controllerNs;
+            engineNs += r.engineNs;
+        }
+        totalTicks += ticks;
+        const double n = qMax(1, games);
+        qInfo("%-10s %6d局  平均分 %8.1f  最高 %6d  平均长度 %7.1f  平均步数 %9.1f  通关 %5d  超时 %5d  "
+              "决策 %6.2f µs/步（占%4.1f%%）  引擎 %6.3f µs/步",
+              qPrintable(tournament.controllers.at(c)), games, score / n, maxScore, length / n, ticks / n,
+              wins, starved, controllerNs / 1000.0 / qMax<quint64>(1, ticks),
+              100.0 * controllerNs / qMax<qint64>(1, controllerNs + engineNs),
+              engineNs / 1000.0 / qMax<quint64>(1, ticks));
+    }
+    const double seconds = qMax(1e-9, wallNs / 1e9);
+    qInfo("共%d局  %d线程  用时 %.2f 秒  %.1f 局/秒  %.2f M步/秒",
+          results.size(), threads, seconds, results.size() / seconds, totalTicks / seconds / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("snake_tournament"));
+
+    // 命令行参数
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("贪吃蛇策略锦标赛：每个策略在相同的种子上完整地下无界面对局"));
+    parser.addHelpOption();
+    QCommandLineOption controllersOption({QStringLiteral("c"), QStringLiteral("controllers")},
+                                         QStringLiteral("逗号分隔的策略（%1）").arg(SnakeController::names().join(QLatin1Char(','))),
+                                         QStringLiteral("list"), SnakeController::names().join(QLatin1Char(',')));
+    QCommandLineOption seedsOption({QStringLiteral("s"), QStringLiteral("seeds")},
+                                   QStringLiteral("种子：N（1到N）、A-B或逗号分隔"), QStringLiteral("seeds"), QStringLiteral("1000"));
+    QCommandLineOption threadsOption({QStringLiteral("t"), QStringLiteral("threads")},
+                                     QStringLiteral("线程池大小（0为CPU核心数）"), QStringLiteral("count"), QStringLiteral("0"));
+    QCommandLineOption boardOption(QStringLiteral("board"), QStringLiteral("区域大小"), QStringLiteral("WxH"), QStringLiteral("30x20"));
+    QCommandLineOption starveOption(QStringLiteral("starve"), QStringLiteral("连续多少步没吃到食物判为超时（0为格子数的2倍）"),
+                                    QStringLiteral("ticks"), QStringLiteral("0"));
+    QCommandLineOption scalingOption(QStringLiteral("scaling"), QStringLiteral("依次用1、2、4…直到指定的线程数运行，只输出吞吐量"));
+    QCommandLineOption quietOption({QStringLiteral("q"), QStringLiteral("quiet")}, QStringLiteral("不输出每局的结果"));
+    parser.addOptions({controllersOption, seedsOption, threadsOption, boardOption, starveOption, scalingOption, quietOption});
+    parser.process(a);
+
+    Tournament tournament;
+    tournament.controllers = parser.value(controllersOption).split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString &name : tournament.controllers) {
+        SnakeController *controller = SnakeController::create(name);
+        if (!controller) {
+            qCritical("未知的策略: %s（可用: %s）", qPrintable(name),
+                      qPrintable(SnakeController::names().join(QLatin1Char(','))));
+            return 1;
+        }
+        delete controller;
+    }
+    tournament.seeds = parseSeeds(parser.value(seedsOption));
+    if (tournament.controllers.isEmpty() || tournament.seeds.isEmpty()) {
+        qCritical("策略或种子列表为空");
+        return 1;
+    }
+    const QStringList board = parser.value(boardOption).split(QLatin1Char('x'));
+    tournament.field = board.size() == 2 ? QSize(qMax(20, board.at(0).toInt()), qMax(20, board.at(1).toInt()))
+                                         : QSize(30, 20);
+    tournament.starveTicks = parser.value(starveOption).toULongLong();
+    if (tournament.starveTicks == 0) {
+        tournament.starveTicks = 2 * quint64(tournament.field.width()) * quint64(tournament.field.height());
+    }
+
+    int threads = parser.value(threadsOption).toInt();
+    if (threads < 1) {
+        threads = QThread::idealThreadCount();
+    }
+
+    // 扩展性：线程数翻倍直到上限，和单线程比较吞吐量并确认结果一致
+    if (parser.isSet(scalingOption)) {
+        double baseline = 0.0;
+        quint64 expected = 0;
+        for (int t = 1; ; t = qMin(t * 2, threads)) {
+            WorkStealingPool pool(t);
+            qint64 wallNs = 0;
+            const QVector<GameResult> results = runTournament(tournament, pool, &wallNs);
+            const double gamesPerSecond = results.size() / qMax(1e-9, wallNs / 1e9);
+            if (t == 1) {
+                baseline = gamesPerSecond;
+                expected = checksum(results);
+            }
+            qInfo("%3d线程  %10.1f 局/秒  加速比 %5.2f  效率 %5.1f%%  结果%s", t, gamesPerSecond,
+                  gamesPerSecond / baseline, 100.0 * gamesPerSecond / baseline / t,
+                  checksum(results) == expected ? "一致" : "不一致");
+            if (t == threads) {
+                break;
+            }
+        }
+        return 0;
+    }
+
+    WorkStealingPool pool(threads);
+    qint64 wallNs = 0;
+    const QVector<GameResult> results = runTournament(tournament, pool, &wallNs);
+    if (!parser.isSet(quietOption)) {
+        printGames(tournament, results);
+    }
+    printSummary(tournament, results, pool.threadCount(), wallNs);
+    return 0;
+}
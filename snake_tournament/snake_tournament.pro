@@ -0,0 +1,22 @@
+# 贪吃蛇策略锦标赛配置文件
+QT       += core
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+# 复用贪吃蛇的无界面核心逻辑（含任务窃取线程池）
+include($$PWD/../snake_game/snakecore.pri)
+
+# 主程序入口文件
+SOURCES += $$PWD/main.cpp \
+    $$PWD/snakecontroller.cpp
+
+# 头文件
+HEADERS += \
+    $$PWD/snakecontroller.h
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,113 @@
+#include "snakecontroller.h"
+#include "snakeautopilot.h"
+#include <QRandomGenerator>
+
+namespace {
+
+// 蛇头沿方向移动一格后的位置
+QPoint stepFrom(const QPoint &pos, int dir)
+{
+    return pos + QPoint(directionDx(dir), directionDy(dir));
+}
+
+// 不掉头、不出界、不进入蛇身的方向（蛇尾也按占用处理），返回个数
+int safeMoves(const SnakeEngine &engine, int *moves)
+{
+    const Snake &snake = engine.snake();
+    const QPoint head = snake.getHeadPosition();
+    int count = 0;
+    for (int dir = Up; dir <= Right; ++dir) {
+        if (dir == opposite(snake.direction())) {
+            continue;
+        }
+        const QPoint next = stepFrom(head, dir);
+        if (next.x() >= 0 && next.x() < engine.width() && next.y() >= 0 && next.y() < engine.height()
+            && !snake.isOccupied(next)) {
+            moves[count++] = dir;
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief 自动驾驶（SnakeAutopilot）
+ */
+class AutopilotController : public SnakeController
+{
+public:
+    QString name() const override { return QStringLiteral("autopilot"); }
+    void reset(quint32) override { m_autopilot.reset(); }
+    Direction decide(const SnakeEngine &engine) override { return m_autopilot.plan(engine); }
+
+private:
+    SnakeAutopilot m_autopilot;
+};
+
+/**
+ * @brief 贪心：在安全的方向中选离食物最近的，没有安全方向时保持原方向
+ */
+class GreedyController : public SnakeController
+{
+public:
+    QString name() const override { return QStringLiteral("greedy"); }
+    void reset(quint32) override {}
+
+    Direction decide(const SnakeEngine &engine) override
+    {
+        int moves[4];
+        const int count = safeMoves(engine, moves);
+        const QPoint head = engine.snake().getHeadPosition();
+        int best = -1;
+        int bestDistance = 0;
+        for (int i = 0; i < count; ++i) {
+            const QPoint next = stepFrom(head, moves[i]);
+            const int distance = (next - engine.food()).manhattanLength();
+            if (best < 0 || distance < bestDistance) {
+                best = moves[i];
+                bestDistance = distance;
+            }
+        }
+        return best >= 0 ? Direction(best) : engine.snake().direction();
+    }
+};
+
+/**
+ * @brief 随机：在安全的方向中均匀随机选择（作为比较的下限）
+ */
+class RandomController : public SnakeController
+{
+public:
+    QString name() const override { return QStringLiteral("random"); }
+    void reset(quint32 seed) override { m_random.seed(seed ^ 0x5bd1e995u); }
+
+    Direction decide(const SnakeEngine &engine) override
+    {
+        int moves[4];
+        const int count = safeMoves(engine, moves);
+        return count > 0 ? Direction(moves[m_random.bounded(count)]) : engine.snake().direction();
+    }
+
+private:
+    QRandomGenerator m_random;
+};
+
+} // namespace
+
+SnakeController *SnakeController::create(const QString &name)
+{
+    if (name == QLatin1String("autopilot")) {
+        return new AutopilotController;
+    }
+    if (name == QLatin1String("greedy")) {
+        return new GreedyController;
+    }
+    if (name == QLatin1String("random")) {
+        return new RandomController;
+    }
+    return nullptr;
+}
+
+QStringList SnakeController::names()
+{
+    return {QStringLiteral("autopilot"), QStringLiteral("greedy"), QStringLiteral("random")};
+}
@@ -0,0 +1,50 @@
+#ifndef SNAKECONTROLLER_H
+#define SNAKECONTROLLER_H
+
+#include <QStringList>
+#include "snakeengine.h"
+
+/**
+ * @brief SnakeController是锦标赛中控制一条蛇的策略的基类
+ *
+ * 每局开始前调用reset()，之后每一步调用decide()选择方向。同一个对象同时只在
+ * 一个线程上使用，不同对象之间不共享可变数据，可以在线程池上并发对局。
+ * 新的策略继承本类并在create()中登记名字即可参加比较。
+ */
+class SnakeController
+{
+public:
+    virtual ~SnakeController() {}
+
+    /**
+     * @brief 策略的名字（命令行中使用）
+     */
+    virtual QString name() const = 0;
+
+    /**
+     * @brief 开始新的一局
+     * @param seed 这一局的种子，带随机性的策略用它派生自己的随机数
+     */
+    virtual void reset(quint32 seed) = 0;
+
+    /**
+     * @brief 为引擎的当前状态选择下一步的方向
+     * @param engine 游戏引擎
+     * @return 下一步的方向
+     */
+    virtual Direction decide(const SnakeEngine &engine) = 0;
+
+    /**
+     * @brief 按名字创建策略
+     * @param name 策略的名字，见names()
+     * @return 新的策略对象（由调用者释放），名字未知时返回nullptr
+     */
+    static SnakeController *create(const QString &name);
+
+    /**
+     * @brief 所有已登记的策略名字
+     */
+    static QStringList names();
+};
+
+#endif // SNAKECONTROLLER_H
@@ -0,0 +1,86 @@
+#include "snakereplay.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <algorithm>
+
+namespace {
+
+/**
+ * @brief 列出最慢的几步
+ * @param tickNs 每一步的耗时（纳秒）
+ * @param count 列出的步数
+ *
+ * 同时给出中位数，便于判断卡顿相对于平常的一步慢了多少。
+ */
+void printSlowestTicks(const QVector<qint64> &tickNs, int count)
+{
+    if (tickNs.isEmpty()) {
+        return;
+    }
+    QVector<int> order(tickNs.size());
+    for (int i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    count = qMin(count, order.size());
+    std::partial_sort(order.begin(), order.begin() + count, order.end(), [&tickNs](int a, int b) {
+        return tickNs.at(a) > tickNs.at(b);
+    });
+    QVector<qint64> sorted = tickNs;
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    qInfo("    每步耗时中位数 %lld ns，最慢的%d步：", sorted.at(sorted.size() / 2), count);
+    for (int i = 0; i < count; ++i) {
+        qInfo("      第%d步  %lld ns", order.at(i), tickNs.at(order.at(i)));
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("snake_verify"));
+
+    // 命令行参数
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("贪吃蛇回放校验：在无界面的引擎上重新推进并核对分数和长度"));
+    parser.addHelpOption();
+    QCommandLineOption profileOption({QStringLiteral("p"), QStringLiteral("profile")},
+                                     QStringLiteral("记录每一步的耗时并列出最慢的几步"), QStringLiteral("count"));
+    parser.addOption(profileOption);
+    parser.addPositionalArgument(QStringLiteral("replays"), QStringLiteral("回放文件"), QStringLiteral("<file>..."));
+    parser.process(a);
+
+    const QStringList files = parser.positionalArguments();
+    if (files.isEmpty()) {
+        parser.showHelp(1);
+    }
+    const int profileCount = parser.isSet(profileOption) ? qMax(1, parser.value(profileOption).toInt()) : 0;
+
+    int failures = 0;
+    for (const QString &file : files) {
+        SnakeReplay replay;
+        QString error;
+        if (!replay.load(file, &error)) {
+            qInfo("FAIL  %s: %s", qPrintable(file), qPrintable(error));
+            ++failures;
+            continue;
+        }
+
+        QVector<qint64> tickNs;
+        const SnakeReplay::Verification result = replay.verify(profileCount > 0 ? &tickNs : nullptr);
+        const double seconds = qMax(1e-9, result.elapsedNs / 1e9);
+        if (result.ok) {
+            qInfo("OK    %s: %dx%d 种子%u  %llu步  %d分  %d节%s  %.1f M步/秒",
+                  qPrintable(file), replay.width(), replay.height(), replay.seed(),
+                  result.ticks, result.score, result.length, replay.isWon() ? "  通关" : "",
+                  result.ticks / seconds / 1e6);
+        } else {
+            qInfo("FAIL  %s: %s", qPrintable(file), qPrintable(result.error));
+            ++failures;
+        }
+        if (profileCount > 0) {
+            printSlowestTicks(tickNs.mid(0, int(result.ticks)), profileCount);
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
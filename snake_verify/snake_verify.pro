@@ -0,0 +1,17 @@
+# 贪吃蛇回放校验工具配置文件
+QT       += core
+QT       -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+# 复用贪吃蛇的无界面核心逻辑
+include($$PWD/../snake_game/snakecore.pri)
+
+# 主程序入口文件
+SOURCES += $$PWD/main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -1,3 +1,7 @@
-TEMPLATE = subdirs
-SUBDIRS += snake_game
-SUBDIRS += ball_game
+TEMPLATE = subdirs
+SUBDIRS += snake_game
+SUBDIRS += ball_game
+SUBDIRS += ball_server
+SUBDIRS += snake_bench
+SUBDIRS += snake_verify
+SUBDIRS += snake_tournament